@@ -44,12 +44,38 @@ template <class T, class U> struct hashentry {
   hashentry<T, U> (int code, T key2, U im2);
 };
 
+/**
+ * @brief States of the slots of a hashmap.
+ */
+#define HASHMAP_EMPTY 0
+#define HASHMAP_FULL 1
+#define HASHMAP_DELETED 2
+
+/**
+ * @brief Hashmaps are open addressing tables with linear probing.
+ *
+ * @details The entries are stored inline in an array of slots, whose size
+ * is a power of two. A separate array of bytes holds the state of each slot,
+ * so that probing only touches the entries whose state is full. Removed
+ * entries leave a deleted slot behind, so that entries never move except
+ * when the table is resized. At most three quarters of the slots are used.
+ *
+ * @warning Insertions which grow the table and removals which shrink it
+ * move all entries, so references returned by bracket_rw or operator()
+ * are invalidated by any later insertion or removal of another key.
+ */
 template <class T, class U> class hashmap_rep : concrete_struct {
-  int                    size; // size of hashmap (nr of entries)
-  int                    n;    // nr of keys (a power of two)
-  int                    max;  // mean number of entries per key
-  U                      init; // default entry
-  list<hashentry<T, U>>* a;    // the array of entries
+  int              size; // size of hashmap (nr of entries)
+  int              used; // nr of full or deleted slots
+  int              n;    // nr of slots (zero or a power of two)
+  U                init; // default entry
+  char*            s;    // the state of each slot
+  hashentry<T, U>* a;    // the slots, only full slots hold an entry
+
+  int  slot (int hv);
+  int  find (int hv, const T& x);
+  U&   insert (int hv, const T& x, const U& y);
+  void rehash (int n2);
 
 public:
   /**
@@ -57,13 +83,15 @@ public:
    *
    * @tparam T Type of the keys in the hash map.
    * @tparam U Type of the values in the hash map.
-   * @param init2 Initial value for hash entries. * @param n2 Initial size of
-   * the hash table array.
-   * @param max2 Maximum allowable size for dynamic resizing.
+   * @param init2 Initial value for hash entries.
+   * @param n2 Initial number of slots; for the default value, no slots are
+   * allocated before the first insertion.
+   * @param max2 A multiplier for the initial number of slots.
    */
   inline hashmap_rep<T, U> (U init2, int n2= 1, int max2= 1)
-      : size (0), n (n2), max (max2), init (init2),
-        a (tm_new_array<list<hashentry<T, U>>> (n)) {}
+      : size (0), used (0), n (0), init (init2), s (NULL), a (NULL) {
+    if (n2 * max2 > 1) resize (n2 * max2);
+  }
 
   /**
    * @brief Destructor for the hashmap_rep class.
@@ -71,12 +99,13 @@ public:
    * @tparam T Type of the keys in the hash map.
    * @tparam U Type of the values in the hash map.
    */
-  inline ~hashmap_rep<T, U> () { tm_delete_array (a); }
+  inline ~hashmap_rep<T, U> () { rehash (0); }
 
   /**
    * @brief Resizes the hashmap and rehashes all existing keys.
    *
-   * @param n The new size of the hashmap.
+   * @param n The minimal number of slots of the hashmap; more slots are
+   * allocated if necessary in order to hold the current entries.
    * @note This operation could be costly as it rehashes all keys.
    */
   void resize (int n);
@@ -185,12 +214,11 @@ template <class T, class U> class hashmap {
       : rep (tm_new<hashmap_rep<T, U>> (type_helper<U>::init_val (), 1, 1)) {}
 
   /**
-   * @brief Constructor that allows custom initial value, size, and maximum load
-   * factor.
+   * @brief Constructor that allows custom initial value and initial size.
    *
    * @param init The initial value for the type U.
    * @param n The initial size of the hashmap.
-   * @param max The maximum load factor of the hashmap.
+   * @param max A multiplier for the initial size.
    */
   inline hashmap (U init, int n= 1, int max= 1)
       : rep (tm_new<hashmap_rep<T, U>> (init, n, max)) {}
@@ -208,6 +236,8 @@ template <class T, class U> class hashmap {
    *
    * @param x The key to look up in the hashmap.
    * @return A reference to the value associated with the key x.
+   * @note The reference is only valid until the next insertion or removal,
+   * which may resize the table.
    */
   inline U& operator() (T x) { return rep->bracket_rw (x); }
 };
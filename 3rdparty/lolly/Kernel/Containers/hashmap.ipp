@@ -1,7 +1,7 @@
 
 /******************************************************************************
  * MODULE     : hashmap.cpp
- * DESCRIPTION: fixed size hashmaps with reference counting
+ * DESCRIPTION: open addressing hashmaps with reference counting
  * COPYRIGHT  : (C) 1999  Joris van der Hoeven
  *******************************************************************************
  * This software falls under the GNU general public license version 3 or later.
@@ -13,6 +13,7 @@
 #define HASHMAP_CC
 
 #include "hashmap.hpp"
+#include <new>
 #define TMPL template <class T, class U>
 #define H hashentry<T, U>
 
@@ -41,34 +42,109 @@ operator!= (H h1, H h2) {
 }
 
 /******************************************************************************
- * Routines for hashmaps
+ * Slots
  ******************************************************************************/
 
+template <class T>
+inline unsigned int
+hashmap_mix (unsigned int h, T*) {
+  // hash values of strings and trees vary little in their lower bits,
+  // which would produce long runs of full slots, so mix all bits
+  h^= h >> 16;
+  h*= 0x85ebca6bU;
+  h^= h >> 13;
+  h*= 0xc2b2ae35U;
+  return h ^ (h >> 16);
+}
+
+inline unsigned int
+hashmap_mix (unsigned int h, int*) {
+  // integer keys are often dense, keep them in order
+  return h;
+}
+
+TMPL inline int
+hashmap_rep<T, U>::slot (int hv) {
+  // the first slot to probe for the hash value hv
+  return (int) (hashmap_mix ((unsigned int) hv, (T*) NULL) & (n - 1));
+}
+
+TMPL int
+hashmap_rep<T, U>::find (int hv, const T& x) {
+  // index of the slot of x or -1; there is always an empty slot
+  if (n == 0) return -1;
+  int i= slot (hv);
+  while (s[i] != HASHMAP_EMPTY) {
+    if (s[i] == HASHMAP_FULL && a[i].code == hv && a[i].key == x) return i;
+    i= (i + 1) & (n - 1);
+  }
+  return -1;
+}
+
+TMPL U&
+hashmap_rep<T, U>::insert (int hv, const T& x, const U& y) {
+  // insert x, assuming that it does not yet occur
+  if ((used + 1) << 2 > n * 3) resize (0);
+  int i= slot (hv);
+  while (s[i] == HASHMAP_FULL)
+    i= (i + 1) & (n - 1);
+  if (s[i] == HASHMAP_EMPTY) used++;
+  s[i]= HASHMAP_FULL;
+  new (a + i) H (hv, x, y);
+  size++;
+  return a[i].im;
+}
+
 TMPL void
-hashmap_rep<T, U>::resize (int n2) {
-  int                    i;
-  int                    oldn= n;
-  list<hashentry<T, U>>* olda= a;
-  n                          = n2;
-  a                          = tm_new_array<list<hashentry<T, U>>> (n);
-  for (i= 0; i < oldn; i++) {
-    list<hashentry<T, U>> l (olda[i]);
-    while (!is_nil (l)) {
-      list<hashentry<T, U>>& newl= a[hash (l->item.key) & (n - 1)];
-      newl                       = list<hashentry<T, U>> (l->item, newl);
-      l                          = l->next;
+hashmap_rep<T, U>::rehash (int n2) {
+  // move the entries to n2 slots; the entries are destroyed for n2 == 0
+  int   oldn= n;
+  char* olds= s;
+  H*    olda= a;
+  n         = n2;
+  used      = 0;
+  s         = NULL;
+  a         = NULL;
+  if (n > 0) {
+    s= (char*) fast_alloc (n * sizeof (char));
+    a= (H*) fast_alloc (n * sizeof (H));
+    for (int i= 0; i < n; i++)
+      s[i]= HASHMAP_EMPTY;
+  }
+  for (int i= 0; i < oldn; i++)
+    if (olds[i] == HASHMAP_FULL) {
+      if (n > 0) {
+        int j= slot (olda[i].code);
+        while (s[j] == HASHMAP_FULL)
+          j= (j + 1) & (n - 1);
+        s[j]= HASHMAP_FULL;
+        new (a + j) H (olda[i]);
+        used++;
+      }
+      olda[i].~H ();
     }
+  if (n == 0) size= 0;
+  if (oldn > 0) {
+    fast_free (olds, oldn * sizeof (char));
+    fast_free (olda, oldn * sizeof (H));
   }
-  tm_delete_array (olda);
+}
+
+/******************************************************************************
+ * Routines for hashmaps
+ ******************************************************************************/
+
+TMPL void
+hashmap_rep<T, U>::resize (int n2) {
+  int m= 4;
+  while (m < n2 || m * 3 < (size + 1) << 2)
+    m<<= 1;
+  rehash (m);
 }
 
 TMPL bool
 hashmap_rep<T, U>::contains (T x) {
-  int hv= hash (x);
-  for (auto l= a[hv & (n - 1)]; !is_nil (l); l= l->next) {
-    if (l->item.code == hv && l->item.key == x) return true;
-  }
-  return false;
+  return find (hash (x), x) >= 0;
 }
 
 TMPL bool
@@ -79,62 +155,45 @@ hashmap_rep<T, U>::empty () {
 TMPL U&
 hashmap_rep<T, U>::bracket_rw (T x) {
   int hv= hash (x);
-  for (auto p= a[hv & (n - 1)]; !is_nil (p); p= p->next) {
-    if (p->item.code == hv && p->item.key == x) return p->item.im;
-  }
-  if (size >= n * max) resize (n << 1);
-  list<hashentry<T, U>>& rl= a[hv & (n - 1)];
-  rl                       = list<hashentry<T, U>> (H (hv, x, init), rl);
-  size++;
-  return rl->item.im;
+  int i = find (hv, x);
+  if (i >= 0) return a[i].im;
+  return insert (hv, x, init);
 }
 
 TMPL U
 hashmap_rep<T, U>::bracket_ro (T x) {
-  int                   hv= hash (x);
-  list<hashentry<T, U>> l (a[hv & (n - 1)]);
-  while (!is_nil (l)) {
-    if (l->item.code == hv && l->item.key == x) return l->item.im;
-    l= l->next;
-  }
+  int i= find (hash (x), x);
+  if (i >= 0) return a[i].im;
   return init;
 }
 
 TMPL void
 hashmap_rep<T, U>::reset (T x) {
-  int                    hv= hash (x);
-  list<hashentry<T, U>>* l = &(a[hv & (n - 1)]);
-  while (!is_nil (*l)) {
-    if ((*l)->item.code == hv && (*l)->item.key == x) {
-      *l= (*l)->next;
-      size--;
-      if (size < (n >> 1) * max) resize (n >> 1);
-      return;
-    }
-    l= &((*l)->next);
-  }
+  int i= find (hash (x), x);
+  if (i < 0) return;
+  s[i]= HASHMAP_DELETED;
+  a[i].~H ();
+  size--;
+  if (size == 0) rehash (0);
+  else if (size << 3 < n && n > 4) resize (0);
 }
 
 TMPL void
 hashmap_rep<T, U>::generate (void (*routine) (T)) {
-  int i;
-  for (i= 0; i < n; i++) {
-    for (auto p= a[i]; !is_nil (p); p= p->next) {
-      routine (p->item.key);
-    }
-  }
+  for (int i= 0; i < n; i++)
+    if (s[i] == HASHMAP_FULL) routine (a[i].key);
 }
 
 TMPL tm_ostream&
 operator<< (tm_ostream& out, hashmap<T, U> h) {
   int i= 0, j= 0, n= h->n, size= h->size;
   out << "{ ";
-  for (; i < n; i++) {
-    for (auto p= h->a[i]; !is_nil (p); p= p->next, j++) {
-      out << p->item;
+  for (; i < n; i++)
+    if (h->s[i] == HASHMAP_FULL) {
+      out << h->a[i];
       if (j != size - 1) out << ", ";
+      j++;
     }
-  }
   out << " }";
   return out;
 }
@@ -142,20 +201,17 @@ operator<< (tm_ostream& out, hashmap<T, U> h) {
 TMPL void
 hashmap_rep<T, U>::join (hashmap<T, U> h) {
   int i= 0, n= h->n;
-  for (; i < n; i++) {
-    for (auto p= h->a[i]; !is_nil (p); p= p->next)
-      bracket_rw (p->item.key)= copy (p->item.im);
-  }
+  for (; i < n; i++)
+    if (h->s[i] == HASHMAP_FULL) bracket_rw (h->a[i].key)= copy (h->a[i].im);
 }
 
 TMPL bool
 operator== (hashmap<T, U> h1, hashmap<T, U> h2) {
   if (h1->size != h2->size) return false;
   int i= 0, n= h1->n;
-  for (; i < n; i++) {
-    for (auto p= h1->a[i]; !is_nil (p); p= p->next)
-      if (h2[p->item.key] != p->item.im) return false;
-  }
+  for (; i < n; i++)
+    if (h1->s[i] == HASHMAP_FULL && h2[h1->a[i].key] != h1->a[i].im)
+      return false;
   return true;
 }
 
@@ -18,79 +18,50 @@
 
 TMPL void
 hashmap_rep<T, U>::write_back (T x, hashmap<T, U> base) {
-  int                   hv= hash (x);
-  list<hashentry<T, U>> l (a[hv & (n - 1)]);
-  while (!is_nil (l)) {
-    if (l->item.code == hv && l->item.key == x) return;
-    l= l->next;
-  }
-  if (size >= n * max) resize (n << 1);
-  list<hashentry<T, U>>& rl= a[hv & (n - 1)];
-  rl                       = list<hashentry<T, U>> (H (hv, x, init), rl);
-  size++;
-
-  list<hashentry<T, U>> bl (base->a[hv & (base->n - 1)]);
-  while (!is_nil (bl)) {
-    if (bl->item.code == hv && bl->item.key == x) {
-      rl->item.im= bl->item.im;
-      return;
-    }
-    bl= bl->next;
-  }
-  rl->item.im= base->init;
+  int hv= hash (x);
+  if (find (hv, x) >= 0) return;
+  int j= base->find (hv, x);
+  U   y= (j >= 0 ? base->a[j].im : base->init);
+  insert (hv, x, y);
 }
 
 TMPL void
 hashmap_rep<T, U>::pre_patch (hashmap<T, U> patch, hashmap<T, U> base) {
   int i= 0, n= patch->n;
-  for (; i < n; i++) {
-    list<hashentry<T, U>> l= patch->a[i];
-    for (; !is_nil (l); l= l->next) {
-      T x= l->item.key;
-      U y= contains (x) ? bracket_ro (x) : l->item.im;
+  for (; i < n; i++)
+    if (patch->s[i] == HASHMAP_FULL) {
+      T x= patch->a[i].key;
+      U y= contains (x) ? bracket_ro (x) : patch->a[i].im;
       if (base[x] == y) reset (x);
       else bracket_rw (x)= y;
     }
-  }
 }
 
 TMPL void
 hashmap_rep<T, U>::post_patch (hashmap<T, U> patch, hashmap<T, U> base) {
   int i= 0, n= patch->n;
-  for (; i < n; i++) {
-    list<hashentry<T, U>> l= patch->a[i];
-    for (; !is_nil (l); l= l->next) {
-      T x= l->item.key;
-      U y= l->item.im;
+  for (; i < n; i++)
+    if (patch->s[i] == HASHMAP_FULL) {
+      T x= patch->a[i].key;
+      U y= patch->a[i].im;
       if (base[x] == y) reset (x);
       else bracket_rw (x)= y;
     }
-  }
-}
-
-TMPL list<hashentry<T, U>>
-     copy_list (list<hashentry<T, U>> l) {
-  if (is_nil (l)) return l;
-
-  hashentry<T, U>       e0 (l->item.code, l->item.key, l->item.im);
-  list<hashentry<T, U>> head (e0);
-  auto                  tail= head;
-
-  for (auto cur= l->next; !is_nil (cur); cur= cur->next) {
-    hashentry<T, U> en (cur->item.code, cur->item.key, cur->item.im);
-    tail->next= list<hashentry<T, U>> (en);
-    tail      = tail->next;
-  }
-  return head;
 }
 
 TMPL hashmap<T, U>
      copy (hashmap<T, U> h) {
+  // the copy has the same slots, so that no keys need to be rehashed
   int           i, n= h->n;
-  hashmap<T, U> h2 (h->init, n, h->max);
-  h2->size= h->size;
+  hashmap<T, U> h2 (h->init);
+  if (n == 0) return h2;
+  h2->rehash (n);
   for (i= 0; i < n; i++)
-    h2->a[i]= copy_list (h->a[i]);
+    if (h->s[i] == HASHMAP_FULL) new (h2->a + i) H (h->a[i]);
+  for (i= 0; i < n; i++)
+    h2->s[i]= h->s[i];
+  h2->size= h->size;
+  h2->used= h->used;
   return h2;
 }
 
@@ -98,13 +69,11 @@ TMPL hashmap<T, U>
      changes (hashmap<T, U> patch, hashmap<T, U> base) {
   int           i;
   hashmap<T, U> h (base->init);
-  for (i= 0; i < patch->n; i++) {
-    list<hashentry<T, U>> l (patch->a[i]);
-    while (!is_nil (l)) {
-      if (l->item.im != base[l->item.key]) h (l->item.key)= l->item.im;
-      l= l->next;
+  for (i= 0; i < patch->n; i++)
+    if (patch->s[i] == HASHMAP_FULL) {
+      H& e= patch->a[i];
+      if (e.im != base[e.key]) h (e.key)= e.im;
     }
-  }
   return h;
 }
 
@@ -112,13 +81,11 @@ TMPL hashmap<T, U>
      invert (hashmap<T, U> patch, hashmap<T, U> base) {
   int           i;
   hashmap<T, U> h (base->init);
-  for (i= 0; i < patch->n; i++) {
-    list<hashentry<T, U>> l (patch->a[i]);
-    while (!is_nil (l)) {
-      if (l->item.im != base[l->item.key]) h (l->item.key)= base[l->item.key];
-      l= l->next;
+  for (i= 0; i < patch->n; i++)
+    if (patch->s[i] == HASHMAP_FULL) {
+      H& e= patch->a[i];
+      if (e.im != base[e.key]) h (e.key)= base[e.key];
     }
-  }
   return h;
 }
 
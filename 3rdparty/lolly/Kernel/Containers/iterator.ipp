@@ -104,10 +104,9 @@ iterate (hashset<T> h) {
 // hashmap_iterator
 template <class T, class U>
 class hashmap_iterator_rep : public iterator_rep<T> {
-  hashmap<T, U>         h;
-  int                   i;
-  list<hashentry<T, U>> l;
-  void                  spool ();
+  hashmap<T, U> h;
+  int           i;
+  void          spool ();
 
 public:
   hashmap_iterator_rep (hashmap<T, U> h);
@@ -119,16 +118,13 @@ public:
 
 template <class T, class U>
 hashmap_iterator_rep<T, U>::hashmap_iterator_rep (hashmap<T, U> h2)
-    : h (h2), i (0), l (h2->a[0]) {}
+    : h (h2), i (0) {}
 
 template <class T, class U>
 void
 hashmap_iterator_rep<T, U>::spool () {
-  if (i >= h->n) return;
-  while (is_nil (l)) {
-    if ((++i) >= h->n) return;
-    l= h->a[i];
-  }
+  while (i < h->n && h->s[i] != HASHMAP_FULL)
+    i++;
 }
 
 template <class T, class U>
@@ -142,8 +138,8 @@ template <class T, class U>
 T
 hashmap_iterator_rep<T, U>::next () {
   ASSERT (busy (), "end of iterator");
-  T x (l->item.key);
-  l= l->next;
+  T x (h->a[i].key);
+  i++;
   return x;
 }
 
@@ -151,14 +147,14 @@ template <class T, class U>
 T
 hashmap_iterator_rep<T, U>::current () {
   ASSERT (busy (), "end of iterator");
-  T x (l->item.key);
+  T x (h->a[i].key);
   return x;
 }
 
 template <class T, class U>
 void
 hashmap_iterator_rep<T, U>::increase () {
-  l= l->next;
+  i++;
 }
 
 template <class T, class U>
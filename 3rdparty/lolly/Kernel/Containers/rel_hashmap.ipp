@@ -70,19 +70,14 @@ rel_hashmap_rep<T, U>::merge () {
 template <class T, class U>
 void
 rel_hashmap_rep<T, U>::find_changes (hashmap<T, U>& CH) {
-  int                   i;
-  rel_hashmap<T, U>     h (item, next);
-  list<hashentry<T, U>> remove;
-  for (i= 0; i < CH->n; i++) {
-    list<hashentry<T, U>> l (CH->a[i]);
-    while (!is_nil (l)) {
-      if (h[l->item.key] == l->item.im)
-        remove= list<hashentry<T, U>> (l->item, remove);
-      l= l->next;
-    }
-  }
+  int               i;
+  rel_hashmap<T, U> h (item, next);
+  list<T>           remove;
+  for (i= 0; i < CH->n; i++)
+    if (CH->s[i] == HASHMAP_FULL && h[CH->a[i].key] == CH->a[i].im)
+      remove= list<T> (CH->a[i].key, remove);
   while (!is_nil (remove)) {
-    CH->reset (remove->item.key);
+    CH->reset (remove->item);
     remove= remove->next;
   }
 }
@@ -90,19 +85,14 @@ rel_hashmap_rep<T, U>::find_changes (hashmap<T, U>& CH) {
 template <class T, class U>
 void
 rel_hashmap_rep<T, U>::find_differences (hashmap<T, U>& CH) {
-  int                   i;
-  list<hashentry<T, U>> add;
-  for (i= 0; i < item->n; i++) {
-    list<hashentry<T, U>> l (item->a[i]);
-    while (!is_nil (l)) {
-      if (!CH->contains (l->item.key))
-        add= list<hashentry<T, U>> (l->item, add);
-      l= l->next;
-    }
-  }
+  int     i;
+  list<T> add;
+  for (i= 0; i < item->n; i++)
+    if (item->s[i] == HASHMAP_FULL && !CH->contains (item->a[i].key))
+      add= list<T> (item->a[i].key, add);
   while (!is_nil (add)) {
-    CH (add->item.key)= next[add->item.key];
-    add               = add->next;
+    CH (add->item)= next[add->item];
+    add           = add->next;
   }
   find_changes (CH);
 }
@@ -111,13 +101,8 @@ template <class T, class U>
 void
 rel_hashmap_rep<T, U>::change (hashmap<T, U> CH) {
   int i;
-  for (i= 0; i < CH->n; i++) {
-    list<hashentry<T, U>> l (CH->a[i]);
-    while (!is_nil (l)) {
-      item (l->item.key)= l->item.im;
-      l                 = l->next;
-    }
-  }
+  for (i= 0; i < CH->n; i++)
+    if (CH->s[i] == HASHMAP_FULL) item (CH->a[i].key)= CH->a[i].im;
 }
 
 template <class T, class U>
@@ -12,6 +12,7 @@
 
 #include "string.hpp"
 #include "basic.hpp"
+#include "hashmap.hpp"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -33,26 +34,40 @@ round_length (int n) {
 
 string_rep::string_rep (int n2)
     : n (n2),
-      a ((n == 0) ? ((char*) NULL) : tm_new_array<char> (round_length (n))) {}
+      a ((n <= STRING_INLINE) ? b : tm_new_array<char> (round_length (n))),
+      h (0) {}
 
 void
 string_rep::resize (int m) {
-  int nn= round_length (n);
-  int mm= round_length (m);
-  if (mm != nn) {
-    if (mm != 0) {
-      if (nn != 0) {
-        a= tm_resize_array<char> (mm, a);
-      }
-      else {
-        a= tm_new_array<char> (mm);
-      }
+  ASSERT (h == 0, "resizing an interned string");
+  if (m <= STRING_INLINE) {
+    if (a != b) {
+      memcpy (b, a, min (n, m));
+      tm_delete_array (a);
+      a= b;
     }
-    else if (nn != 0) tm_delete_array (a);
+  }
+  else if (a == b) {
+    char* c= tm_new_array<char> (round_length (m));
+    memcpy (c, b, n);
+    a= c;
+  }
+  else {
+    int nn= round_length (n);
+    int mm= round_length (m);
+    if (mm != nn) a= tm_resize_array<char> (mm, a);
   }
   n= m;
 }
 
+void
+string::detach () {
+  // interned representations are shared by unrelated strings
+  string r (rep->n);
+  memcpy (r->a, rep->a, rep->n);
+  *this= r;
+}
+
 string::string (char c) {
   rep      = tm_new<string_rep> (1);
   rep->a[0]= c;
@@ -106,11 +121,15 @@ string::operator!= (const char* s) {
 
 bool
 string::operator== (string a) {
+  if (rep == a.rep) return true;
+  if (rep->h != 0 && a->h != 0) return false;
   return ((string_view<char>) *this) == ((string_view<char>) a);
 }
 
 bool
 string::operator!= (string a) {
+  if (rep == a.rep) return false;
+  if (rep->h != 0 && a->h != 0) return true;
   return ((string_view<char>) *this) != ((string_view<char>) a);
 }
 
@@ -129,15 +148,17 @@ string::operator() (int begin, int end) {
 
 string
 copy (string s) {
-  int    i, n= N (s);
-  string r (n);
+  const string& src= s; // reading does not detach interned strings
+  int           i, n= N (s);
+  string        r (n);
   for (i= 0; i < n; i++)
-    r[i]= s[i];
+    r[i]= src[i];
   return r;
 }
 
 string&
 operator<< (string& a, char x) {
+  if (a->h != 0) a.detach ();
   a->resize (N (a) + 1);
   a[N (a) - 1]= x;
   return a;
@@ -145,21 +166,24 @@ operator<< (string& a, char x) {
 
 string&
 operator<< (string& a, string b) {
-  int i, k1= N (a), k2= N (b);
+  const string& src= b;
+  int           i, k1= N (a), k2= N (b);
+  if (a->h != 0) a.detach ();
   a->resize (k1 + k2);
   for (i= 0; i < k2; i++)
-    a[i + k1]= b[i];
+    a[i + k1]= src[i];
   return a;
 }
 
 string
 operator* (string a, string b) {
-  int    i, n1= N (a), n2= N (b);
-  string c (n1 + n2);
+  const string &ca= a, &cb= b;
+  int           i, n1= N (a), n2= N (b);
+  string        c (n1 + n2);
   for (i= 0; i < n1; i++)
-    c[i]= a[i];
+    c[i]= ca[i];
   for (i= 0; i < n2; i++)
-    c[i + n1]= b[i];
+    c[i + n1]= cb[i];
   return c;
 }
 
@@ -185,6 +209,7 @@ operator<= (string s1, string s2) {
 
 int
 hash (string s) {
+  if (s->h != 0) return s->h;
   int h= 0;
   for (char ch : s) {
     h= (h << 9) + (h >> 23);
@@ -193,6 +218,23 @@ hash (string s) {
   return h;
 }
 
+string
+intern (string s) {
+  // the table holds a reference to each interned string, which therefore
+  // lives until the end of the program; only intern small sets of strings.
+  // Neither the table nor reference counts are synchronized, so strings
+  // may only be interned from the main thread
+  static hashmap<string, string> table ("");
+  if (s->h != 0) return s;
+  if (table->contains (s)) return table[s];
+  int h= hash (s);
+  if (h == 0) return s; // only the empty string in practice
+  string r= copy (s);
+  r->h     = h;
+  table (r)= r;
+  return r;
+}
+
 /******************************************************************************
  * Conversion routines
  ******************************************************************************/
@@ -254,10 +296,11 @@ as_double (string s) {
 
 char*
 as_charp (string s) {
-  int   i, n= N (s);
-  char* s2= tm_new_array<char> (n + 1);
+  const string& src= s;
+  int           i, n= N (s);
+  char*         s2= tm_new_array<char> (n + 1);
   for (i= 0; i < n; i++)
-    s2[i]= s[i];
+    s2[i]= src[i];
   s2[n]= '\0';
   return s2;
 }
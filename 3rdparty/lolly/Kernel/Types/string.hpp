@@ -20,21 +20,39 @@
 
 using lolly::data::string_view;
 
+/**
+ * Strings of at most STRING_INLINE characters, such as spaces, letters and
+ * digits, are stored inside their representation, which then fills 32 bytes
+ * on 64 bit systems and requires a single allocation. Interned strings are
+ * shared through a global table and cache their non zero hash code. The
+ * non const operator[], begin () and end () may be used for writing and
+ * therefore first replace them by a private copy; read them through a const
+ * reference in order to keep them shared. string_rep::resize must not be
+ * applied to interned strings.
+ */
+#define STRING_INLINE 4
+
 class string;
 class string_rep : concrete_struct {
   int   n;
   char* a;
+  int   h;                // hash code of interned strings, 0 otherwise
+  char  b[STRING_INLINE]; // inline storage of short strings
 
 public:
-  inline string_rep () : n (0), a (NULL) {}
+  inline string_rep () : n (0), a (b), h (0) {}
   string_rep (int n);
   inline ~string_rep () {
-    if (n != 0) tm_delete_array (a);
+    if (a != b) tm_delete_array (a);
   }
   void resize (int n);
 
   friend class string;
   friend inline int N (string a);
+  friend int        hash (string s);
+  friend string     intern (string s);
+  friend string&    operator<< (string& a, char);
+  friend string&    operator<< (string& a, string b);
 };
 
 class string {
@@ -45,14 +63,27 @@ class string {
   string (char c, int n);
   string (const char* s);
   string (const char* s, int n);
-  inline char& operator[] (int i) { return rep->a[i]; }
+  inline char& operator[] (int i) {
+    if (rep->h != 0) detach ();
+    return rep->a[i];
+  }
+  inline char  operator[] (int i) const { return rep->a[i]; }
   bool         operator== (const char* s);
   bool         operator!= (const char* s);
   bool         operator== (string s);
   bool         operator!= (string s);
   string       operator() (int start, int end);
-  char*        begin () { return rep->a; }
-  char*        end () { return rep->a + rep->n; }
+  char*        begin () {
+    if (rep->h != 0) detach ();
+    return rep->a;
+  }
+  char* end () {
+    if (rep->h != 0) detach ();
+    return rep->a + rep->n;
+  }
+  const char* begin () const { return rep->a; }
+  const char* end () const { return rep->a + rep->n; }
+  void detach ();
 
   inline operator string_view<char> () {
     return string_view<char> (rep->a, rep->n);
@@ -73,6 +104,7 @@ string  operator* (string a, const char* b);
 bool    operator< (string a, string b);
 bool    operator<= (string a, string b);
 int     hash (string s);
+string  intern (string s);
 
 bool     as_bool (string s);
 int      as_int (string s);
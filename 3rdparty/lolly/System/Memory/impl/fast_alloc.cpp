@@ -5,6 +5,7 @@
  *              of allocations for each fixed size divisible by
  *              a word legth up to MAX_FAST. Otherwise,
  *              usual memory allocation is used.
+ *              Each thread allocates from its own arena of linked lists.
  * ASSUMPTIONS: The word size of the computer is 4.
  *              Otherwise, change WORD_LENGTH.
  * COPYRIGHT  : (C) 1999  Joris van der Hoeven
@@ -16,34 +17,91 @@
 
 #include "fast_alloc.hpp"
 #include "tm_ostream.hpp"
+#include <atomic>
 #include <cstring>
+#include <new>
+#include <stdint.h>
+#if defined(OS_WIN) || defined(OS_MINGW)
+#include <malloc.h>
+#endif
 
 /******************************************************************************
- * Globals
+ * Arenas
+ *
+ * Every thread allocates small blocks from its own arena, which holds the
+ * linked lists of free blocks for each size and the chunk being cut.
+ * Chunks are aligned on BLOCK_SIZE and start with a pointer to the arena
+ * which owns them.  Blocks freed by another thread are pushed on a lock-free
+ * queue of their owner and taken back by the owner once its own list for
+ * that size runs empty.  The arenas of finished threads are reused by new
+ * threads.  Counters are only written by the owner of an arena (or
+ * atomically for remote frees), so that mem_used and mem_info may read them
+ * from any thread.
  ******************************************************************************/
 
-void* alloc_table[MAX_FAST]; // Static declaration initializes with NULL's
-char* alloc_mem= NULL;
+#define CHUNK_HEADER (2 * WORD_LENGTH)
+#define SIZE_CLASSES (MAX_FAST / WORD_LENGTH + 1)
+
+struct fast_arena {
+  void*              alloc_table[MAX_FAST];  // free lists, indexed by size
+  char*              alloc_mem;              // free space in current chunk
+  size_t             alloc_remains;          // size of this free space
+  std::atomic<void*> remote[SIZE_CLASSES];   // blocks freed by other threads
+  std::atomic<long>  small_uses;             // small blocks handed out
+  std::atomic<long>  remote_uses;            // ... and freed by other threads
+  std::atomic<int>   fast_chunks;            // number of allocated chunks
+  std::atomic<bool>  in_use;                 // owned by a running thread
+  int                id;                     // number of the arena
+  fast_arena*        next;                   // next arena in the registry
+
+  fast_arena (int id2)
+      : alloc_mem (NULL), alloc_remains (0), small_uses (0), remote_uses (0),
+        fast_chunks (0), in_use (true), id (id2), next (NULL) {
+    for (int i= 0; i < MAX_FAST; i++)
+      alloc_table[i]= NULL;
+    for (int i= 0; i < SIZE_CLASSES; i++)
+      remote[i].store (NULL, std::memory_order_relaxed);
+  }
+};
+
+static std::atomic<fast_arena*> arenas (NULL);
+static std::atomic<int>         arena_count (0);
+static std::atomic<long>        large_uses (0);
+static thread_local fast_arena* current_arena= NULL;
+static thread_local bool        arena_released= false;
+
+struct fast_arena_release {
+  ~fast_arena_release () {
+    if (current_arena != NULL)
+      current_arena->in_use.store (false, std::memory_order_release);
+    current_arena = NULL;
+    arena_released= true;
+  }
+};
+static thread_local fast_arena_release arena_release;
+
 #ifdef DEBUG_ON
 char* alloc_mem_top   = NULL;
 char* alloc_mem_bottom= (char*) ((unsigned long long) -1);
 #endif
-size_t alloc_remains= 0;
-int    allocated    = 0;
-int    fast_chunks  = 0;
-int    large_uses   = 0;
-int    MEM_DEBUG    = 0;
+int MEM_DEBUG= 0;
 
 /*****************************************************************************/
 // General purpose fast allocation routines
 /*****************************************************************************/
 
-#define alloc_ptr(i) alloc_table[i]
+#define alloc_ptr(a, i) ((a)->alloc_table[i])
 #define ind(ptr) (*((void**) ptr))
 
 bool break_stub (void* ptr);
 int  mem_used ();
 
+static inline void
+add_count (std::atomic<long>& c, long d) {
+  // only the owner of an arena writes its counters
+  c.store (c.load (std::memory_order_relaxed) + d, std::memory_order_relaxed);
+}
+
 void*
 safe_malloc (size_t sz) {
   void* ptr= malloc (sz);
@@ -54,67 +112,150 @@ safe_malloc (size_t sz) {
   return ptr;
 }
 
-void*
-enlarge_malloc (size_t sz) {
-  if (alloc_remains < sz) {
-    if (alloc_remains > 0) {
-      ind (alloc_mem)          = alloc_ptr (alloc_remains);
-      alloc_ptr (alloc_remains)= alloc_mem;
+static char*
+chunk_malloc (fast_arena* a) {
+  void* ptr= NULL;
+#if defined(OS_WIN) || defined(OS_MINGW)
+  ptr= _aligned_malloc (BLOCK_SIZE, BLOCK_SIZE);
+#else
+  if (posix_memalign (&ptr, BLOCK_SIZE, BLOCK_SIZE) != 0) ptr= NULL;
+#endif
+  if (ptr == NULL) {
+    cerr << "Fatal error: out of memory\n";
+    abort ();
+  }
+  *((fast_arena**) ptr)= a;
+  return ((char*) ptr) + CHUNK_HEADER;
+}
+
+static inline fast_arena*
+chunk_owner (void* ptr) {
+  return *((fast_arena**) (((uintptr_t) ptr) & ~((uintptr_t) BLOCK_SIZE - 1)));
+}
+
+static fast_arena*
+acquire_arena () {
+  fast_arena* a= arenas.load (std::memory_order_acquire);
+  for (; a != NULL; a= a->next) {
+    bool busy= false;
+    if (!a->in_use.load (std::memory_order_relaxed) &&
+        a->in_use.compare_exchange_strong (busy, true,
+                                           std::memory_order_acquire))
+      break;
+  }
+  if (a == NULL) {
+    a= new (safe_malloc (sizeof (fast_arena))) fast_arena (arena_count++);
+    a->next= arenas.load (std::memory_order_relaxed);
+    while (!arenas.compare_exchange_weak (a->next, a, std::memory_order_release,
+                                          std::memory_order_relaxed))
+      ;
+  }
+  current_arena= a;
+  // give the arena back when the thread exits
+  if (!arena_released) (void) &arena_release;
+  return a;
+}
+
+static inline fast_arena*
+get_arena () {
+  fast_arena* a= current_arena;
+  return a == NULL ? acquire_arena () : a;
+}
+
+static void*
+enlarge_malloc (fast_arena* a, size_t sz) {
+  std::atomic<void*>& queue= a->remote[sz / WORD_LENGTH];
+  if (queue.load (std::memory_order_relaxed) != NULL) {
+    void* ptr= queue.exchange (NULL, std::memory_order_acquire);
+    alloc_ptr (a, sz)= ind (ptr);
+    return ptr;
+  }
+  if (a->alloc_remains < sz) {
+    if (a->alloc_remains > 0) {
+      ind (a->alloc_mem)             = alloc_ptr (a, a->alloc_remains);
+      alloc_ptr (a, a->alloc_remains)= a->alloc_mem;
     }
-    alloc_mem= (char*) safe_malloc (BLOCK_SIZE);
+    a->alloc_mem= chunk_malloc (a);
 #ifdef DEBUG_ON
-    alloc_mem_top= alloc_mem_top >= alloc_mem + BLOCK_SIZE
+    alloc_mem_top= alloc_mem_top >= a->alloc_mem + BLOCK_SIZE
                        ? alloc_mem_top
-                       : (alloc_mem + BLOCK_SIZE);
+                       : (a->alloc_mem + BLOCK_SIZE);
     alloc_mem_bottom=
-        alloc_mem_bottom > alloc_mem ? alloc_mem : alloc_mem_bottom;
+        alloc_mem_bottom > a->alloc_mem ? a->alloc_mem : alloc_mem_bottom;
 #endif
-    alloc_remains= BLOCK_SIZE;
-    fast_chunks++;
+    a->alloc_remains= BLOCK_SIZE - CHUNK_HEADER;
+    a->fast_chunks.store (a->fast_chunks.load (std::memory_order_relaxed) + 1,
+                          std::memory_order_relaxed);
   }
-  void* ptr= alloc_mem;
-  alloc_mem+= sz;
-  alloc_remains-= sz;
+  void* ptr= a->alloc_mem;
+  a->alloc_mem+= sz;
+  a->alloc_remains-= sz;
   return ptr;
 }
 
-void*
-fast_alloc (size_t sz) {
-  sz= (sz + WORD_LENGTH_INC) & WORD_MASK;
-  if (sz < MAX_FAST) {
-    void* ptr= alloc_ptr (sz);
-    if (ptr == NULL) return enlarge_malloc (sz);
-    alloc_ptr (sz)= ind (ptr);
+static inline void*
+small_alloc (size_t sz) {
+  fast_arena* a  = get_arena ();
+  void*       ptr= alloc_ptr (a, sz);
+  if (ptr == NULL) ptr= enlarge_malloc (a, sz);
+  else alloc_ptr (a, sz)= ind (ptr);
+  add_count (a->small_uses, sz);
 #ifdef DEBUG_ON
-    break_stub (ptr);
+  break_stub (ptr);
 #endif
-    return ptr;
+  return ptr;
+}
+
+static inline void
+small_free (void* ptr, size_t sz) {
+  fast_arena* owner= chunk_owner (ptr);
+#ifdef DEBUG_ON
+  break_stub (ptr);
+#endif
+  if (owner == current_arena) {
+    ind (ptr)             = alloc_ptr (owner, sz);
+    alloc_ptr (owner, sz)= ptr;
+    add_count (owner->small_uses, -((long) sz));
   }
   else {
-    if (MEM_DEBUG >= 3) cout << "Big alloc of " << sz << " bytes\n";
-    if (MEM_DEBUG >= 3) cout << "Memory used: " << mem_used () << " bytes\n";
-    large_uses+= sz;
-    return safe_malloc (sz);
+    std::atomic<void*>& queue= owner->remote[sz / WORD_LENGTH];
+    void*               head = queue.load (std::memory_order_relaxed);
+    do {
+      ind (ptr)= head;
+    } while (!queue.compare_exchange_weak (
+        head, ptr, std::memory_order_release, std::memory_order_relaxed));
+    owner->remote_uses.fetch_add (sz, std::memory_order_relaxed);
   }
 }
 
+static inline void*
+large_alloc (size_t sz) {
+  if (MEM_DEBUG >= 3) cout << "Big alloc of " << sz << " bytes\n";
+  if (MEM_DEBUG >= 3) cout << "Memory used: " << mem_used () << " bytes\n";
+  large_uses.fetch_add (sz, std::memory_order_relaxed);
+  return safe_malloc (sz);
+}
+
+static inline void
+large_free (void* ptr, size_t sz) {
+  if (MEM_DEBUG >= 3) cout << "Big free of " << sz << " bytes\n";
+  large_uses.fetch_sub (sz, std::memory_order_relaxed);
+  free (ptr);
+  if (MEM_DEBUG >= 3) cout << "Memory used: " << mem_used () << " bytes\n";
+}
+
+void*
+fast_alloc (size_t sz) {
+  sz= (sz + WORD_LENGTH_INC) & WORD_MASK;
+  if (sz < MAX_FAST) return small_alloc (sz);
+  else return large_alloc (sz);
+}
+
 void
 fast_free (void* ptr, size_t sz) {
   sz= (sz + WORD_LENGTH_INC) & WORD_MASK;
-  if (sz < MAX_FAST) {
-#ifdef DEBUG_ON
-    break_stub (ptr);
-    break_stub (alloc_ptr (sz));
-#endif
-    ind (ptr)     = alloc_ptr (sz);
-    alloc_ptr (sz)= ptr;
-  }
-  else {
-    if (MEM_DEBUG >= 3) cout << "Big free of " << sz << " bytes\n";
-    large_uses-= sz;
-    free (ptr);
-    if (MEM_DEBUG >= 3) cout << "Memory used: " << mem_used () << " bytes\n";
-  }
+  if (sz < MAX_FAST) small_free (ptr, sz);
+  else large_free (ptr, sz);
 }
 
 void*
@@ -125,7 +266,8 @@ fast_realloc (void* ptr, size_t old_size, size_t new_size) {
     if (MEM_DEBUG >= 3)
       cout << "Big realloc from " << old_size << " to " << new_size
            << " bytes\n";
-    large_uses+= new_size - old_size;
+    large_uses.fetch_add ((long) new_size - (long) old_size,
+                          std::memory_order_relaxed);
     if (MEM_DEBUG >= 3) cout << "Memory used: " << mem_used () << " bytes\n";
     return realloc (ptr, new_size);
   }
@@ -145,20 +287,10 @@ fast_new (size_t s) {
 #else
   s= (s + WORD_LENGTH + WORD_LENGTH_INC) & WORD_MASK;
 #endif
-  if (s < MAX_FAST) {
-    ptr= alloc_ptr (s);
-    if (ptr == NULL) ptr= enlarge_malloc (s);
-    else alloc_ptr (s)= ind (ptr);
-#ifdef DEBUG_ON
-    break_stub (ptr);
-#endif
-  }
+  if (s < MAX_FAST) ptr= small_alloc (s);
   else {
-    if (MEM_DEBUG >= 3) cout << "Big alloc of " << s << " bytes\n";
-    if (MEM_DEBUG >= 3) cout << "Memory used: " << mem_used () << " bytes\n";
-    ptr= safe_malloc (s);
+    ptr= large_alloc (s);
     // if ((((int) ptr) & 15) != 0) cout << "Unaligned new " << ptr << "\n";
-    large_uses+= s;
   }
 #ifdef DEBUG_ON
   char* mem                        = (char*) ptr;
@@ -208,20 +340,10 @@ fast_delete (void* ptr) {
   ptr     = (void*) (((char*) ptr) - WORD_LENGTH);
   size_t s= *((size_t*) ptr);
 #endif
-  if (s < MAX_FAST) {
-#ifdef DEBUG_ON
-    break_stub (ptr);
-    break_stub (alloc_ptr (s));
-#endif
-    ind (ptr)    = alloc_ptr (s);
-    alloc_ptr (s)= ptr;
-  }
+  if (s < MAX_FAST) small_free (ptr, s);
   else {
-    if (MEM_DEBUG >= 3) cout << "Big free of " << s << " bytes\n";
     // if ((((int) ptr) & 15) != 0) cout << "Unaligned delete " << ptr << "\n";
-    free (ptr);
-    large_uses-= s;
-    if (MEM_DEBUG >= 3) cout << "Memory used: " << mem_used () << " bytes\n";
+    large_free (ptr, s);
   }
 }
 
@@ -231,21 +353,13 @@ fast_delete (void* ptr) {
 
 void*
 fast_alloc_mw (size_t s) {
-  if (s < MAX_FAST) {
-    void* ptr= alloc_ptr (s);
-    if (ptr == NULL) return enlarge_malloc (s);
-    alloc_ptr (s)= ind (ptr);
-    return ptr;
-  }
+  if (s < MAX_FAST) return small_alloc (s);
   else return safe_malloc (s);
 }
 
 void
 fast_free_mw (void* ptr, size_t s) {
-  if (s < MAX_FAST) {
-    ind (ptr)    = alloc_ptr (s);
-    alloc_ptr (s)= ptr;
-  }
+  if (s < MAX_FAST) small_free (ptr, s);
   else free (ptr);
 }
 
@@ -253,43 +367,48 @@ fast_free_mw (void* ptr, size_t s) {
  * Statistics
  ******************************************************************************/
 
-int
-compute_free (void* ptr) {
-  int i= -1;
-  while (ptr != NULL) {
-    i++;
-    ptr= ind (ptr);
-  }
-  return i;
+static long
+arena_uses (fast_arena* a) {
+  return a->small_uses.load (std::memory_order_relaxed) -
+         a->remote_uses.load (std::memory_order_relaxed);
 }
 
 int
 mem_used () {
-  int free_bytes= alloc_remains;
-  int chunks_use= BLOCK_SIZE * fast_chunks;
-  int i;
-  for (i= WORD_LENGTH; i < MAX_FAST; i+= WORD_LENGTH)
-    free_bytes+= i * compute_free (alloc_table + i);
-  int small_uses= chunks_use - free_bytes;
-  return small_uses + large_uses;
+  long small_uses= 0;
+  for (fast_arena* a= arenas.load (std::memory_order_acquire); a != NULL;
+       a            = a->next)
+    small_uses+= arena_uses (a);
+  return (int) (small_uses + large_uses.load (std::memory_order_relaxed));
 }
 
 void
 mem_info () {
   cout << "\n---------------- memory statistics ----------------\n";
-  int free_bytes= alloc_remains;
-  int chunks_use= BLOCK_SIZE * fast_chunks;
-  int i;
-  for (i= WORD_LENGTH; i < MAX_FAST; i+= WORD_LENGTH)
-    free_bytes+= i * compute_free (alloc_table + i);
-  int small_uses= chunks_use - free_bytes;
-  int total_uses= small_uses + large_uses;
-  // cout << "Fast chunks   : " << chunks_use << " bytes\n";
-  // cout << "Free on chunks: " << alloc_remains << " bytes\n";
+  long small_uses= 0, chunks_use= 0;
+  for (fast_arena* a= arenas.load (std::memory_order_acquire); a != NULL;
+       a            = a->next) {
+    small_uses+= arena_uses (a);
+    chunks_use+= ((long) BLOCK_SIZE) *
+                 a->fast_chunks.load (std::memory_order_relaxed);
+  }
+  long total_uses= small_uses + large_uses.load (std::memory_order_relaxed);
   cout << "User          : " << total_uses << " bytes\n";
-  cout << "Allocator     : " << chunks_use + large_uses << " bytes\n";
+  cout << "Allocator     : "
+       << chunks_use + large_uses.load (std::memory_order_relaxed)
+       << " bytes\n";
   cout << "Small mallocs : "
        << ((100 * ((float) small_uses)) / ((float) total_uses)) << "%\n";
+  if (arena_count.load (std::memory_order_relaxed) <= 1) return;
+  for (fast_arena* a= arenas.load (std::memory_order_acquire); a != NULL;
+       a            = a->next) {
+    cout << "Arena " << a->id << "       : " << arena_uses (a) << " bytes in "
+         << a->fast_chunks.load (std::memory_order_relaxed) << " chunks, "
+         << a->remote_uses.load (std::memory_order_relaxed)
+         << " bytes freed by other threads";
+    if (!a->in_use.load (std::memory_order_relaxed)) cout << " (idle)";
+    cout << "\n";
+  }
 }
 
 #ifdef DEBUG_ON
@@ -317,15 +436,8 @@ void*
 operator new (size_t s) {
   void* ptr;
   s= (s + WORD_LENGTH + WORD_LENGTH_INC) & WORD_MASK;
-  if (s < MAX_FAST) {
-    ptr= alloc_ptr (s);
-    if (ptr == NULL) ptr= enlarge_malloc (s);
-    else alloc_ptr (s)= ind (ptr);
-  }
-  else {
-    ptr= safe_malloc (s);
-    large_uses+= s;
-  }
+  if (s < MAX_FAST) ptr= small_alloc (s);
+  else ptr= large_alloc (s);
   *((size_t*) ptr)= s;
   return (void*) (((char*) ptr) + WORD_LENGTH);
 }
@@ -334,29 +446,16 @@ void
 operator delete (void* ptr) {
   ptr     = (void*) (((char*) ptr) - WORD_LENGTH);
   size_t s= *((size_t*) ptr);
-  if (s < MAX_FAST) {
-    ind (ptr)    = alloc_ptr (s);
-    alloc_ptr (s)= ptr;
-  }
-  else {
-    free (ptr);
-    large_uses-= s;
-  }
+  if (s < MAX_FAST) small_free (ptr, s);
+  else large_free (ptr, s);
 }
 
 void*
 operator new[] (size_t s) {
   void* ptr;
   s= (s + WORD_LENGTH + WORD_LENGTH_INC) & WORD_MASK;
-  if (s < MAX_FAST) {
-    ptr= alloc_ptr (s);
-    if (ptr == NULL) ptr= enlarge_malloc (s);
-    else alloc_ptr (s)= ind (ptr);
-  }
-  else {
-    ptr= safe_malloc (s);
-    large_uses+= s;
-  }
+  if (s < MAX_FAST) ptr= small_alloc (s);
+  else ptr= large_alloc (s);
   *((size_t*) ptr)= s;
   return (void*) (((char*) ptr) + WORD_LENGTH);
 }
@@ -365,14 +464,8 @@ void
 operator delete[] (void* ptr) {
   ptr     = (void*) (((char*) ptr) - WORD_LENGTH);
   size_t s= *((size_t*) ptr);
-  if (s < MAX_FAST) {
-    ind (ptr)    = alloc_ptr (s);
-    alloc_ptr (s)= ptr;
-  }
-  else {
-    free (ptr);
-    large_uses-= s;
-  }
+  if (s < MAX_FAST) small_free (ptr, s);
+  else large_free (ptr, s);
 }
 
 #endif // defined(X11TEXMACS) && (!defined(NO_FAST_ALLOC))
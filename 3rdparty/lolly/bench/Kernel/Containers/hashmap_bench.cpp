@@ -1,4 +1,5 @@
 #include "hashmap.hpp"
+#include "string.hpp"
 #include <iostream>
 #include <nanobench.h>
 #include <vector>
@@ -49,7 +50,7 @@ main () {
     }
   });
   bench.run ("reset() all entries", [&] {
-    hashmap<KeyType, ValueType> h2= hm;
+    hashmap<KeyType, ValueType> h2= copy (hm);
     for (auto k : keys) {
       h2->reset (k);
     }
@@ -77,18 +78,14 @@ main () {
     (void) eq;
   });
 
-  auto make_chain= [&] (int M) {
-    list<hashentry<int, int>> tmp;
-    for (int i= 0; i < M; ++i) {
-      tmp= list<hashentry<int, int>> (
-          hashentry<int, int> (0, /*code*/ i, /*im*/ 42), tmp);
+  bench.run ("lookup [operator[]] miss", [&] {
+    for (auto k : keys) {
+      volatile ValueType v= hm[k + N];
+      (void) v;
     }
-    return tmp;
-  };
-
-  auto chain= make_chain (10000);
-  bench.run ("copy_list", [&] {
-    auto c= copy_list (chain);
+  });
+  bench.run ("copy()", [&] {
+    auto c= copy (hm);
     ankerl::nanobench::doNotOptimizeAway (c);
   });
   bench.run ("single resize op", [&] {
@@ -98,5 +95,58 @@ main () {
     h (8)= 1;
   });
 
+  std::vector<string> names;
+  names.reserve (N);
+  for (int i= 0; i < N; ++i) {
+    names.push_back (string ("var-") * as_string (i % 500) * "-" *
+                     as_string (i / 500));
+  }
+  bench.run ("insert string keys", [&] {
+    hashmap<string, int> h (0);
+    for (auto& k : names) {
+      h (k)= 42;
+    }
+  });
+
+  hashmap<string, int> hs (0);
+  for (auto& k : names) {
+    hs (k)= 42;
+  }
+  bench.run ("lookup string keys", [&] {
+    for (auto& k : names) {
+      volatile int v= hs[k];
+      (void) v;
+    }
+  });
+  bench.run ("small maps with three string keys", [&] {
+    for (int i= 0; i + 2 < N; i+= 3) {
+      hashmap<string, int> h (0);
+      h (names[i])    = 1;
+      h (names[i + 1])= 2;
+      h (names[i + 2])= 3;
+      ankerl::nanobench::doNotOptimizeAway (h[names[i + 1]]);
+    }
+  });
+
+  int used= mem_used ();
+  {
+    hashmap<KeyType, ValueType> h;
+    for (auto k : keys) {
+      h (k)= 42;
+    }
+    std::cout << "memory per entry, int keys: "
+              << (double) (mem_used () - used) / N << " bytes" << std::endl;
+  }
+  used= mem_used ();
+  {
+    hashmap<string, int> h (0);
+    for (auto& k : names) {
+      h (k)= 42;
+    }
+    std::cout << "memory per entry, string keys: "
+              << (double) (mem_used () - used) / N
+              << " bytes (keys are shared)" << std::endl;
+  }
+
   return 0;
 }
@@ -27,6 +27,10 @@ main () {
         b ("equality of larger strinG");
     a == b;
   });
+  bench.run ("equality of interned string", [&] {
+    static string a= intern ("abc"), b= intern ("abd");
+    a == b;
+  });
   bench.run ("compare string", [&] {
     static string a ("ab"), b ("b");
     a <= b;
@@ -60,6 +64,14 @@ main () {
     static string a ("compare larger string ,compute hash of LARGER string");
     hash (a);
   });
+  bench.run ("hash of interned string", [&] {
+    static string a= intern ("compare larger string ,compute hash of LARGER");
+    hash (a);
+  });
+  bench.run ("intern string", [&] {
+    static string a ("accde");
+    intern (a);
+  });
   bench.run ("is quoted", [&] {
     static string a ("H\"ello TeXmacs\"");
     is_quoted (a);
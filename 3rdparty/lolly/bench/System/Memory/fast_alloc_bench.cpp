@@ -8,6 +8,10 @@
 #include "fast_alloc.hpp"
 #include "sys_utils.hpp"
 #include <nanobench.h>
+#ifndef OS_WASM
+#include <thread>
+#include <vector>
+#endif
 static ankerl::nanobench::Bench bench;
 
 struct Complex {
@@ -131,5 +135,47 @@ main () {
       tm_delete_array (volume[i]);
     }
   });
+
+#ifndef OS_WASM
+  constexpr int THREADS= 4;
+  bench.batch (NUM * THREADS).run ("multi-threaded, local collect", [&] {
+    std::vector<std::thread> workers;
+    for (int t= 0; t < THREADS; t++)
+      workers.emplace_back ([] {
+        Complex* local[NUM];
+        for (int i= 0; i < NUM; i++) {
+          local[i]= tm_new<Complex> ();
+        }
+        for (int i= 0; i < NUM; i++) {
+          tm_delete (local[i]);
+        }
+      });
+    for (auto& w : workers)
+      w.join ();
+  });
+
+  std::vector<Complex*> handoff[THREADS];
+  bench.batch (NUM * THREADS).run ("multi-threaded, cross-thread collect", [&] {
+    std::vector<std::thread> workers;
+    for (int t= 0; t < THREADS; t++)
+      workers.emplace_back ([&handoff, t] {
+        handoff[t].resize (NUM);
+        for (int i= 0; i < NUM; i++) {
+          handoff[t][i]= tm_new<Complex> ();
+        }
+      });
+    for (auto& w : workers)
+      w.join ();
+    workers.clear ();
+    for (int t= 0; t < THREADS; t++)
+      workers.emplace_back ([&handoff, t] {
+        for (Complex* p : handoff[(t + 1) % THREADS]) {
+          tm_delete (p);
+        }
+      });
+    for (auto& w : workers)
+      w.join ();
+  });
+#endif
   return 0;
 }
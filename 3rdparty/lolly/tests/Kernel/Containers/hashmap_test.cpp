@@ -1,5 +1,6 @@
 #include "a_lolly_test.hpp"
 #include "hashmap.hpp"
+#include "iterator.hpp"
 #include <string>
 
 TEST_CASE ("test_resize") {
@@ -193,3 +194,26 @@ TEST_CASE ("hashmap default") {
   CHECK_EQ (map == equal_map, false);
   CHECK (map != not_equal_map);
 }
+
+TEST_CASE ("test reset and reinsert") {
+  auto hm= hashmap<string, int> (0);
+  for (int i= 0; i < 1000; i++)
+    hm (as_string (i))= i;
+  for (int i= 0; i < 1000; i+= 2)
+    hm->reset (as_string (i));
+  CHECK_EQ (N (hm), 500);
+  for (int i= 0; i < 1000; i+= 4)
+    hm (as_string (i))= -i;
+  CHECK_EQ (N (hm), 750);
+  for (int i= 0; i < 1000; i++) {
+    int expected= (i % 4 == 0 ? -i : (i % 2 == 0 ? 0 : i));
+    CHECK_EQ (hm[as_string (i)], expected);
+    CHECK_EQ (hm->contains (as_string (i)), i % 4 != 2);
+  }
+  int count= 0;
+  for (auto k : iterate (hm)) {
+    CHECK_EQ (hm->contains (k), true);
+    count++;
+  }
+  CHECK_EQ (count, 750);
+}
@@ -64,6 +64,69 @@ TEST_CASE ("test append") {
   CHECK_EQ (str == string ("xyz"), true);
 }
 
+TEST_CASE ("test resize across inline storage") {
+  string str ("0123456789");
+  str << string ("abcdef");
+  CHECK_EQ (str == string ("0123456789abcdef"), true);
+  str->resize (3);
+  CHECK_EQ (str == string ("012"), true);
+  for (int i= 0; i < 40; i++)
+    str << 'x';
+  CHECK_EQ (N (str), 43);
+  CHECK_EQ (str (0, 5) == string ("012xx"), true);
+}
+
+TEST_CASE ("test intern") {
+  string a= intern (string ("abc"));
+  string b= intern (string ("ab") * "c");
+  CHECK_EQ (a == b, true);
+  CHECK_EQ (a != b, false);
+  CHECK_EQ (a == intern ("abd"), false);
+  CHECK_EQ (a == string ("abc"), true);
+  CHECK_EQ (hash (a), hash (string ("abc")));
+  // appending to an interned string leaves the shared copy untouched
+  string c= b;
+  c << string ("d");
+  CHECK_EQ (c == string ("abcd"), true);
+  CHECK_EQ (intern ("abc") == string ("abc"), true);
+}
+
+TEST_CASE ("test writing to an interned string") {
+  string a= intern (string ("abc"));
+  string b= a;
+  b[0]    = 'x';
+  CHECK_EQ (b == string ("xbc"), true);
+  CHECK_EQ (a == string ("abc"), true);
+  // the table still maps the old contents to the untouched shared copy
+  CHECK_EQ (intern (string ("abc")) == a, true);
+  CHECK_EQ (intern (string ("abc")) == string ("abc"), true);
+  CHECK_EQ (intern (string ("xbc")) == b, true);
+  CHECK_EQ (intern (string ("xbc")) != a, true);
+  string c= intern (string ("abc"));
+  for (char& ch : c)
+    ch= 'y';
+  CHECK_EQ (c == string ("yyy"), true);
+  CHECK_EQ (intern (string ("abc")) == string ("abc"), true);
+  CHECK_EQ (hash (intern (string ("abc"))), hash (string ("abc")));
+}
+
+TEST_CASE ("test reading an interned string") {
+  string        a = intern (string ("abc"));
+  string        b = a;
+  const string& cb= b;
+  char          c = cb[0];
+  int           n = 0;
+  for (char ch : cb)
+    if (ch == 'b' || ch == 'c') n++;
+  CHECK_EQ (c, 'a');
+  CHECK_EQ (n, 2);
+  // reads through a const reference keep the representation shared
+  CHECK_EQ (b.operator->() == a.operator->(), true);
+  CHECK_EQ (copy (b) == string ("abc"), true);
+  CHECK_EQ (b * "d" == string ("abcd"), true);
+  CHECK_EQ (b.operator->() == a.operator->(), true);
+}
+
 /******************************************************************************
  * Conversions
  ******************************************************************************/
@@ -1,6 +1,10 @@
 #include "a_lolly_test.hpp"
 #include "fast_alloc.hpp"
 #include "tm_timer.hpp"
+#if !defined(OS_WASM) && !defined(DOCTEST_CONFIG_NO_MULTITHREADING)
+#include <thread>
+#include <vector>
+#endif
 
 struct Complex {
 public:
@@ -98,3 +102,31 @@ TEST_CASE ("test large bunch of tm_*_array with class") {
 }
 
 TEST_MEMORY_LEAK_ALL
+
+#if !defined(OS_WASM) && !defined(DOCTEST_CONFIG_NO_MULTITHREADING)
+TEST_CASE ("test tm_* from several threads") {
+  const int                threads= 4, bnum= 10000;
+  std::vector<int*>        handoff[threads];
+  std::vector<std::thread> workers;
+  for (int t= 0; t < threads; t++)
+    workers.emplace_back ([&handoff, t] {
+      for (int i= 0; i < bnum; i++) {
+        int* p= tm_new<int> (i);
+        if (i % 2 == 0) tm_delete (p);
+        else handoff[t].push_back (p);
+      }
+    });
+  for (auto& w : workers)
+    w.join ();
+  for (int t= 0; t < threads; t++) {
+    CHECK_EQ ((int) handoff[t].size (), bnum / 2);
+    CHECK_EQ (*handoff[t][0], 1);
+  }
+  // free on the main thread what other threads allocated
+  for (int t= 0; t < threads; t++)
+    for (int* p : handoff[t])
+      tm_delete (p);
+}
+
+TEST_MEMORY_LEAK_ALL
+#endif
@@ -220,7 +220,7 @@ function add_bench_target(filepath)
         end
 
         if is_plat("linux") then
-            add_syslinks("stdc++", "m")
+            add_syslinks("stdc++", "m", "pthread")
         end
 
         if is_plat("windows") then
@@ -328,7 +328,7 @@ if has_config("enable_tests") then
         add_packages("doctest")
 
         if is_plat("linux") then
-            add_syslinks("stdc++", "m")
+            add_syslinks("stdc++", "m", "pthread")
         elseif is_plat("windows") or is_plat("mingw") then
             add_syslinks("secur32", "shell32")
         end
@@ -71,7 +71,12 @@
       ("History" (show-history))
       ("Memory usage" (show-meminfo)))
   (-> "Timings"
-      ("All" (bench-print-all)))
+      ("All" (bench-print-all))
+      (when (profile-enabled?)
+        ---
+        ("Reset typesetting trace" (profile-reset))
+        ("Export typesetting trace"
+         (choose-file profile-export "Export typesetting trace" "generic"))))
   (-> "Memory"
       ("Show memory usage in the console" (show-meminfo))
       ("Show memory usage in the footer" (set! footer-hook show-memory-information))
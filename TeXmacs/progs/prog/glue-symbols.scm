@@ -81,6 +81,9 @@
 "texmacs-memory"
 "bench-print"
 "bench-print-all"
+"profile-enabled?"
+"profile-reset"
+"profile-export"
 "system-wait"
 "set-latex-command"
 "set-bibtex-command"
@@ -704,6 +707,9 @@
 "buffer-load"
 "buffer-export"
 "buffer-save"
+"buffer-journal-reset"
+"buffer-journal-append"
+"buffer-journal-replay"
 "tree-import-loaded"
 "tree-import"
 "tree-inclusion"
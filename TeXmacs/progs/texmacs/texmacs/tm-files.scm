@@ -463,10 +463,15 @@
        (== (most-recent-suffix name) "#")))
 
 (define (autosave-remove name)
-  (when (url-exists? (url-glue name "~"))
-    (url-remove (url-glue name "~")))
-  (when (url-exists? (url-glue name "#"))
-    (url-remove (url-glue name "#"))))
+  (for (suffix (list "~" "#" "~j"))
+    (when (url-exists? (url-glue name suffix))
+      (url-remove (url-glue name suffix)))))
+
+(define (autosave-journal? name)
+  (and (== (get-preference "autosave journal") "on")
+       (not (rescue-mode?))
+       (not (url-scratch? name))
+       (not (url-rooted-tmfs? name))))
 
 (tm-define (autosave-buffer name)
   (when (and (buffer-modified-since-autosave? name)
@@ -482,6 +487,9 @@
              (when (not (rescue-mode?))
                (set-message `(concat "Warning: " ,vname " not auto-saved")
                             "Auto-save file")))
+            ((and (autosave-journal? name)
+                  (not (buffer-journal-append name aname (url-glue aname "j"))))
+             (buffer-pretend-autosaved name))
             ((buffer-export name aname fm)
              (when (not (rescue-mode?))
                (set-message `(concat "Failed to auto-save " ,vname)
@@ -489,6 +497,8 @@
             (else
              (when (not (rescue-mode?))
                (buffer-pretend-autosaved name)
+               (when (autosave-journal? name)
+                 (buffer-journal-reset name aname (url-glue aname "j")))
                (set-temporary-message `(concat "Auto-saved " ,vname)
                                       "Auto-save file" 2500)))))))
 
@@ -520,7 +530,8 @@
       (autosave-delayed)))
 
 (define-preferences
-  ("autosave" "120" notify-autosave))
+  ("autosave" "120" notify-autosave)
+  ("autosave journal" "on" noop))
 
 ;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
 ;; Opening files using external tools
@@ -619,7 +630,9 @@
             (if answ
                 (let* ((autosave-name (autosave-propose name))
                        (format (url-format name))
-                       (doc (tree-import autosave-name format)))
+                       (doc (buffer-journal-replay
+                             (tree-import autosave-name format)
+                             autosave-name (url-glue autosave-name "j"))))
                   (buffer-set name doc)
                   (load-buffer-open name opts)
                   (buffer-pretend-modified name))
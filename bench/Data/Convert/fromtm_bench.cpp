@@ -0,0 +1,62 @@
+
+/******************************************************************************
+ * MODULE     : fromtm_bench.cpp
+ * DESCRIPTION: Throughput of the reader for the TeXmacs file format
+ * COPYRIGHT  : (C) 2026 Darcy Shen
+ *******************************************************************************
+ * This software falls under the GNU general public license version 3 or later.
+ * It comes WITHOUT ANY WARRANTY WHATSOEVER. For details, see the file LICENSE
+ * in the root directory or <http://www.gnu.org/licenses/gpl-3.0.html>.
+ ******************************************************************************/
+
+#include <QtTest/QtTest>
+
+#include "base.hpp"
+#include "convert.hpp"
+#include "file.hpp"
+#include "tree_helper.hpp"
+
+class BenchFromTm : public QObject {
+  Q_OBJECT
+
+private:
+  string doc;
+
+private slots:
+  void initTestCase ();
+  void bench_texmacs_to_tree ();
+  void bench_texmacs_document_to_tree ();
+};
+
+void
+BenchFromTm::initTestCase () {
+  init_lolly ();
+  string body;
+  url    u= url_system ("$TEXMACS_PATH/tests/tm/41_7.tm");
+  QVERIFY (!load_string (u, body, false));
+  QVERIFY (N (body) > 0);
+  // Build a multi-megabyte document out of the same body
+  doc= "<TeXmacs|2.1.4>\n\n<style|generic>\n\n<\\body>\n";
+  while (N (doc) < 8 * 1024 * 1024)
+    doc << body << "\n\n";
+  doc << "</body>\n";
+}
+
+void
+BenchFromTm::bench_texmacs_to_tree () {
+  QBENCHMARK {
+    tree t= texmacs_to_tree (doc);
+    QVERIFY (N (t) > 0);
+  }
+}
+
+void
+BenchFromTm::bench_texmacs_document_to_tree () {
+  QBENCHMARK {
+    tree t= texmacs_document_to_tree (doc);
+    QVERIFY (is_document (t));
+  }
+}
+
+QTEST_MAIN (BenchFromTm)
+#include "fromtm_bench.moc"
@@ -0,0 +1,77 @@
+/******************************************************************************
+ * MODULE     : ip_observer_bench.cpp
+ * DESCRIPTION: Cost of maintaining inverse paths under structural edits
+ * COPYRIGHT  : (C) 2026 Darcy Shen
+ *******************************************************************************
+ * This software falls under the GNU general public license version 3 or later.
+ * It comes WITHOUT ANY WARRANTY WHATSOEVER. For details, see the file LICENSE
+ * in the root directory or <http://www.gnu.org/licenses/gpl-3.0.html>.
+ ******************************************************************************/
+
+#include <QtTest/QtTest>
+
+#include "base.hpp"
+#include "modification.hpp"
+#include "observers.hpp"
+#include "tree_helper.hpp"
+#include "tree_observer.hpp"
+
+using namespace moebius;
+
+extern tree the_et;
+
+class BenchIpObserver : public QObject {
+  Q_OBJECT
+
+private:
+  void check_ips (tree& doc);
+
+private slots:
+  void initTestCase ();
+  void bench_insert_front ();
+  void bench_remove_front ();
+};
+
+void
+BenchIpObserver::check_ips (tree& doc) {
+  path ip= obtain_ip (doc);
+  for (int i= 0; i < N (doc); i+= 997) {
+    QVERIFY (obtain_ip (doc[i]) == path (i, ip));
+    QVERIFY (obtain_ip (doc[i][1]) == path (1, path (i, ip)));
+  }
+}
+
+void
+BenchIpObserver::initTestCase () {
+  init_lolly ();
+  the_et      = tuple ();
+  the_et->data= ip_observer (path ());
+  // A document with 10000 paragraphs
+  tree doc (DOCUMENT);
+  for (int i= 0; i < 10000; i++)
+    doc << tree (CONCAT, "Paragraph ", tree (WITH, "font-series", "bold", "x"),
+                 as_string (i));
+  insert (the_et, 0, tuple (doc));
+  check_ips (the_et[0]);
+}
+
+void
+BenchIpObserver::bench_insert_front () {
+  QBENCHMARK {
+    for (int i= 0; i < 100; i++)
+      insert (the_et[0], 0, tree (DOCUMENT, tree (CONCAT, "new", "text")));
+  }
+  check_ips (the_et[0]);
+}
+
+void
+BenchIpObserver::bench_remove_front () {
+  QBENCHMARK {
+    for (int i= 0; i < 100; i++)
+      if (N (the_et[0]) > 10000) remove (the_et[0], 0, 1);
+  }
+  check_ips (the_et[0]);
+}
+
+QTEST_MAIN (BenchIpObserver)
+#include "ip_observer_bench.moc"
@@ -0,0 +1,78 @@
+/******************************************************************************
+ * MODULE     : converter_bench.cpp
+ * DESCRIPTION: Throughput of the conversions between Cork and UTF-8
+ * COPYRIGHT  : (C) 2026 Darcy Shen
+ *******************************************************************************
+ * This software falls under the GNU general public license version 3 or later.
+ * It comes WITHOUT ANY WARRANTY WHATSOEVER. For details, see the file LICENSE
+ * in the root directory or <http://www.gnu.org/licenses/gpl-3.0.html>.
+ ******************************************************************************/
+
+#include <QtTest/QtTest>
+
+#include "analyze.hpp"
+#include "base.hpp"
+#include "converter.hpp"
+#include "file.hpp"
+
+class BenchConverter : public QObject {
+  Q_OBJECT
+
+private:
+  string plain_cork, plain_utf8; // long runs of unchanged characters
+  string dense_cork, dense_utf8; // escapes every few characters
+
+private slots:
+  void initTestCase ();
+  void bench_cork_to_utf8_plain ();
+  void bench_cork_to_utf8_dense ();
+  void bench_utf8_to_cork_plain ();
+  void bench_utf8_to_cork_dense ();
+};
+
+void
+BenchConverter::initTestCase () {
+  init_lolly ();
+  string body;
+  url    u= url_system ("$TEXMACS_PATH/tests/tm/41_7.tm");
+  QVERIFY (!load_string (u, body, false));
+  QVERIFY (N (body) > 0);
+  // The letters, digits and spaces of a document, which both conversions
+  // leave unchanged
+  string text;
+  for (int i= 0; i < N (body); i++)
+    if (is_alpha (body[i]) || is_digit (body[i]) || body[i] == ' ')
+      text << body[i];
+  while (N (plain_cork) < 4 * 1024 * 1024)
+    plain_cork << text << " ";
+  // Accents, symbols, unicode characters and quotes between short words
+  while (N (dense_cork) < 4 * 1024 * 1024)
+    dense_cork << "\xe9t\xe9 <alpha>+<beta> <#4E2D>\x10q\x11 na\xefve ";
+  plain_utf8= cork_to_utf8 (plain_cork);
+  dense_utf8= cork_to_utf8 (dense_cork);
+  QVERIFY (plain_utf8 == plain_cork);
+  QVERIFY (cork_to_utf8 (utf8_to_cork (dense_utf8)) == dense_utf8);
+}
+
+void
+BenchConverter::bench_cork_to_utf8_plain () {
+  QBENCHMARK { QVERIFY (N (cork_to_utf8 (plain_cork)) > 0); }
+}
+
+void
+BenchConverter::bench_cork_to_utf8_dense () {
+  QBENCHMARK { QVERIFY (N (cork_to_utf8 (dense_cork)) > 0); }
+}
+
+void
+BenchConverter::bench_utf8_to_cork_plain () {
+  QBENCHMARK { QVERIFY (N (utf8_to_cork (plain_utf8)) > 0); }
+}
+
+void
+BenchConverter::bench_utf8_to_cork_dense () {
+  QBENCHMARK { QVERIFY (N (utf8_to_cork (dense_utf8)) > 0); }
+}
+
+QTEST_MAIN (BenchConverter)
+#include "converter_bench.moc"
@@ -0,0 +1,67 @@
+/******************************************************************************
+ * MODULE     : raster_bench.cpp
+ * DESCRIPTION: Speed of blurring, thickening and eroding raster pictures
+ * COPYRIGHT  : (C) 2026 Darcy Shen
+ *******************************************************************************
+ * This software falls under the GNU general public license version 3 or later.
+ * It comes WITHOUT ANY WARRANTY WHATSOEVER. For details, see the file LICENSE
+ * in the root directory or <http://www.gnu.org/licenses/gpl-3.0.html>.
+ ******************************************************************************/
+
+#include <QtTest/QtTest>
+
+#include "base.hpp"
+#include "raster.hpp"
+#include "true_color.hpp"
+
+class BenchRaster : public QObject {
+  Q_OBJECT
+
+private:
+  raster<true_color> ras;
+
+private slots:
+  void initTestCase ();
+  void bench_gaussian_blur ();
+  void bench_oval_thicken ();
+  void bench_oval_erode ();
+  void bench_magnify ();
+};
+
+void
+BenchRaster::initTestCase () {
+  init_lolly ();
+  // Opaque disks on a transparent background, as for shadowed text
+  int w= 600, h= 400;
+  ras  = raster<true_color> (w, h, 0, 0);
+  for (int y= 0; y < h; y++)
+    for (int x= 0; x < w; x++) {
+      int    dx= (x % 50) - 25, dy= (y % 50) - 25;
+      double a = (dx * dx + dy * dy < 300 ? 1.0 : 0.0);
+      ras->a[y * w + x]= true_color (x / (double) w, y / (double) h, 0.5, a);
+    }
+}
+
+void
+BenchRaster::bench_gaussian_blur () {
+  QBENCHMARK { QVERIFY (gaussian_blur (ras, 4.0)->w > 0); }
+}
+
+void
+BenchRaster::bench_oval_thicken () {
+  QBENCHMARK { QVERIFY (oval_thicken (ras, 8.0, 8.0, 0.0)->w > 0); }
+}
+
+void
+BenchRaster::bench_oval_erode () {
+  raster<double> pen= oval_pen<double> (6.5, 6.5, 0.0);
+  QBENCHMARK { QVERIFY (erode (ras, pen)->w > 0); }
+}
+
+void
+BenchRaster::bench_magnify () {
+  QBENCHMARK { QVERIFY (magnify (ras, 2.5, 2.5)->w > 0); }
+}
+
+QTEST_MAIN (BenchRaster)
+#include "raster_bench.moc"
@@ -0,0 +1,113 @@
+/******************************************************************************
+ * MODULE     : database_bench.cpp
+ * DESCRIPTION: Loading and querying a bibliographic database
+ * COPYRIGHT  : (C) 2026 Darcy Shen
+ *******************************************************************************
+ * This software falls under the GNU general public license version 3 or later.
+ * It comes WITHOUT ANY WARRANTY WHATSOEVER. For details, see the file LICENSE
+ * in the root directory or <http://www.gnu.org/licenses/gpl-3.0.html>.
+ ******************************************************************************/
+
+#include <QtTest/QtTest>
+
+#include "Database/database.hpp"
+#include "analyze.hpp"
+#include "base.hpp"
+#include "file.hpp"
+#include "tree_helper.hpp"
+
+using namespace moebius;
+
+class BenchDatabase : public QObject {
+  Q_OBJECT
+
+private:
+  url u;
+
+private slots:
+  void initTestCase ();
+  void bench_import ();
+  void bench_load ();
+  void bench_completes ();
+  void bench_contains_ordered ();
+  void cleanupTestCase ();
+};
+
+static string
+quote (string s) {
+  return "\"" * s * "\"";
+}
+
+static void
+fill_database (url u) {
+  // 50000 entries with seven fields each
+  const char* names[]= {"Knuth",  "Hoeven", "Lecerf",  "Shen",  "Turing",
+                        "Church", "Godel",  "Hilbert", "Euler", "Gauss"};
+  database    db (u);
+  db->history= false;
+  for (int i= 0; i < 50000; i++) {
+    string a= names[i % 10], b= names[(i * 7) % 10];
+    tree   e (TUPLE);
+    e << tuple (quote ("type"), quote (i % 3 == 0 ? "book" : "article"))
+      << tuple (quote ("name"), quote (locase_all (a) * as_string (i)))
+      << tuple (quote ("author"), quote ("Donald " * a), quote ("Joris " * b))
+      << tuple (quote ("title"), quote ("On the theory of item " *
+                                        as_string (i % 997) * " and " * b))
+      << tuple (quote ("year"), quote (as_string (1900 + i % 120)))
+      << tuple (quote ("journal"), quote ("Journal " * as_string (i % 50)))
+      << tuple (quote ("pages"), quote (as_string (i % 300) * "--" *
+                                        as_string (i % 300 + 10)));
+    db->set_entry ("id" * as_string (i), e, 1000 + i);
+  }
+}
+
+void
+BenchDatabase::initTestCase () {
+  init_lolly ();
+  u= url_temp (".tmdb");
+  fill_database (u);
+}
+
+void
+BenchDatabase::bench_import () {
+  QBENCHMARK {
+    url v= url_temp (".tmdb");
+    fill_database (v);
+    remove (v);
+  }
+}
+
+void
+BenchDatabase::bench_load () {
+  QBENCHMARK {
+    database db (u);
+    QVERIFY (db->load ());
+    QVERIFY (N (db->id_lines) == 50000);
+  }
+}
+
+void
+BenchDatabase::bench_completes () {
+  database db (u);
+  QVERIFY (db->load ());
+  tree q= tuple (tuple ("completes", quote ("knu")),
+                 tuple (quote ("type"), quote ("book")));
+  QBENCHMARK { QVERIFY (N (db->query (q, 1.0e9, 20)) == 20); }
+}
+
+void
+BenchDatabase::bench_contains_ordered () {
+  database db (u);
+  QVERIFY (db->load ());
+  tree q= tuple (tuple ("contains", quote ("item 42")),
+                 tuple ("order", quote ("year"), "#t"));
+  QBENCHMARK { QVERIFY (N (db->query (q, 1.0e9, 1000000)) > 0); }
+}
+
+void
+BenchDatabase::cleanupTestCase () {
+  remove (u);
+}
+
+QTEST_MAIN (BenchDatabase)
+#include "database_bench.moc"
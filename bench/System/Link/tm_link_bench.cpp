@@ -0,0 +1,184 @@
+/******************************************************************************
+ * MODULE     : tm_link_bench.cpp
+ * DESCRIPTION: Throughput of the output of links with plugins
+ * COPYRIGHT  : (C) 2026 Darcy Shen
+ *******************************************************************************
+ * This software falls under the GNU general public license version 3 or later.
+ * It comes WITHOUT ANY WARRANTY WHATSOEVER. For details, see the file LICENSE
+ * in the root directory or <http://www.gnu.org/licenses/gpl-3.0.html>.
+ ******************************************************************************/
+
+#include <QtTest/QtTest>
+
+#include "Generic/input.hpp"
+#include "base.hpp"
+#include "file.hpp"
+#include "tm_link.hpp"
+#include "tree_helper.hpp"
+
+using namespace moebius;
+
+/******************************************************************************
+ * A link which replays recorded plugin output by chunks
+ ******************************************************************************/
+
+struct replay_link_rep : tm_link_rep {
+  string data;   // recorded output
+  int    pos;    // amount of output which has already been delivered
+  string outbuf; // pending output
+
+  replay_link_rep (string data2) : data (data2), pos (0) { alive= true; }
+  string  start () { return "ok"; }
+  void    write (string s, int channel) {
+    (void) s;
+    (void) channel;
+  }
+  string& watch (int channel) {
+    static string empty_string= "";
+    return channel == LINK_OUT ? outbuf : empty_string;
+  }
+  string read (int channel) {
+    string r= watch (channel);
+    watch (channel)= "";
+    return r;
+  }
+  void listen (int msecs) {
+    (void) msecs;
+    int end= min (pos + LINK_MAX_CHUNK, N (data));
+    outbuf << data (pos, end);
+    pos= end;
+  }
+  void interrupt () {}
+  void stop () {}
+};
+
+/******************************************************************************
+ * Reading the output of plugins
+ ******************************************************************************/
+
+static int
+read_packets (tm_link ln, int max) {
+  int count= 0;
+  while (count < max) {
+    bool   success;
+    string s= ln->read_packet (LINK_OUT, 1000, success);
+    if (!success || N (s) == 0 || s[0] != DATA_BEGIN) break;
+    count++;
+  }
+  return count;
+}
+
+static tree
+put_output (string out, bool by_runs) {
+  // Pipe plugins such as Python or Maxima do not send packets: their
+  // output is put into the input of the session as it arrives
+  texmacs_input in ("output");
+  tree          doc (DOCUMENT);
+  for (int pos= 0; pos < N (out); pos+= LINK_MAX_CHUNK) {
+    string s= out (pos, min (pos + LINK_MAX_CHUNK, N (out)));
+    int    i= 0, n= N (s);
+    while (i < n)
+      if (by_runs ? in->put (s, i) : in->put (s[i++])) {
+        tree t= in->get ("output");
+        if (is_document (t)) doc << A (t);
+      }
+  }
+  return doc;
+}
+
+/******************************************************************************
+ * The benchmarks
+ ******************************************************************************/
+
+class BenchTmLink : public QObject {
+  Q_OBJECT
+
+private:
+  string stream;      // packets, as sent over sockets
+  int    packets;     // number of packets in the stream
+  string session;     // output of a pipe plugin in a session
+  tree   session_doc; // its trees, as put by characters
+
+private slots:
+  void initTestCase ();
+  void bench_replayed_output ();
+  void bench_pipe_output ();
+  void bench_session_by_characters ();
+  void bench_session_by_runs ();
+};
+
+void
+BenchTmLink::initTestCase () {
+  init_lolly ();
+  // Many small packets interleaved with some large ones
+  unsigned int seed= 12345;
+  packets          = 0;
+  while (N (stream) < 32 * 1024 * 1024) {
+    seed       = seed * 1103515245 + 12345;
+    int    len = (packets % 64 == 0 ? 1 << 18 : 16 + (seed >> 16) % 256);
+    string body= string ('x', len);
+    string p   = string (DATA_BEGIN) * "verbatim:" * body * string (DATA_END);
+    stream << as_string (N (p)) << "\n" << p;
+    packets++;
+  }
+  // Blocks of long verbatim lines and of large scheme trees, each
+  // followed by a prompt
+  while (N (session) < 32 * 1024 * 1024) {
+    session << DATA_BEGIN << "verbatim:";
+    for (int i= 0; i < 64; i++)
+      session << string ('x', 1000) << "\n";
+    session << DATA_BEGIN << "scheme:(document \"" << string ('y', 64000)
+            << "\")" << DATA_END;
+    session << DATA_BEGIN << "prompt#>>> " << DATA_END << DATA_END;
+  }
+}
+
+void
+BenchTmLink::bench_replayed_output () {
+  QBENCHMARK {
+    tm_link ln= tm_new<replay_link_rep> (stream);
+    QCOMPARE (read_packets (ln, packets), packets);
+  }
+}
+
+void
+BenchTmLink::bench_pipe_output () {
+#if defined(OS_MINGW) || defined(OS_WIN)
+  QSKIP ("no cat command to echo the output");
+#else
+  // Pipes are read by chunks as their output arrives, rather than by
+  // packets; the plugin keeps echoing the stream, which is read once for
+  // each run of the benchmark
+  url u= url_temp (".out");
+  QVERIFY (!save_string (u, stream));
+  string  cmd= "while cat \"" * as_string (u) * "\"; do :; done";
+  tm_link ln = make_pipe_link (cmd);
+  QVERIFY (ln->start () == "ok");
+  int pending= 0;
+  QBENCHMARK {
+    while (pending < N (stream) && ln->alive) {
+      ln->listen (1000);
+      pending+= N (ln->read (LINK_OUT));
+    }
+    QVERIFY (pending >= N (stream));
+    pending-= N (stream);
+  }
+  ln->stop ();
+  remove (u);
+#endif
+}
+
+void
+BenchTmLink::bench_session_by_characters () {
+  QBENCHMARK { session_doc= put_output (session, false); }
+}
+
+void
+BenchTmLink::bench_session_by_runs () {
+  tree doc;
+  QBENCHMARK { doc= put_output (session, true); }
+  QVERIFY (doc == session_doc);
+}
+
+QTEST_MAIN (BenchTmLink)
+#include "tm_link_bench.moc"
@@ -0,0 +1,107 @@
+/******************************************************************************
+ * MODULE     : env_bench.cpp
+ * DESCRIPTION: Speed of retrieving typed environment variables
+ * COPYRIGHT  : (C) 2026 Darcy Shen
+ *******************************************************************************
+ * This software falls under the GNU general public license version 3 or later.
+ * It comes WITHOUT ANY WARRANTY WHATSOEVER. For details, see the file LICENSE
+ * in the root directory or <http://www.gnu.org/licenses/gpl-3.0.html>.
+ ******************************************************************************/
+
+#include <QtTest/QtTest>
+
+#include "Metafont/load_tex.hpp"
+#include "base.hpp"
+#include "data_cache.hpp"
+#include "env.hpp"
+#include "tm_sys_utils.hpp"
+#include <moebius/drd/drd_std.hpp>
+
+using namespace moebius;
+using moebius::drd::std_drd;
+
+class BenchEnv : public QObject {
+  Q_OBJECT
+
+private slots:
+  void initTestCase ();
+  void bench_get_length ();
+  void bench_get_number ();
+  void bench_get_color ();
+  void bench_exec_with ();
+  void bench_switch_fonts ();
+};
+
+static edit_env
+default_env () {
+  // environments keep references to their drd and to the tables of labels
+  static drd_info              drd ("none", std_drd);
+  static hashmap<string, tree> h1 (UNINIT), h2 (UNINIT);
+  static hashmap<string, tree> h3 (UNINIT), h4 (UNINIT);
+  static hashmap<string, tree> h5 (UNINIT), h6 (UNINIT);
+  edit_env                     env (drd, "none", h1, h2, h3, h4, h5, h6);
+  env->read_only= false;
+  return env;
+}
+
+void
+BenchEnv::initTestCase () {
+  init_lolly ();
+  init_texmacs_home_path ();
+  cache_initialize ();
+  init_tex ();
+  moebius::drd::init_std_drd ();
+}
+
+void
+BenchEnv::bench_get_length () {
+  edit_env env= default_env ();
+  QBENCHMARK {
+    SI w= env->get_length (PAR_WIDTH) + env->get_length (PAR_SEP) +
+          env->get_length (PAR_LINE_SEP) + env->get_length (PAR_VER_SEP);
+    QVERIFY (w != 1);
+  }
+}
+
+void
+BenchEnv::bench_get_number () {
+  edit_env env= default_env ();
+  QBENCHMARK {
+    double r= env->get_int (DPI) + env->get_int (MATH_LEVEL) +
+              env->get_double (FONT_BASE_SIZE) +
+              env->get_double (MAGNIFICATION);
+    QVERIFY (r > 0);
+  }
+}
+
+void
+BenchEnv::bench_get_color () {
+  edit_env env= default_env ();
+  QBENCHMARK {
+    color c= env->get_color (COLOR) ^ env->get_color (SELECTION_COLOR) ^
+             env->get_color (MATCH_COLOR);
+    QVERIFY (c != 1);
+  }
+}
+
+void
+BenchEnv::bench_exec_with () {
+  edit_env env= default_env ();
+  tree     t (WITH, FONT_SIZE, "1.2", PAR_FIRST, "2fn",
+              tree (WITH, COLOR, "dark blue", PAR_SEP, "0.5fn", "text"));
+  QBENCHMARK { QVERIFY (env->exec (t) != UNINIT); }
+}
+
+void
+BenchEnv::bench_switch_fonts () {
+  // each with changes the font twice: on entering and on leaving
+  // (in text mode, since the language of math mode is defined in scheme)
+  edit_env env= default_env ();
+  tree     t (WITH, FONT_SERIES, "bold",
+              tree (WITH, FONT_SHAPE, "italic",
+                    tree (WITH, FONT_SIZE, "0.7", "x")));
+  QBENCHMARK { QVERIFY (env->exec (t) != UNINIT); }
+}
+
+QTEST_MAIN (BenchEnv)
+#include "env_bench.moc"
@@ -0,0 +1,115 @@
+
+/******************************************************************************
+ * MODULE     : line_breaker_bench.cpp
+ * DESCRIPTION: Speed of the line breaker on long paragraphs
+ * COPYRIGHT  : (C) 2026 Darcy Shen
+ *******************************************************************************
+ * This software falls under the GNU general public license version 3 or later.
+ * It comes WITHOUT ANY WARRANTY WHATSOEVER. For details, see the file LICENSE
+ * in the root directory or <http://www.gnu.org/licenses/gpl-3.0.html>.
+ ******************************************************************************/
+
+#include <QtTest/QtTest>
+
+#include "Boxes/construct.hpp"
+#include "Format/line_item.hpp"
+#include "Metafont/load_tex.hpp"
+#include "base.hpp"
+#include "colors.hpp"
+#include "data_cache.hpp"
+#include "file.hpp"
+#include "font.hpp"
+#include "tm_sys_utils.hpp"
+
+array<path> line_breaks (array<line_item> a, int start, int end, SI line_width,
+                         SI large_width, SI first_spc, SI last_spc,
+                         bool ragged);
+
+class BenchLineBreaker : public QObject {
+  Q_OBJECT
+
+private:
+  font     fn;
+  language lan;
+  pencil   pen;
+  SI       line_width;
+
+  array<line_item> make_items (array<string> words);
+
+private slots:
+  void initTestCase ();
+  void bench_synthetic_paragraph ();
+  void bench_real_paragraph ();
+};
+
+array<line_item>
+BenchLineBreaker::make_items (array<string> words) {
+  array<line_item> a;
+  for (int i= 0; i < N (words); i++) {
+    path      ip= decorate ();
+    line_item item (STRING_ITEM, OP_TEXT, text_box (ip, 0, words[i], fn, pen),
+                    0, lan);
+    item->spc= fn->spc;
+    a << item;
+  }
+  return a;
+}
+
+void
+BenchLineBreaker::initTestCase () {
+  init_lolly ();
+  init_texmacs_home_path ();
+  cache_initialize ();
+  init_tex ();
+  fn        = smart_font ("roman", "rm", "medium", "right", 10, 600);
+  lan       = text_language ("english");
+  pen       = pencil (black);
+  line_width= 400 * fn->wquad / 30;
+}
+
+void
+BenchLineBreaker::bench_synthetic_paragraph () {
+  array<string> words;
+  unsigned int  seed= 12345;
+  for (int i= 0; i < 5000; i++) {
+    seed    = seed * 1103515245 + 12345;
+    int    n= 1 + (seed >> 16) % 12;
+    string w;
+    for (int j= 0; j < n; j++) {
+      seed= seed * 1103515245 + 12345;
+      w << (char) ('a' + (seed >> 16) % 26);
+    }
+    words << w;
+  }
+  array<line_item> a= make_items (words);
+  QBENCHMARK {
+    array<path> ap=
+        line_breaks (a, 0, N (a), line_width, line_width, 0, 0, false);
+    QVERIFY (N (ap) > 2);
+  }
+}
+
+void
+BenchLineBreaker::bench_real_paragraph () {
+  string s;
+  url    u= url_system ("$TEXMACS_PATH/tests/tm/41_7.tm");
+  QVERIFY (!load_string (u, s, false));
+  array<string> words;
+  string        w;
+  for (int i= 0; i < N (s) && N (words) < 5000; i++)
+    if (is_alpha (s[i])) w << s[i];
+    else if (N (w) > 0) {
+      words << w;
+      w= "";
+    }
+  QVERIFY (N (words) > 100);
+  array<line_item> a= make_items (words);
+  QBENCHMARK {
+    array<path> ap=
+        line_breaks (a, 0, N (a), line_width, line_width, 0, 0, false);
+    QVERIFY (N (ap) > 2);
+  }
+}
+
+QTEST_MAIN (BenchLineBreaker)
+#include "line_breaker_bench.moc"
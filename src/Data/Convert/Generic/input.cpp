@@ -166,6 +166,25 @@ texmacs_input_rep::put (char c) { // returns true when expecting input
   return block_done;
 }
 
+bool
+texmacs_input_rep::put (string s, int& i) {
+  // puts s[i] or, in normal status, the longest run of characters from i on
+  // which neither change the status nor end a line or a tag, so that the
+  // run cannot end a block or make the buffer ready for flushing
+  int start= i, n= N (s);
+  if (status == STATUS_NORMAL)
+    while (i < n) {
+      char c= s[i];
+      if (c == DATA_ESCAPE || c == DATA_BEGIN || c == DATA_END ||
+          c == DATA_ABORT || c == '\n' || c == '>')
+        break;
+      i++;
+    }
+  if (i == start) return put (s[i++]);
+  buf << s (start, i);
+  return false;
+}
+
 void
 texmacs_input_rep::bof () {
   format        = "verbatim";
@@ -221,6 +221,8 @@ static void
 flush (tree& D, tree& C, string& S, bool& spc_flag, bool& ret_flag) {
   if (spc_flag) S << " ";
   if (S != "") {
+    // short atoms recur throughout documents, so share them
+    if (N (S) <= STRING_INLINE) S= intern (S);
     if ((N (C) == 0) || (!is_atomic (C[N (C) - 1]))) C << S;
     else C[N (C) - 1]->label << S;
     S       = "";
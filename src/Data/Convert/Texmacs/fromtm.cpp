@@ -21,7 +21,6 @@
 #include <moebius/vars.hpp>
 
 using lolly::data::decode_from_utf8;
-using lolly::data::from_hex;
 using lolly::data::to_Hex;
 using moebius::drd::STD_CODE;
 
@@ -31,57 +30,95 @@ using namespace moebius;
  * Conversion of TeXmacs strings of the present format to TeXmacs trees
  ******************************************************************************/
 
+// Structural tokens are shared instead of being reallocated for every read
+static string tm_empty_token ("");
+static string tm_space_token (" ");
+static string tm_return_token ("\n");
+static string tm_open_token ("<");
+static string tm_raw_token ("<#");
+static string tm_open_arg_token ("<\\");
+static string tm_close_arg_token ("<|");
+static string tm_close_token ("</");
+static string tm_bar_token ("|");
+static string tm_end_token (">");
+
 struct tm_reader {
   string               version; // document was composed using this version
   hashmap<string, int> codes;   // codes for to present version
-  tree_label EXPAND_APPLY;      // APPLY (version < 0.3.3.22) or EXPAND (otherw)
-  bool       backslash_ok;      // true for versions >= 1.0.1.23
-  bool       with_extensions;   // true for versions >= 1.0.2.4
-  string     buf;               // the string being read from
-  int        pos;               // the current position of the reader
-  string     last;              // last read string
+  tree_label  EXPAND_APPLY;     // APPLY (version < 0.3.3.22) or EXPAND (otherw)
+  bool        backslash_ok;     // true for versions >= 1.0.1.23
+  bool        with_extensions;  // true for versions >= 1.0.2.4
+  string      buf;              // the string being read from
+  const char* a;                // the characters of buf
+  int         n;                // the length of buf
+  int         pos;              // the current position of the reader
+  string      last;             // last read string
 
   tm_reader (string buf2)
       : version (TEXMACS_VERSION), codes (STD_CODE), EXPAND_APPLY (EXPAND),
-        backslash_ok (true), with_extensions (true), buf (buf2), pos (0),
-        last ("") {}
+        backslash_ok (true), with_extensions (true), buf (buf2),
+        a (buf.begin ()), n (N (buf)), pos (0), last ("") {}
   tm_reader (string buf2, string version2)
       : version (version2), codes (get_codes (version)),
         EXPAND_APPLY (version_inf (version, "0.3.3.22") ? APPLY : EXPAND),
         backslash_ok (version_inf (version, "1.0.1.23") ? false : true),
         with_extensions (version_inf (version, "1.0.2.4") ? false : true),
-        buf (buf2), pos (0), last ("") {}
+        buf (buf2), a (buf.begin ()), n (N (buf)), pos (0), last ("") {}
 
   int    skip_blank ();
+  void   skip_continuations ();
+  void   append (string& r, int start, int end);
   string decode (string s);
-  string read_char ();
+  int    read_char ();
+  string read_text ();
   string read_next ();
   string read_function_name ();
+  tree   read_tag (string name);
   tree   read_apply (string s, bool skip_flag);
   tree   read (bool skip_flag);
 };
 
 int
 tm_reader::skip_blank () {
-  int n= 0;
-  for (; pos < N (buf); pos++) {
-    if (buf[pos] == ' ') continue;
-    if (buf[pos] == '\t') continue;
-    if (buf[pos] == '\r') continue;
-    if (buf[pos] == '\n') {
-      n++;
+  int k= 0;
+  for (; pos < n; pos++) {
+    if (a[pos] == ' ') continue;
+    if (a[pos] == '\t') continue;
+    if (a[pos] == '\r') continue;
+    if (a[pos] == '\n') {
+      k++;
       continue;
     }
     break;
   }
-  return n;
+  return k;
+}
+
+void
+tm_reader::skip_continuations () {
+  while (((pos + 1) < n) && (a[pos] == '\\') && (a[pos + 1] == '\n')) {
+    pos+= 2;
+    while ((pos < n) && ((a[pos] == ' ') || (a[pos] == '\t')))
+      pos++;
+  }
+}
+
+void
+tm_reader::append (string& r, int start, int end) {
+  if (end <= start) return;
+  if (N (r) == 0) r= buf (start, end);
+  else r << buf (start, end);
 }
 
 string
 tm_reader::decode (string s) {
-  int    i, n= N (s);
-  string r;
+  int i, n= N (s);
   for (i= 0; i < n; i++)
+    if (s[i] == '\\') break;
+  if (i == n) return s;
+
+  string r= s (0, i);
+  for (; i < n; i++)
     if (((i + 1) < n) && (s[i] == '\\')) {
       i++;
       if (s[i] == ';')
@@ -98,79 +135,86 @@ tm_reader::decode (string s) {
   return r;
 }
 
-string
+int
 tm_reader::read_char () {
-  while (((pos + 1) < N (buf)) && (buf[pos] == '\\') &&
-         (buf[pos + 1] == '\n')) {
-    pos+= 2;
-    skip_spaces (buf, pos);
+  skip_continuations ();
+  if (pos >= n) return -1;
+  return (unsigned char) a[pos++];
+}
+
+string
+tm_reader::read_text () {
+  // Text runs are copied out of buf as whole spans; only escapes and
+  // line continuations interrupt the current span
+  string r;
+  int    start= pos;
+  while (true) {
+    int old_pos= pos;
+    skip_continuations ();
+    if (pos != old_pos) {
+      append (r, start, old_pos);
+      start= pos;
+    }
+    if (pos >= n) {
+      append (r, start, pos);
+      return r;
+    }
+    char c= a[pos];
+    if (c == '\\') {
+      pos++;
+      if ((pos < n) && (a[pos] == '\\') && backslash_ok) pos++;
+      else {
+        int mid= pos;
+        skip_continuations ();
+        if (pos != mid) {
+          append (r, start, mid);
+          start= pos;
+        }
+        if (pos < n) pos++;
+      }
+    }
+    else if ((c == '\t') || (c == '\r') || (c == '\n') || (c == ' ') ||
+             (c == '<') || (c == '|') || (c == '>')) {
+      append (r, start, pos);
+      pos= old_pos;
+      return r;
+    }
+    else pos++;
   }
-  if (pos >= N (buf)) return "";
-  pos++;
-  return buf (pos - 1, pos);
 }
 
 string
 tm_reader::read_next () {
-  int    old_pos= pos;
-  string c      = read_char ();
-  if (c == "") return c;
-  switch (c[0]) {
+  int old_pos= pos;
+  int c      = read_char ();
+  if (c < 0) return tm_empty_token;
+  switch (c) {
   case '\t':
   case '\n':
   case '\r':
   case ' ':
     pos--;
-    if (skip_blank () <= 1) return " ";
-    else return "\n";
+    if (skip_blank () <= 1) return tm_space_token;
+    else return tm_return_token;
   case '<': {
     old_pos= pos;
     c      = read_char ();
-    if (c == "") return "";
-    if (c == "#") return "<#";
-    if ((c == "\\") || (c == "|") || (c == "/")) return "<" * c;
-    if (is_iso_alpha (c[0]) || (c == ">")) {
-      pos= old_pos;
-      return "<";
-    }
-    pos= old_pos;
-    return "<";
-    /*
-    string d= read_char ();
-    if ((d == "\\") || (d == "|") || (d == "/")) return "<" * c * d;
+    if (c < 0) return tm_empty_token;
+    if (c == '#') return tm_raw_token;
+    if (c == '\\') return tm_open_arg_token;
+    if (c == '|') return tm_close_arg_token;
+    if (c == '/') return tm_close_token;
     pos= old_pos;
-    return "<" * c;
-    */
+    return tm_open_token;
   }
   case '|':
+    return tm_bar_token;
   case '>':
-    return c;
+    return tm_end_token;
   }
 
-  string r;
   pos= old_pos;
-  while (true) {
-    old_pos= pos;
-    c      = read_char ();
-    if (c == "") return r;
-    else if (c == "\\") {
-      if ((pos < N (buf)) && (buf[pos] == '\\') && backslash_ok) {
-        r << c << "\\";
-        pos++;
-      }
-      else r << c << read_char ();
-    }
-    else if (c == "\t") break;
-    else if (c == "\r") break;
-    else if (c == "\n") break;
-    else if (c == " ") break;
-    else if (c == "<") break;
-    else if (c == "|") break;
-    else if (c == ">") break;
-    else r << c;
-  }
-  pos= old_pos;
-  return r;
+  return read_text ();
 }
 
 string
@@ -196,18 +240,23 @@ get_collection (tree& u, tree t) {
 }
 
 tree
-tm_reader::read_apply (string name, bool skip_flag) {
-  // cout << "Read apply " << name << INDENT << LF;
-  tree t (make_tree_label (name));
-  if (!with_extensions) t= tree (EXPAND_APPLY, name);
+tm_reader::read_tag (string name) {
   if (codes->contains (name)) {
     // cout << "  " << name << " -> " << as_string ((tree_label) codes [name])
     // << "\n";
-    t= tree ((tree_label) codes[name]);
+    return tree ((tree_label) codes[name]);
   }
+  if (!with_extensions) return tree (EXPAND_APPLY, name);
+  return tree (make_tree_label (name));
+}
+
+tree
+tm_reader::read_apply (string name, bool skip_flag) {
+  // cout << "Read apply " << name << INDENT << LF;
+  tree t= read_tag (name);
 
   bool closed= !skip_flag;
-  while (pos < N (buf)) {
+  while (pos < n) {
     // cout << "last= " << last << LF;
     bool sub_flag= (skip_flag) && ((last == "") || (last[N (last) - 1] != '|'));
     if (sub_flag) (void) skip_blank ();
@@ -226,10 +275,27 @@ tm_reader::read_apply (string name, bool skip_flag) {
   return t;
 }
 
+static inline int
+hex_digit (char c) {
+  if ((c >= '0') && (c <= '9')) return (int) (c - '0');
+  if ((c >= 'A') && (c <= 'F')) return (int) (c + 10 - 'A');
+  if ((c >= 'a') && (c <= 'f')) return (int) (c + 10 - 'a');
+  return 0;
+}
+
+static inline int
+hex_pair (char c1, char c2) {
+  // same as from_hex on the two character string c1 c2
+  if (c1 == '-') return -hex_digit (c2);
+  return (hex_digit (c1) << 4) + hex_digit (c2);
+}
+
 static void
 flush (tree& D, tree& C, string& S, bool& spc_flag, bool& ret_flag) {
   if (spc_flag) S << " ";
   if (S != "") {
+    // short atoms recur throughout documents, so share them
+    if (N (S) <= STRING_INLINE) S= intern (S);
     if ((N (C) == 0) || (!is_atomic (C[N (C) - 1]))) C << S;
     else C[N (C) - 1]->label << S;
     S       = "";
@@ -281,12 +347,13 @@ tm_reader::read (bool skip_flag) {
         break;
       }
       else if (last[N (last) - 1] == '#') {
-        string r;
-        while ((buf[pos] != '>') && (pos + 2 < N (buf))) {
-          r << ((char) from_hex (buf (pos, pos + 2)));
-          pos+= 2;
-        }
-        if (buf[pos] == '>') pos++;
+        int end= pos;
+        while ((end + 2 < n) && (a[end] != '>'))
+          end+= 2;
+        string r ((end - pos) >> 1);
+        for (int i= 0; pos < end; i++, pos+= 2)
+          r[i]= (char) hex_pair (a[pos], a[pos + 1]);
+        if ((pos < n) && (a[pos] == '>')) pos++;
         flush (D, C, S, spc_flag, ret_flag);
         C << tree (RAW_DATA, r);
         last= read_next ();
@@ -305,14 +372,7 @@ tm_reader::read (bool skip_flag) {
           C << read_apply (name, false);
         }
         else {
-          tree t (make_tree_label (name));
-          if (!with_extensions) t= tree (EXPAND_APPLY, name);
-          if (codes->contains (name)) {
-            // cout << name << " -> " << as_string ((tree_label) codes [name])
-            // << "\n";
-            t= tree ((tree_label) codes[name]);
-          }
-          C << t;
+          C << read_tag (name);
         }
       }
     }
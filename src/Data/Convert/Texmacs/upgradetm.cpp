@@ -402,16 +402,17 @@ tree
 upgrade_textual (tree t, path& mode_stack) {
   if (t == "") return t;
   if (is_atomic (t)) {
-    int    i, n= N (t->label);
-    string s;
-    tree   r (CONCAT);
+    const string& lab= t->label; // reading keeps interned atoms shared
+    int           i, n= N (lab);
+    string        s;
+    tree          r (CONCAT);
     for (i= 0; i < n;) {
-      if (t->label[i] == '<') {
+      if (lab[i] == '<') {
         int start= i;
         for (i++; i < n; i++)
-          if (t->label[i - 1] == '>') break;
+          if (lab[i - 1] == '>') break;
         string ss= t->label (start, i);
-        if (t->label[i - 1] != '>') ss << '>';
+        if (lab[i - 1] != '>') ss << '>';
         if (starts (ss, "<left-")) {
           if (s != "") {
             r << s;
@@ -442,19 +443,19 @@ upgrade_textual (tree t, path& mode_stack) {
         }
         else s << ss;
       }
-      else if (((t->label[i] == '\'') || (t->label[i] == '`')) &&
+      else if (((lab[i] == '\'') || (lab[i] == '`')) &&
                (!is_nil (mode_stack)) && (mode_stack->item == 1)) {
         int start= i++;
-        while ((i < n) && (t->label[i] == t->label[i - 1]))
+        while ((i < n) && (lab[i] == lab[i - 1]))
           i++;
         if (s != "") {
           r << s;
           s= "";
         }
-        tree_label op= t->label[start] == '`' ? LPRIME : RPRIME;
+        tree_label op= lab[start] == '`' ? LPRIME : RPRIME;
         r << tree (op, t->label (start, i));
       }
-      else s << t->label[i++];
+      else s << lab[i++];
     }
     if (s != "") r << s;
     if (N (r) == 1) return r[0];
@@ -12,6 +12,7 @@
 #include "archiver.hpp"
 #include "hashset.hpp"
 #include "iterator.hpp"
+#include "journal.hpp"
 #include "observers.hpp"
 #include "tm_debug.hpp"
 #include "tree.hpp"
@@ -26,6 +27,8 @@ static hashset<double>  genuine_authors;
 static hashset<pointer> archs;
 static hashset<pointer> pending_archs;
 
+#define MAX_JOURNAL (1 << 24)
+
 /******************************************************************************
  * Constructors, destructors, printing and announcements
  ******************************************************************************/
@@ -33,7 +36,8 @@ static hashset<pointer> pending_archs;
 archiver_rep::archiver_rep (double author, path rp2)
     : archive (make_branches (0)), current (make_compound (0)), depth (0),
       last_save (0), last_autosave (0), the_author (author), the_owner (0),
-      rp (rp2), undo_obs (undo_observer (this)), versioning (false) {
+      rp (rp2), undo_obs (undo_observer (this)), versioning (false),
+      journal (""), journaling (false) {
   archs->insert ((pointer) this);
   attach_observer (subtree (the_et, rp), undo_obs);
   genuine_authors->insert (the_author);
@@ -72,6 +76,10 @@ archive_announce (archiver_rep* arch, modification mod) {
   ////stretched_print (the_et, true);
   if (DEBUG_HISTORY) debug_history << "Archive " << mod << "\n";
   ASSERT (arch->rp <= mod->p, "invalid modification");
+  if (arch->journaling && mod->k != MOD_SET_CURSOR) {
+    journal_append (arch->journal, mod / arch->rp);
+    if (N (arch->journal) > MAX_JOURNAL) arch->require_autosave ();
+  }
   if (!arch->versioning) {
     arch->add (mod);
     pending_archs->insert ((pointer) arch);
@@ -657,14 +665,26 @@ archiver_rep::conform_save () {
 void
 archiver_rep::require_autosave () {
   last_autosave= -1;
+  journal      = "";
+  journaling   = false;
 }
 
 void
 archiver_rep::notify_autosave () {
   last_autosave= depth;
+  journal      = "";
+  journaling   = true;
 }
 
 bool
 archiver_rep::conform_autosave () {
   return last_autosave == depth;
 }
+
+bool
+archiver_rep::get_journal (string& s) {
+  // NOTE: changes which are not modifications of the document body,
+  // such as changes of the style, call require_autosave
+  s= journal;
+  return journaling;
+}
@@ -28,6 +28,8 @@ class archiver_rep : public concrete_struct {
   path     rp;            // root path for document
   observer undo_obs;      // observer for undoing changes
   bool     versioning;    // true during undo and redo operations
+  string   journal;       // modifications since last autosave, if journaling
+  bool     journaling;    // journal covers all changes since last autosave
 
 protected:
   void  apply (patch p);
@@ -71,6 +73,7 @@ public:
   void notify_autosave ();
   bool conform_save ();
   bool conform_autosave ();
+  bool get_journal (string& s);
 
   friend void archive_announce (archiver_rep* arch, modification mod);
   friend void global_clear_history ();
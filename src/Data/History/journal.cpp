@@ -0,0 +1,163 @@
+
+/******************************************************************************
+ * MODULE     : journal.cpp
+ * DESCRIPTION: compact binary journals of modifications
+ * COPYRIGHT  : (C) 2026  Darcy Shen
+ *******************************************************************************
+ * This software falls under the GNU general public license version 3 or later.
+ * It comes WITHOUT ANY WARRANTY WHATSOEVER. For details, see the file LICENSE
+ * in the root directory or <http://www.gnu.org/licenses/gpl-3.0.html>.
+ ******************************************************************************/
+
+#include "journal.hpp"
+#include "tree_helper.hpp"
+
+using namespace moebius;
+
+#define JOURNAL_MAGIC "TMJ1"
+
+/******************************************************************************
+ * Encoding
+ ******************************************************************************/
+
+static void
+put_number (string& s, unsigned int n) {
+  while (n >= 128) {
+    s << (char) ((n & 127) | 128);
+    n>>= 7;
+  }
+  s << (char) n;
+}
+
+static void
+put_int (string& s, int i) {
+  put_number (s, (((unsigned int) i) << 1) ^ (unsigned int) (i >> 31));
+}
+
+static void
+put_string (string& s, string r) {
+  put_number (s, N (r));
+  s << r;
+}
+
+static void
+put_tree (string& s, tree t) {
+  if (is_atomic (t)) {
+    put_number (s, 0);
+    put_string (s, t->label);
+  }
+  else {
+    int i, n= N (t);
+    put_number (s, n + 1);
+    put_string (s, as_string (L (t)));
+    for (i= 0; i < n; i++)
+      put_tree (s, t[i]);
+  }
+}
+
+string
+journal_header (string stamp) {
+  string s= JOURNAL_MAGIC;
+  put_string (s, stamp);
+  return s;
+}
+
+void
+journal_append (string& s, modification mod) {
+  string r;
+  put_number (r, mod->k);
+  put_number (r, N (mod->p));
+  for (path p= mod->p; !is_nil (p); p= p->next)
+    put_int (r, p->item);
+  put_tree (r, mod->t);
+  put_string (s, r);
+}
+
+/******************************************************************************
+ * Decoding
+ ******************************************************************************/
+
+static bool
+get_number (string s, int& pos, int end, unsigned int& n) {
+  n= 0;
+  for (int shift= 0; pos < end && shift < 32; shift+= 7) {
+    unsigned char c= (unsigned char) s[pos++];
+    n|= ((unsigned int) (c & 127)) << shift;
+    if (c < 128) return true;
+  }
+  return false;
+}
+
+static bool
+get_int (string s, int& pos, int end, int& i) {
+  unsigned int n;
+  if (!get_number (s, pos, end, n)) return false;
+  i= (int) (n >> 1) ^ -((int) (n & 1));
+  return true;
+}
+
+static bool
+get_string (string s, int& pos, int end, string& r) {
+  unsigned int n;
+  if (!get_number (s, pos, end, n) || n > (unsigned int) (end - pos))
+    return false;
+  r  = s (pos, pos + n);
+  pos= pos + n;
+  return true;
+}
+
+static bool
+get_tree (string s, int& pos, int end, tree& t) {
+  unsigned int n;
+  string       r;
+  if (!get_number (s, pos, end, n) || !get_string (s, pos, end, r))
+    return false;
+  if (n == 0) {
+    t= tree (r);
+    return true;
+  }
+  if (n - 1 > (unsigned int) (end - pos)) return false;
+  t= tree (make_tree_label (r), (int) (n - 1));
+  for (int i= 0; i < N (t); i++)
+    if (!get_tree (s, pos, end, t[i])) return false;
+  return true;
+}
+
+bool
+journal_read_header (string s, int& pos, string& stamp) {
+  int m= N (string (JOURNAL_MAGIC));
+  if (N (s) < pos + m || s (pos, pos + m) != JOURNAL_MAGIC) return false;
+  pos+= m;
+  return get_string (s, pos, N (s), stamp);
+}
+
+bool
+journal_read (string s, int& pos, modification& mod) {
+  string r;
+  if (!get_string (s, pos, N (s), r)) return false;
+  int          i= 0, end= N (r);
+  unsigned int k, n;
+  if (!get_number (r, i, end, k) || !get_number (r, i, end, n)) return false;
+  if (k < MOD_ASSIGN || k >= MOD_SET_CURSOR || n > (unsigned int) end)
+    return false;
+  array<int> a ((int) n);
+  for (int j= 0; j < N (a); j++)
+    if (!get_int (r, i, end, a[j])) return false;
+  path p;
+  for (int j= N (a) - 1; j >= 0; j--)
+    p= path (a[j], p);
+  tree t;
+  if (!get_tree (r, i, end, t) || i != end) return false;
+  mod= modification ((modification_type) k, p, t);
+  return true;
+}
+
+tree
+journal_replay (tree t, string s, int pos) {
+  modification mod (MOD_ASSIGN, path ());
+  while (journal_read (s, pos, mod)) {
+    if (!is_applicable (t, mod)) break;
+    t= clean_apply (t, mod);
+  }
+  return t;
+}
@@ -0,0 +1,28 @@
+
+/******************************************************************************
+ * MODULE     : journal.hpp
+ * DESCRIPTION: compact binary journals of modifications
+ * COPYRIGHT  : (C) 2026  Darcy Shen
+ *******************************************************************************
+ * A journal starts with a header which identifies the full save on top of
+ * which it has to be replayed, followed by length prefixed records, one for
+ * each modification. Integers are encoded as variable length quantities,
+ * so that most paths take a few bytes only. A record which was truncated
+ * by a crash during an append is ignored on reading.
+ *******************************************************************************
+ * This software falls under the GNU general public license version 3 or later.
+ * It comes WITHOUT ANY WARRANTY WHATSOEVER. For details, see the file LICENSE
+ * in the root directory or <http://www.gnu.org/licenses/gpl-3.0.html>.
+ ******************************************************************************/
+
+#ifndef JOURNAL_H
+#define JOURNAL_H
+#include "modification.hpp"
+
+string journal_header (string stamp);
+bool   journal_read_header (string s, int& pos, string& stamp);
+void   journal_append (string& s, modification mod);
+bool   journal_read (string s, int& pos, modification& mod);
+tree   journal_replay (tree t, string s, int pos);
+
+#endif // defined JOURNAL_H
@@ -54,6 +54,8 @@ public:
  * Call back routines for announcements
  ******************************************************************************/
 
+static void move_ip (tree& ref, int i, path ip);
+
 bool
 has_parent (path ip) {
   return !is_nil (ip) && last_item (ip) != DETACHED;
@@ -106,7 +108,7 @@ ip_observer_rep::notify_insert (tree& ref, int pos, int nr) {
   if (is_compound (ref)) {
     int i, n= N (ref);
     for (i= pos; i < n; i++)
-      attach_ip (ref[i], path (i, ip));
+      move_ip (ref[i], i, ip);
   }
 }
 
@@ -119,7 +121,7 @@ ip_observer_rep::notify_remove (tree& ref, int pos, int nr) {
     for (i= pos; i < (pos + nr); i++)
       detach_ip (ref[i]);
     for (; i < n; i++)
-      attach_ip (ref[i], path (i - nr, ip));
+      move_ip (ref[i], i - nr, ip);
   }
 }
 
@@ -129,7 +131,7 @@ ip_observer_rep::notify_split (tree& ref, int pos, tree prev) {
   int i, n= N (ref);
   detach_ip (prev);
   for (i= pos; i < n; i++)
-    attach_ip (ref[i], path (i, ip));
+    move_ip (ref[i], i, ip);
 }
 
 void
@@ -146,7 +148,7 @@ ip_observer_rep::notify_join (tree& ref, int pos, tree next) {
   detach_ip (ref[pos]);
   detach_ip (ref[pos + 1]);
   for (i= pos + 2; i < n; i++)
-    attach_ip (ref[i], path (i - 1, ip));
+    move_ip (ref[i], i - 1, ip);
   attach_ip (next, path (pos, ip));
 }
 
@@ -207,6 +209,14 @@ ip_observer_rep::set_ip (path ip2) {
   return true;
 }
 
+static bool
+linked_ip (tree& ref, int i, path ip) {
+  path old_ip;
+  if (is_nil (ref->data) || !ref->data->get_ip (old_ip)) return false;
+  return !is_nil (old_ip) && (old_ip->item == i) &&
+         strong_equal (old_ip->next, ip);
+}
+
 void
 attach_ip (tree& ref, path ip) {
   // cout << "Set ip of " << ref << " to " << ip << "\n";
@@ -215,16 +225,29 @@ attach_ip (tree& ref, path ip) {
     ref->data= list_observer (ip_observer (ip), ref->data);
   }
   if (is_compound (ref)) {
-    int i, n= N (ref);
-    for (i= 0; i < n; i++) {
-      path old_ip= obtain_ip (ref[i]);
-      if ((old_ip->item != i) || (!strong_equal (old_ip->next, ip))) {
-        attach_ip (ref[i], path (i, ip));
-      }
-    }
+    // Let the children share the memory cell of the inverse path of ref
+    int  i, n= N (ref);
+    path cell= ip;
+    (void) ref->data->get_ip (cell);
+    for (i= 0; i < n; i++)
+      if (!linked_ip (ref[i], i, cell)) attach_ip (ref[i], path (i, cell));
   }
 }
 
+static void
+move_ip (tree& ref, int i, path ip) {
+  // The inverse paths of the descendants of ref share the memory cell
+  // of the inverse path of ref. If ref is already attached to ip,
+  // then it suffices to update its position in this cell.
+  // Like set_ip, which attach_ip used to apply to the whole subtree,
+  // this also updates the inverse paths kept by boxes and bridges.
+  path old_ip;
+  if (is_nil (ref->data) || !ref->data->get_ip (old_ip) || is_nil (old_ip) ||
+      (old_ip->item < 0) || !strong_equal (old_ip->next, ip))
+    attach_ip (ref, path (i, ip));
+  else old_ip->item= i;
+}
+
 void
 detach_ip (tree& ref) {
   // cout << "Detach ip of " << ref << "\n";
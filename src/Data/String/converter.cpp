@@ -37,9 +37,14 @@ using moebius::data::block_to_scheme_tree;
 
 void
 operator<< (converter c, string str) {
-  int index= 0;
-  while (index < N (str))
-    c->match (str, index);
+  int index= 0, n= N (str);
+  while (index < n) {
+    int start= index;
+    while (index < n && c->unchanged (str[index]))
+      index++;
+    if (index > start) c->output << str (start, index);
+    if (index < n) c->match (str, index);
+  }
 }
 
 string
@@ -72,41 +77,75 @@ load_converter (string from, string to) {
  * converter_rep methods
  ******************************************************************************/
 
-inline bool
-converter_rep::has_value (hashtree<char, string> node) {
-  return node->label != nil_string;
+inline int
+converter_rep::find_next (int node, char c) {
+  int i= trie_start[node], j= trie_start[node + 1];
+  while (i < j) {
+    int mid= (i + j) >> 1;
+    if (trie_key[mid] == c) return trie_next[mid];
+    if (((unsigned char) trie_key[mid]) < ((unsigned char) c)) i= mid + 1;
+    else j= mid;
+  }
+  return -1;
 }
 
 inline void
 converter_rep::match (string& str, int& index) {
-  int                    forward   = index;
-  int                    last_match= -1;
-  string                 value ("");
-  bool                   done= false;
-  hashtree<char, string> node= ht;
-  // cout << "[";
-  while (!done && forward < N (str)) {
-    if (node->contains (str[forward])) {
-      node= node (str[forward]);
-      // printf("->%x",str[forward]);
-      if (has_value (node)) {
-        last_match= forward;
-        value     = node->label;
-      }
-      forward++;
+  int forward   = index;
+  int last_match= -1;
+  int value     = -1;
+  int n         = N (str);
+  int node      = trie_root[(unsigned char) str[forward]];
+  while (node >= 0) {
+    if (trie_value[node] >= 0) {
+      last_match= forward;
+      value     = trie_value[node];
     }
-    else done= true;
+    if (++forward >= n) break;
+    node= find_next (node, str[forward]);
   }
   if (last_match == -1) {
     if (copy_unmatched) output << string (str[index]);
     index++;
   }
   else {
-    // printf(":");for(int i = 0; i < N(value);i++) printf("%x ",value[i]);
-    output << value;
+    output << values[value];
     index= last_match + 1;
   }
-  // cout << "]";
+}
+
+void
+converter_rep::compile () {
+  // NOTE: nodes are numbered in breadth first order, so that the edges
+  // leaving successive nodes are stored one after another
+  array<hashtree<char, string>> todo;
+  todo << ht;
+  for (int i= 0; i < N (todo); i++) {
+    hashtree<char, string> node= todo[i];
+    trie_start << N (trie_key);
+    if (node->label == "") trie_value << -1;
+    else {
+      trie_value << N (values);
+      values << node->label;
+    }
+    for (int c= 0; c < 256; c++)
+      if (node->contains ((char) c)) {
+        trie_key << (char) c;
+        trie_next << N (todo);
+        todo << node ((char) c);
+      }
+  }
+  trie_start << N (trie_key);
+  for (int c= 0; c < 256; c++) {
+    int node    = find_next (0, (char) c);
+    trie_root[c]= node;
+    if (node < 0) trie_same[c]= copy_unmatched;
+    else
+      trie_same[c]= trie_start[node] == trie_start[node + 1] &&
+                    trie_value[node] >= 0 &&
+                    values[trie_value[node]] == string ((char) c);
+  }
+  ht= hashtree<char, string> ();
 }
 
 void
@@ -345,13 +384,26 @@ convert_utf8_to_LaTeX (string input) {
   return output;
 }
 
+static int
+skip_plain (converter conv, string s, int i) {
+  int n= N (s);
+  while (i < n && ((unsigned char) s[i]) < 128 && conv->unchanged (s[i]))
+    i++;
+  return i;
+}
+
 string
 utf8_to_cork (string input) {
   converter conv= load_converter ("UTF-8", "Cork");
   int       start, i, n= N (input);
   string    output;
   for (i= 0; i < n;) {
-    start            = i;
+    start= i;
+    i    = skip_plain (conv, input, i);
+    if (i > start) {
+      output << input (start, i);
+      continue;
+    }
     unsigned int code= decode_from_utf8 (input, i);
     string       s   = input (start, i);
     string       r   = apply (conv, s);
@@ -390,7 +442,12 @@ sourcecode_to_cork (string input) {
   int       start, i, n= N (input);
   string    output;
   for (i= 0; i < n;) {
-    start            = i;
+    start= i;
+    i    = skip_plain (conv, input, i);
+    if (i > start) {
+      output << input (start, i);
+      continue;
+    }
     unsigned int code= decode_from_utf8 (input, i);
     string       s   = input (start, i);
     string       r   = apply (conv, s);
@@ -478,7 +535,12 @@ utf8_to_t2a (string_u8 input) {
   int       start, i, n= N (input);
   string    output;
   for (i= 0; i < n;) {
-    start            = i;
+    start= i;
+    i    = skip_plain (conv, input, i);
+    if (i > start) {
+      output << input (start, i);
+      continue;
+    }
     unsigned int code= decode_from_utf8 (input, i);
     string       s   = input (start, i);
     string       r   = apply (conv, s);
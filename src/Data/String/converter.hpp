@@ -26,24 +26,39 @@ RESOURCE (converter);
  * The converter class applies a dictionary to a given string.
  * It does so by iterating over a string, finding the longest matching key
  * in the dictionary and replacing the matched substring with the translation.
- * The hashtree and converter classes are used.
+ * The dictionary is loaded into a hashtree, which is then compiled into
+ * a trie with flat arrays: the edges leaving node i are the entries
+ * trie_start[i] until trie_start[i+1] of trie_key and trie_next,
+ * sorted by key, and the edges leaving the root are also indexed directly.
+ * Bytes which are translated into themselves, whatever follows them,
+ * are marked so that runs of them can be copied at once.
  ******************************************************************************/
 
 struct converter_rep : rep<converter> {
   hashtree<char, string> ht;
-  string                 output, nil_string, from, to;
+  string                 output, from, to;
   bool                   copy_unmatched;
+  int                    trie_root[256]; // node after the first byte or -1
+  bool                   trie_same[256]; // bytes which are left unchanged
+  array<int>             trie_start;     // first edge leaving each node
+  array<char>            trie_key;       // byte on each edge
+  array<int>             trie_next;      // node at the end of each edge
+  array<int>             trie_value;     // index in values or -1 for nodes
+  array<string>          values;         // translations
   void                   match (string& str, int& index);
   void                   load ();
+  void                   compile ();
 
 public:
   inline converter_rep (string from2, string to2)
-      : rep<converter> (from2 * "-" * to2), ht (), output (), nil_string (),
-        from (from2), to (to2), copy_unmatched (true) {
+      : rep<converter> (from2 * "-" * to2), ht (), output (), from (from2),
+        to (to2), copy_unmatched (true) {
     load ();
+    compile ();
   }
 
-  inline bool has_value (hashtree<char, string> node);
+  inline bool unchanged (char c) { return trie_same[(unsigned char) c]; }
+  inline int  find_next (int node, char c);
 
   friend struct converter;
   friend string flush (converter c);
@@ -781,8 +781,7 @@ misc_math_correct (tree t) {
     tree arg = misc_math_correct (t[0]);
     tree last= arg;
     if (is_concat (last) && N (last) > 0) last= last[N (last) - 1];
-    if (is_atomic (last) && N (last->label) > 0 &&
-        is_punctuation (last->label[N (last->label) - 1])) {
+    if (is_atomic (last) && N (last->label) > 0) {
       string s= last->label;
       int    i= N (s);
       while (i > 0 && is_punctuation (s[i - 1]))
@@ -441,7 +441,8 @@ next_is_word (tree t, path p) {
   int  l= last_item (p), n= N (st);
   if (!is_concat (st) || l + 1 >= n) return false;
   if (is_compound (st[l + 1])) return true;
-  return st[l + 1] != "" && is_iso_alphanum (st[l + 1]->label[0]);
+  const string& s= st[l + 1]->label;
+  return N (s) > 0 && is_iso_alphanum (s[0]);
 }
 
 static path
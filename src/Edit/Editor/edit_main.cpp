@@ -192,6 +192,22 @@ edit_main_rep::nr_pages () {
   return N (the_box[0]);
 }
 
+bool
+edit_main_rep::print_as_displayed (bool conform) {
+  // NOTE: the displayed pages can be printed when they are up to date and
+  // when the variables which are set for printing already have the same
+  // values on the screen
+  if (env_change & (THE_TREE + THE_ENVIRONMENT + THE_EXTENTS)) return false;
+  if (N (eb) == 0) return false;
+  if (env->read (PAGE_SHOW_HF) != "true") return false;
+  if (env->read (PAGE_SCREEN_MARGIN) != "false") return false;
+  if (env->read (PAGE_BORDER) != "none") return false;
+  if (is_func (env->read (BG_COLOR), PATTERN)) return false;
+  if (conform) return true;
+  if (env->read (PAGE_MEDIUM) != "paper") return false;
+  return env->read (PAGE_PRINTED) == "true" || !env->printed;
+}
+
 void
 edit_main_rep::print_doc (url name, bool conform, int first, int last) {
   bool ps  = (suffix (name) == "ps");
@@ -209,6 +225,7 @@ edit_main_rep::print_doc (url name, bool conform, int first, int last) {
   // Set environment variables for printing
 
   typeset_prepare ();
+  bool reuse= print_as_displayed (conform);
   env->write (PAGE_SHOW_HF, "true");
   env->write (PAGE_SCREEN_MARGIN, "false");
   env->write (PAGE_BORDER, "none");
@@ -230,11 +247,17 @@ edit_main_rep::print_doc (url name, bool conform, int first, int last) {
   // because the link registrations are already gone. This particularly
   // affects beamer/slideshow export where a temporary buffer copy has no
   // prior link registrations from screen display. (See issue #2843)
-
-  env->style_init_env ();
-  env->update ();
-  typesetter ttt    = new_typesetter (env, subtree (et, rp), reverse (rp));
-  box        the_box= ::typeset (ttt);
+  // When the printing environment coincides with the one for the screen,
+  // the pages on the screen are printed as they are.
+
+  typesetter ttt    = NULL;
+  box        the_box= eb;
+  if (!reuse) {
+    env->style_init_env ();
+    env->update ();
+    ttt    = new_typesetter (env, subtree (et, rp), reverse (rp));
+    the_box= ::typeset (ttt);
+  }
 
   // Determine parameters for printer
 
@@ -266,21 +289,24 @@ edit_main_rep::print_doc (url name, bool conform, int first, int last) {
     ren->set_metadata ("author", get_metadata ("author"));
     ren->set_metadata ("subject", get_metadata ("subject"));
     ren->set_metadata ("keyword", get_metadata ("keyword"));
+    tree bg= env->read (BG_COLOR);
     for (i= start; i < end; i++) {
-      tree bg= env->read (BG_COLOR);
       ren->set_background (bg);
       if (bg != "white" && bg != "#ffffff")
         ren->clear_pattern (0, (SI) -h, (SI) w, 0);
 
       rectangles rs;
+      SI         sx= the_box[0]->sx (i), sy= the_box[0]->sy (i);
       the_box[0]->sx (i)= 0;
       the_box[0]->sy (i)= 0;
       the_box[0][i]->redraw (ren, path (0), rs);
+      the_box[0]->sx (i)= sx;
+      the_box[0]->sy (i)= sy;
       if (i < end - 1) ren->next_page ();
     }
   }
   tm_delete (ren);
-  delete_typesetter (ttt);
+  if (!reuse) delete_typesetter (ttt);
 }
 
 void
@@ -20,6 +20,7 @@
 #include "new_style.hpp"
 #include "observers.hpp"
 #include "tm_buffer.hpp"
+#include "tm_profile.hpp"
 #include "tm_timer.hpp"
 #include "tree_modify.hpp"
 #include "tree_observer.hpp"
@@ -36,8 +37,9 @@ bool enable_fastenv= false;
 
 edit_typeset_rep::edit_typeset_rep ()
     : editor_rep (), // NOTE: ignored by the compiler, but suppresses warning
-      the_style (TUPLE), cur (hashmap<string, tree> (UNINIT)), stydef (UNINIT),
-      pre (UNINIT), init (UNINIT), fin (UNINIT), grefs (UNINIT),
+      the_style (TUPLE), cur (hashmap<string, tree> (UNINIT)),
+      cur_base (UNINIT), stydef (UNINIT), pre (UNINIT), init (UNINIT),
+      fin (UNINIT), grefs (UNINIT),
       env (drd, buf->buf->master, buf->data->ref,
            (buf->prj == NULL ? grefs : buf->prj->data->ref), buf->data->aux,
            (buf->prj == NULL ? buf->data->aux : buf->prj->data->aux),
@@ -390,8 +392,7 @@ edit_typeset_rep::init_update () {
 
 void
 edit_typeset_rep::drd_update () {
-  typeset_exec_until (tp);
-  drd->heuristic_init (cur[tp]);
+  drd->heuristic_init (typeset_env_at (tp));
 }
 
 /******************************************************************************
@@ -400,7 +401,8 @@ edit_typeset_rep::drd_update () {
 
 void
 edit_typeset_rep::typeset_invalidate_env () {
-  cur= hashmap<path, hashmap<string, tree>> (hashmap<string, tree> (UNINIT));
+  cur_base= hashmap<string, tree> (UNINIT);
+  cur     = hashmap<path, hashmap<string, tree>> (copy (cur_base));
 }
 
 static void
@@ -476,7 +478,7 @@ edit_typeset_rep::typeset_exec_until (path p) {
   // FIXME: we should ensure that p is inside the document
   // if (!(rp <= p)) p= correct_cursor (et, rp * 0);
 
-  // time_t t1= texmacs_time ();
+  PROFILE_SCOPE ("environment");
   if (has_changed (THE_TREE + THE_ENVIRONMENT))
     if (p != correct_cursor (et, rp * 0)) {
       // if (DEBUG_STD) std_warning << "resynchronizing for path " << p << "\n";
@@ -489,10 +491,11 @@ edit_typeset_rep::typeset_exec_until (path p) {
   }
 
   // cout << "Exec until " << p << LF;
-  if (N (cur[p]) != 0) return;
-  if (N (cur) >= 25) // avoids out of memory in weird cases
+  if (cur->contains (p)) return;
+  if (N (cur) >= 1000) // avoids out of memory in weird cases
     typeset_invalidate_env ();
   typeset_prepare ();
+  if (N (cur_base) == 0) env->read_env (cur_base);
   if (enable_fastenv) {
     if (!(rp < p)) {
       failed_error << "Erroneous path " << p << "\n";
@@ -533,27 +536,47 @@ edit_typeset_rep::typeset_exec_until (path p) {
   else exec_until (ttt, p / rp);
   if (env->read (MODE) == "src" && env->read (PREAMBLE) != "true")
     define_style_macros (env, subtree (et, rp));
-  env->read_env (cur (p));
-  // time_t t2= texmacs_time ();
-  // if (t2 - t1 >= 10) cout << "typeset_exec_until took " << t2-t1 << "ms\n";
+  env->read_env (cur_base, cur (p));
+}
+
+hashmap<string, tree>
+edit_typeset_rep::typeset_env_at (path p) {
+  bool at_cursor= (p == tp);
+  typeset_exec_until (p);
+  if (at_cursor) p= tp; // the cursor may have been corrected
+  hashmap<string, tree> H      = copy (cur_base);
+  hashmap<string, tree> changes= cur[p];
+  iterator<string>      it     = iterate (changes);
+  while (it->busy ()) {
+    string var= it->next ();
+    H (var)   = changes[var];
+  }
+  return H;
+}
+
+tree
+edit_typeset_rep::typeset_value_at (path p, string var) {
+  bool at_cursor= (p == tp);
+  typeset_exec_until (p);
+  if (at_cursor) p= tp;
+  hashmap<string, tree> changes= cur[p];
+  if (changes->contains (var)) return changes[var];
+  return cur_base[var];
 }
 
 tree
 edit_typeset_rep::get_full_env () {
-  typeset_exec_until (tp);
-  return as_tree (cur[tp]);
+  return as_tree (typeset_env_at (tp));
 }
 
 bool
 edit_typeset_rep::defined_at_cursor (string var) {
-  typeset_exec_until (tp);
-  return cur[tp]->contains (var);
+  return typeset_value_at (tp, var) != UNINIT;
 }
 
 tree
 edit_typeset_rep::get_env_value (string var, path p) {
-  typeset_exec_until (p);
-  tree t= cur[p][var];
+  tree t= typeset_value_at (p, var);
   return is_func (t, BACKUP, 2) ? t[0] : t;
 }
 
@@ -768,8 +791,7 @@ edit_typeset_rep::exec (tree t, hashmap<string, tree> H, bool expand_refs) {
 
 tree
 edit_typeset_rep::exec_texmacs (tree t, path p) {
-  typeset_exec_until (p);
-  return exec (t, cur[p]);
+  return exec (t, typeset_env_at (p));
 }
 
 tree
@@ -780,8 +802,7 @@ edit_typeset_rep::exec_texmacs (tree t) {
 tree
 edit_typeset_rep::exec_verbatim (tree t, path p) {
   t= convert_OTS1_symbols_to_universal_encoding (t);
-  typeset_exec_until (p);
-  hashmap<string, tree> H= copy (cur[p]);
+  hashmap<string, tree> H= typeset_env_at (p);
   H ("TeXmacs")          = tree (MACRO, "TeXmacs");
   H ("LaTeX")            = tree (MACRO, "LaTeX");
   H ("TeX")              = tree (MACRO, "TeX");
@@ -810,8 +831,7 @@ tree
 edit_typeset_rep::exec_html (tree t, path p) {
   t= convert_OTS1_symbols_to_universal_encoding (t);
   if (p == (rp * 0)) typeset_preamble ();
-  typeset_exec_until (p);
-  hashmap<string, tree> H= copy (cur[p]);
+  hashmap<string, tree> H= typeset_env_at (p);
   tree patch             = as_tree (eval ("(stree->tree (tmhtml-env-patch))"));
   hashmap<string, tree> P= tree_hashmap (UNINIT, patch);
   H->join (P);
@@ -877,8 +897,7 @@ edit_typeset_rep::exec_latex (tree t, path p) {
       as_string (call ("get-preference", "texmacs->latex:expand-user-macros"));
   if (!expand_unknown_macros && !expand_user_macro) return t;
   if (p == (rp * 0)) typeset_preamble ();
-  typeset_exec_until (p);
-  hashmap<string, tree> H = copy (cur[p]);
+  hashmap<string, tree> H = typeset_env_at (p);
   object                l = null_object ();
   iterator<string>      it= iterate (H);
   while (it->busy ())
@@ -914,8 +933,7 @@ edit_typeset_rep::texmacs_exec (tree t) {
 
 tree
 edit_typeset_rep::var_texmacs_exec (tree t) {
-  typeset_exec_until (tp);
-  env->write_env (cur[tp]);
+  env->write_env (typeset_env_at (tp));
   env->update_frame ();
   return texmacs_exec (t);
 }
@@ -930,8 +948,7 @@ edit_typeset_rep::checkout_animation (tree t) {
   if (is_nil (p)) p= search_upwards (ANIM_DYNAMIC);
   if (is_nil (p)) p= search_upwards ("anim-edit");
   if (!is_nil (p)) {
-    typeset_exec_until (p);
-    env->write_env (cur[p]);
+    env->write_env (typeset_env_at (p));
   }
   return env->checkout_animation (t);
 }
@@ -942,8 +959,7 @@ edit_typeset_rep::commit_animation (tree t) {
   if (is_nil (p)) p= search_upwards (ANIM_STATIC);
   if (is_nil (p)) p= search_upwards (ANIM_DYNAMIC);
   if (!is_nil (p)) {
-    typeset_exec_until (p);
-    env->write_env (cur[p]);
+    env->write_env (typeset_env_at (p));
   }
   return env->commit_animation (t);
 }
@@ -1007,7 +1023,7 @@ edit_typeset_rep::init_default (string var) {
 
 void
 edit_typeset_rep::typeset_sub (SI& x1, SI& y1, SI& x2, SI& y2) {
-  // time_t t1= texmacs_time ();
+  PROFILE_SCOPE ("typeset");
   typeset_prepare ();
   eb= empty_box (reverse (rp));
   // saves memory, also necessary for change_log update
@@ -1023,8 +1039,6 @@ edit_typeset_rep::typeset_sub (SI& x1, SI& y1, SI& x2, SI& y2) {
   }
   handle_exceptions ();
   if (DEBUG_BENCH) bench_end ("typeset");
-  // time_t t2= texmacs_time ();
-  // if (t2 - t1 >= 10) cout << "typeset took " << t2-t1 << "ms\n";
   picture_cache_clean ();
 }
 
@@ -20,7 +20,8 @@ class document_rep;
 class edit_typeset_rep : virtual public editor_rep {
 protected:
   tree                                 the_style; // document style
-  hashmap<path, hashmap<string, tree>> cur;    // environment at different paths
+  hashmap<path, hashmap<string, tree>> cur;    // changes at different paths
+  hashmap<string, tree>                cur_base; // environment before changes
   hashmap<string, tree>                stydef; // environment after styles
   hashmap<string, tree>                pre; // environment after styles and init
   hashmap<string, tree>                init; // environment changes w.r.t. style
@@ -134,6 +135,9 @@ public:
   void typeset (SI& x1, SI& y1, SI& x2, SI& y2);
   void typeset_forced ();
 
+  hashmap<string, tree> typeset_env_at (path p);
+  tree                  typeset_value_at (path p, string var);
+
   friend class tm_window_rep;
   friend class tm_server_rep;
 };
@@ -19,6 +19,7 @@
 #include "observers.hpp"
 #include "preferences.hpp"
 #include "server.hpp"
+#include "tm_profile.hpp"
 #include "tm_window.hpp"
 #include "tree_traverse.hpp"
 
@@ -753,7 +754,8 @@ edit_interface_rep::apply_changes () {
   }
 
   // cout << "Applying changes " << env_change << " to " << get_name() << "\n";
-  // time_t t1= texmacs_time ();
+  PROFILE_EDIT ();
+  PROFILE_SCOPE ("apply changes");
 
   // cout << "Handling automatic resizing\n";
   int sb= 1;
@@ -1076,8 +1078,6 @@ edit_interface_rep::apply_changes () {
   }
 
   // cout << "Applied changes\n";
-  // time_t t2= texmacs_time ();
-  // if (t2 - t1 >= 10) cout << "apply_changes took " << t2-t1 << "ms\n";
   env_change  = 0;
   last_change = texmacs_time ();
   last_update = last_change - 1;
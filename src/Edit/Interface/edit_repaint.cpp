@@ -14,6 +14,7 @@
 #include "message.hpp"
 #include "preferences.hpp"
 #include "sys_utils.hpp"
+#include "tm_profile.hpp"
 
 #include <lolly/data/unicode.hpp>
 
@@ -518,6 +519,7 @@ edit_interface_rep::handle_repaint (renderer win, SI x1, SI y1, SI x2, SI y2) {
   */
 
   // cout << "Repainting\n";
+  PROFILE_SCOPE ("repaint");
   draw_with_stored (win, rectangle (x1, y1, x2, y2) / magf);
   if (last_change - last_update > 0) last_change= texmacs_time ();
   // cout << "Repainted\n";
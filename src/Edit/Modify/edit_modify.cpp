@@ -418,6 +418,11 @@ edit_modify_rep::need_save (bool real_save) {
   return !arch->conform_autosave ();
 }
 
+bool
+edit_modify_rep::get_journal (string& s) {
+  return arch->get_journal (s);
+}
+
 void
 edit_modify_rep::show_history () {
   arch->show_all ();
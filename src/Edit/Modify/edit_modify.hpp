@@ -58,6 +58,7 @@ public:
   void require_save ();
   void notify_save (bool real_save= true);
   bool need_save (bool real_save= true);
+  bool get_journal (string& s);
   void show_history ();
 
   observer position_new (path p);
@@ -291,8 +291,8 @@ edit_replace_rep::step_horizontal (bool forward) {
       if (l == right_index (st)) step_ascend (forward);
       else {
         if (is_atomic (st)) {
-          if (st->label[l] == '<') {
-            string s= st->label;
+          const string& s= st->label;
+          if (s[l] == '<') {
             while ((l < N (s)) && (s[l] != '>'))
               l++;
             if (l < N (s)) l++;
@@ -316,8 +316,8 @@ edit_replace_rep::step_horizontal (bool forward) {
       if (l == 0) step_ascend (forward);
       else {
         if (is_atomic (st)) {
-          if (st->label[l - 1] == '>') {
-            string s= st->label;
+          const string& s= st->label;
+          if (s[l - 1] == '>') {
             l--;
             while ((l > 0) && (s[l] != '<'))
               l--;
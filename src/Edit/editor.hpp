@@ -374,6 +374,7 @@ public:
   virtual void     require_save ()                           = 0;
   virtual void     notify_save (bool real_save= true)        = 0;
   virtual bool     need_save (bool real_save= true)          = 0;
+  virtual bool     get_journal (string& s)                   = 0;
   virtual void     show_history ()                           = 0;
   virtual observer position_new (path p)                     = 0;
   virtual void     position_delete (observer o)              = 0;
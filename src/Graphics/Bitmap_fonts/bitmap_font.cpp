@@ -33,6 +33,14 @@ font_metric_rep::kerning (int left_code, int right_code) {
   return 0;
 }
 
+void
+font_metric_rep::kernings (int* codes, int n, SI* ks) {
+  // ks[i] is the kerning between codes[i-1] and codes[i]
+  if (n > 0) ks[0]= 0;
+  for (int i= 1; i < n; i++)
+    ks[i]= kerning (codes[i - 1], codes[i]);
+}
+
 /******************************************************************************
  * Standard bitmap metrics
  ******************************************************************************/
@@ -155,6 +155,7 @@ struct font_metric_rep : rep<font_metric> {
   virtual bool    exists (int char_code);
   virtual metric& get (int char_code)= 0;
   virtual SI      kerning (int left_code, int right_code);
+  virtual void    kernings (int* codes, int n, SI* ks);
 };
 
 struct font_glyphs_rep : rep<font_glyphs> {
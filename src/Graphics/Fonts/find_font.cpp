@@ -213,13 +213,40 @@ find_magnified_font (tree t, double zoomx, double zoomy) {
   return fn->magnify (zoomx, zoomy);
 }
 
+/******************************************************************************
+ * Structured keys
+ ******************************************************************************/
+
+bool
+operator== (const font_key& k1, const font_key& k2) {
+  return k1.sz == k2.sz && k1.hdpi == k2.hdpi && k1.vdpi == k2.vdpi &&
+         k1.shape == k2.shape && k1.series == k2.series &&
+         k1.variant == k2.variant && k1.family == k2.family;
+}
+
+bool
+operator!= (const font_key& k1, const font_key& k2) {
+  return !(k1 == k2);
+}
+
+int
+hash (const font_key& k) {
+  int h= hash (k.family);
+  h= (h << 5) + (h >> 27) + hash (k.variant);
+  h= (h << 5) + (h >> 27) + hash (k.series);
+  h= (h << 5) + (h >> 27) + hash (k.shape);
+  return h ^ (((int) (2.0 * k.sz)) << 16) ^ (k.hdpi << 4) ^ k.vdpi;
+}
+
 /******************************************************************************
  * User interface
  ******************************************************************************/
 
-font
-find_font (string family, string variant, string series, string shape,
-           double sz, int dpi) {
+static hashmap<font_key, pointer> font_found (NULL);
+
+static font
+find_font_bis (string family, string variant, string series, string shape,
+               double sz, int dpi) {
   // 浮点尺寸字符串处理：整数如"10"，0.5倍数如"10.5"
   string sz_str;
   if (sz == round (sz)) sz_str= as_string ((int) sz); // 整数
@@ -322,3 +349,15 @@ find_font (string family, string variant, string series, string shape,
   font::instances (s)= (pointer) fn.rep;
   return fn;
 }
+
+font
+find_font (string family, string variant, string series, string shape,
+           double sz, int dpi) {
+  // avoid building the name of the font for fonts which were found before
+  font_key key (family, variant, series, shape, sz, dpi, dpi);
+  pointer  ptr= font_found[key];
+  if (ptr != NULL) return font ((font_rep*) ptr);
+  font fn= find_font_bis (family, variant, series, shape, sz, dpi);
+  if (!is_nil (fn)) font_found (key)= (pointer) fn.rep;
+  return fn;
+}
@@ -49,6 +49,30 @@ struct font_glyphs;
 #define WESTERN_PROTRUSION 32
 #define TABLE_CELL 64
 
+/******************************************************************************
+ * Structured keys for looking up fonts
+ ******************************************************************************/
+
+struct font_key {
+  string family;
+  string variant;
+  string series;
+  string shape;
+  double sz;
+  int    hdpi;
+  int    vdpi;
+
+  inline font_key () : sz (0.0), hdpi (0), vdpi (0) {}
+  inline font_key (string fam, string var, string ser, string sh, double sz2,
+                   int hdpi2, int vdpi2)
+      : family (fam), variant (var), series (ser), shape (sh), sz (sz2),
+        hdpi (hdpi2), vdpi (vdpi2) {}
+};
+
+bool operator== (const font_key& k1, const font_key& k2);
+bool operator!= (const font_key& k1, const font_key& k2);
+int  hash (const font_key& k);
+
 /******************************************************************************
  * The font structure
  ******************************************************************************/
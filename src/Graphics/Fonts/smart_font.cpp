@@ -823,13 +823,15 @@ smart_font_rep::advance (string s, int& pos, string& r, int& nr) {
         else break;
       }
       else {
-        int end= pos;
-        tm_char_forwards (s, end);
-        string current_c= s (pos, end);
-
-        int fn_index= cht[current_c];
+        int end     = pos;
+        int code    = unicode_char_code (s, pos, end);
+        int fn_index= -1;
+        if (code >= 0) fn_index= sm->get_unicode (code);
+        else tm_char_forwards (s, end);
         if (fn_index == -1) {
-          fn_index= resolve (current_c);
+          string current_c= s (pos, end);
+          fn_index        = cht[current_c];
+          if (fn_index == -1) fn_index= resolve (current_c);
         }
 
         if (count == 1 && nr != -1 && fn_index == nr) {
@@ -1781,10 +1783,9 @@ smart_font_bis (string family, string variant, string series, string shape,
                                        series, shape, sz, hdpi, vdpi));
 }
 
-font
-smart_font (string family, string variant, string series, string shape,
-            double sz, int dpi) {
-  sz= normalize_half_multiple_size (sz);
+static font
+smart_font_variant (string family, string variant, string series, string shape,
+                    double sz, int dpi) {
   if (variant == "rm")
     return smart_font_bis (family, variant, series, shape, sz, dpi, dpi);
   array<string> lfn1= logical_font (family, "rm", series, shape);
@@ -1801,6 +1802,20 @@ smart_font (string family, string variant, string series, string shape,
   return fn2->magnify (zoom);
 }
 
+static hashmap<font_key, pointer> smart_found (NULL);
+
+font
+smart_font (string family, string variant, string series, string shape,
+            double sz, int dpi) {
+  sz= normalize_half_multiple_size (sz);
+  font_key key (family, variant, series, shape, sz, dpi, dpi);
+  pointer  ptr= smart_found[key];
+  if (ptr != NULL) return font ((font_rep*) ptr);
+  font fn= smart_font_variant (family, variant, series, shape, sz, dpi);
+  if (!is_nil (fn)) smart_found (key)= (pointer) fn.rep;
+  return fn;
+}
+
 font
 math_smart_font (string family, string variant, string series, string shape,
                  string tfam, string tvar, string tser, string tsh, double sz,
@@ -37,8 +37,31 @@ RESOURCE (smart_map);
 #define REWRITE_ITALIC 10
 #define REWRITE_IGNORE 11
 
+#define UNICODE_PAGE_BITS 8
+#define UNICODE_PAGE_SIZE (1 << UNICODE_PAGE_BITS)
+#define UNICODE_PAGES (0x110000 >> UNICODE_PAGE_BITS)
+
+inline int
+unicode_char_code (string s, int pos, int& end) {
+  // Code point of a character <#XXXX> at pos, written in canonical form,
+  // i.e. with uppercase hexadecimal digits and without leading zeros.
+  // Other characters are encoded in several ways and yield -1.
+  int n= N (s), i= pos + 2, code= 0;
+  if (i >= n || s[pos] != '<' || s[pos + 1] != '#' || s[i] == '0') return -1;
+  for (; i < n && i < pos + 8 && s[i] != '>'; i++) {
+    char c= s[i];
+    if (c >= '0' && c <= '9') code= (code << 4) + (c - '0');
+    else if (c >= 'A' && c <= 'F') code= (code << 4) + (c - 'A' + 10);
+    else return -1;
+  }
+  if (i == pos + 2 || i >= n || s[i] != '>' || code >= 0x110000) return -1;
+  end= i + 1;
+  return code;
+}
+
 struct smart_map_rep : rep<smart_map> {
   int                  chv[256];
+  int**                chu; // pages of subfonts for <#XXXX> characters
   hashmap<string, int> cht;
   hashmap<tree, int>   fn_nr;
   array<tree>          fn_spec;
@@ -46,7 +69,8 @@ struct smart_map_rep : rep<smart_map> {
 
 public:
   smart_map_rep (string name, tree fn)
-      : rep<smart_map> (name), cht (-1), fn_nr (-1), fn_spec (2), fn_rewr (2) {
+      : rep<smart_map> (name), chu (NULL), cht (-1), fn_nr (-1), fn_spec (2),
+        fn_rewr (2) {
     (void) fn;
     for (int i= 0; i < 256; i++)
       chv[i]= -1;
@@ -58,6 +82,35 @@ public:
     fn_rewr[SUBFONT_ERROR] = REWRITE_NONE;
   }
 
+  ~smart_map_rep () {
+    if (chu == NULL) return;
+    for (int i= 0; i < UNICODE_PAGES; i++)
+      if (chu[i] != NULL) tm_delete_array (chu[i]);
+    tm_delete_array (chu);
+  }
+
+  inline int get_unicode (int code) {
+    if (chu == NULL) return -1;
+    int* page= chu[code >> UNICODE_PAGE_BITS];
+    if (page == NULL) return -1;
+    return page[code & (UNICODE_PAGE_SIZE - 1)];
+  }
+
+  void set_unicode (int code, int nr) {
+    if (chu == NULL) {
+      chu= tm_new_array<int*> (UNICODE_PAGES);
+      for (int i= 0; i < UNICODE_PAGES; i++)
+        chu[i]= NULL;
+    }
+    int*& page= chu[code >> UNICODE_PAGE_BITS];
+    if (page == NULL) {
+      page= tm_new_array<int> (UNICODE_PAGE_SIZE);
+      for (int i= 0; i < UNICODE_PAGE_SIZE; i++)
+        page[i]= -1;
+    }
+    page[code & (UNICODE_PAGE_SIZE - 1)]= nr;
+  }
+
   int add_font (tree fn, int rewr) {
     if (!fn_nr->contains (fn)) {
       int sz    = N (fn_spec);
@@ -76,6 +129,9 @@ public:
     if (starts (c, "<")) {
       if (!cht->contains (c)) cht (c)= nr;
       else cht (c)= min (nr, cht[c]);
+      int end = 0;
+      int code= unicode_char_code (c, 0, end);
+      if (code >= 0 && end == N (c)) set_unicode (code, cht[c]);
     }
     else {
       int code= (int) (unsigned char) c[0];
@@ -18,6 +18,16 @@ extern array<array<double>> learned_cont1;
 extern array<array<tree>>   learned_disc2;
 extern array<array<double>> learned_cont2;
 
+struct learned_bucket {
+  array<int>    nrs;  // learned glyphs with the same discrete invariants
+  array<double> cont; // their continuous invariants, one after the other
+};
+
+extern hashmap<tree, learned_bucket> learned_index1;
+extern hashmap<tree, learned_bucket> learned_index2;
+
+tree learned_key (array<tree> disc, array<double> cont);
+
 void   register_glyph (string name, contours gl);
 string recognize_glyph (contours gl);
 
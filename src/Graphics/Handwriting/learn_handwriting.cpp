@@ -10,6 +10,9 @@
  ******************************************************************************/
 
 #include "handwriting.hpp"
+#include <moebius/tree_label.hpp>
+
+using namespace moebius;
 
 /******************************************************************************
  * Learning glyphs
@@ -22,6 +25,31 @@ array<array<double>> learned_cont1;
 array<array<tree>>   learned_disc2;
 array<array<double>> learned_cont2;
 
+hashmap<tree, learned_bucket> learned_index1;
+hashmap<tree, learned_bucket> learned_index2;
+
+tree
+learned_key (array<tree> disc, array<double> cont) {
+  // glyphs can only be compared if their invariants have the same shape
+  int  n= N (disc);
+  tree key (TUPLE, n + 1);
+  for (int i= 0; i < n; i++)
+    key[i]= disc[i];
+  key[n]= as_string (N (cont));
+  return key;
+}
+
+static void
+learn_invariants (hashmap<tree, learned_bucket>& index, int nr,
+                  array<tree> disc, array<double> cont) {
+  tree key= learned_key (disc, cont);
+  // new buckets should not share the arrays of the default value
+  if (!index->contains (key)) index (key)= learned_bucket ();
+  learned_bucket& b= index (key);
+  b.nrs << nr;
+  b.cont << cont;
+}
+
 void
 register_glyph (string name, contours gl) {
   array<tree>   disc1;
@@ -36,5 +64,7 @@ register_glyph (string name, contours gl) {
   learned_cont1 << cont1;
   learned_disc2 << disc2;
   learned_cont2 << cont2;
+  learn_invariants (learned_index1, N (learned_names) - 1, disc1, cont1);
+  learn_invariants (learned_index2, N (learned_names) - 1, disc2, cont2);
   // cout << "Added " << name << ", " << disc1 << "\n";
 }
@@ -15,29 +15,46 @@
  * Recognize one glyph
  ******************************************************************************/
 
+static void
+recognize_invariants (hashmap<tree, learned_bucket>& index, array<tree> disc,
+                      array<double> cont, string& best, double& best_rec) {
+  // only glyphs with the same discrete invariants are candidates
+  tree key= learned_key (disc, cont);
+  if (!index->contains (key)) return;
+  learned_bucket b       = index[key];
+  int            n       = N (cont), m= N (b.nrs);
+  double*        c       = A (cont);
+  double*        all     = A (b.cont);
+  double         best_sum= -1.0;
+  for (int i= 0; i < m; i++) {
+    // stop as soon as the squared distance exceeds the one of the best glyph
+    double* g= all + i * n;
+    double  s= 0.0;
+    int     k= 0;
+    while (k < n && (best_sum < 0.0 || s <= best_sum)) {
+      int end= min (k + 16, n);
+      for (; k < end; k++)
+        s+= (g[k] - c[k]) * (g[k] - c[k]);
+    }
+    if (k < n) continue;
+    double rec= 1.0 - sqrt (s) / sqrt (n);
+    if (rec > best_rec) {
+      best_rec= rec;
+      best_sum= s;
+      best    = learned_names[b.nrs[i]];
+    }
+    // cout << learned_names[b.nrs[i]] << ": " << 100.0 * rec << "%\n";
+  }
+}
+
 void
 recognize_glyph_one (contours gl, int& level, string& best, double& best_rec) {
+  best    = "";
+  best_rec= -100.0;
   array<tree>   disc1;
   array<double> cont1;
   invariants (gl, 1, disc1, cont1);
-  array<tree>   disc2;
-  array<double> cont2;
-  invariants (gl, 2, disc2, cont2);
-
-  best    = "";
-  best_rec= -100.0;
-  for (int i= 0; i < N (learned_names); i++)
-    if (N (learned_glyphs[i]) == N (gl) && disc1 == learned_disc1[i]) {
-      string        name= learned_names[i];
-      array<double> cont= learned_cont1[i];
-      double        dist= l2_norm (cont - cont1) / sqrt (N (cont1));
-      double        rec = 1.0 - dist;
-      if (rec > best_rec) {
-        best_rec= rec;
-        best    = name;
-      }
-      // cout << name << ": " << 100.0 * rec << "%\n";
-    }
+  recognize_invariants (learned_index1, disc1, cont1, best, best_rec);
   if (best != "") {
     // cout << "disc= " << disc1 << "\n";
     // cout << "cont= " << cont1 << "\n";
@@ -45,18 +62,10 @@ recognize_glyph_one (contours gl, int& level, string& best, double& best_rec) {
     return;
   }
 
-  for (int i= 0; i < N (learned_names); i++)
-    if (N (learned_glyphs[i]) == N (gl) && disc2 == learned_disc2[i]) {
-      string        name= learned_names[i];
-      array<double> cont= learned_cont2[i];
-      double        dist= l2_norm (cont - cont2) / sqrt (N (cont2));
-      double        rec = 1.0 - dist;
-      if (rec > best_rec) {
-        best_rec= rec;
-        best    = name;
-      }
-      // cout << name << ": " << 100.0 * rec << "%\n";
-    }
+  array<tree>   disc2;
+  array<double> cont2;
+  invariants (gl, 2, disc2, cont2);
+  recognize_invariants (learned_index2, disc2, cont2, best, best_rec);
   level= 2;
 }
 
@@ -14,6 +14,10 @@
 #include "raster_operators.hpp"
 #include "unary_function.hpp"
 
+#ifndef OS_WASM
+#include <thread>
+#endif
+
 /******************************************************************************
  * Raster class
  ******************************************************************************/
@@ -91,6 +95,43 @@ print (raster<C> r) {
       cout << x << ", " << y << " -> " << r->a[y * r->w + x] << "\n";
 }
 
+/******************************************************************************
+ * Processing rows in parallel
+ ******************************************************************************/
+
+#define RASTER_PARALLEL_WORK (1 << 20)
+#define RASTER_MAX_THREADS 16
+
+template <typename F>
+void
+parallel_rows (int h, double work, F fun) {
+  // Call fun (y1, y2) on disjoint bands of rows which together cover [0, h).
+  // Bands are only spread over several threads if the estimated number of
+  // elementary operations is large enough to amortize their creation.
+  int nr= 1;
+#ifndef OS_WASM
+  if (work >= RASTER_PARALLEL_WORK) {
+    nr= (int) std::thread::hardware_concurrency ();
+    nr= min (min (nr, RASTER_MAX_THREADS), h);
+  }
+#else
+  (void) work;
+#endif
+  if (nr <= 1) {
+    fun (0, h);
+    return;
+  }
+#ifndef OS_WASM
+  std::thread* ts= tm_new_array<std::thread> (nr - 1);
+  for (int i= 1; i < nr; i++)
+    ts[i - 1]= std::thread (fun, (i * h) / nr, ((i + 1) * h) / nr);
+  fun (0, h / nr);
+  for (int i= 1; i < nr; i++)
+    ts[i - 1].join ();
+  tm_delete_array (ts);
+#endif
+}
+
 /******************************************************************************
  * Simple operations
  ******************************************************************************/
@@ -593,13 +634,18 @@ template <typename C, typename F>
 raster<C>
 inverse_transform (raster<C> r, F fun, int w, int h, int ox, int oy) {
   raster<C> ret (w, h, ox, oy);
-  for (int y= 0; y < h; y++)
-    for (int x= 0; x < w; x++) {
-      double xx= x - ox + 0.5;
-      double yy= y - oy + 0.5;
-      fun.transform (xx, yy);
-      ret->a[w * y + x]= r->smooth_pixel (xx, yy);
-    }
+  C*        a   = ret->a;
+  auto      rows= [&] (int y1, int y2) {
+    F f= fun;
+    for (int y= y1; y < y2; y++)
+      for (int x= 0; x < w; x++) {
+        double xx= x - ox + 0.5;
+        double yy= y - oy + 0.5;
+        f.transform (xx, yy);
+        a[w * y + x]= r->smooth_pixel (xx, yy);
+      }
+  };
+  parallel_rows (h, 16.0 * w * h, rows);
   return ret;
 }
 
@@ -862,6 +908,22 @@ gaussian_pen (double rx, double ry, double phi, double order= 2.5) {
  * Convolution and blur
  ******************************************************************************/
 
+template <typename S>
+void
+pen_support (raster<S> pen, int* lo, int* hi) {
+  // For each row y of the pen, set [lo[y], hi[y]) to the smallest range
+  // of columns outside which the pen vanishes
+  int w= pen->w, h= pen->h;
+  for (int y= 0; y < h; y++) {
+    S*  p= pen->a + y * w;
+    int a= 0, b= w;
+    while (a < b && p[a] == 0) a++;
+    while (b > a && p[b - 1] == 0) b--;
+    lo[y]= a;
+    hi[y]= b;
+  }
+}
+
 template <typename C, typename S>
 raster<C>
 convolute (raster<C> s1, raster<S> s2) {
@@ -872,13 +934,33 @@ convolute (raster<C> s1, raster<S> s2) {
   raster<C> d (dw, dh, s1->ox + s2->ox, s1->oy + s2->oy);
   clear (d);
   raster<C> temp= mul_alpha (s1);
-  for (int y1= 0; y1 < s1h; y1++)
-    for (int y2= 0; y2 < s2h; y2++) {
-      int o1= y1 * s1w, o2= y2 * s2w, o= (y1 + y2) * dw;
-      for (int x1= 0; x1 < s1w; x1++)
-        for (int x2= 0; x2 < s2w; x2++)
-          d->a[o + x1 + x2]+= temp->a[o1 + x1] * s2->a[o2 + x2];
+  int*      lo  = tm_new_array<int> (s2h);
+  int*      hi  = tm_new_array<int> (s2h);
+  pen_support (s2, lo, hi);
+  // Each destination row only depends on source rows, so that bands of
+  // destination rows can be computed independently.  Transparent source
+  // pixels and the zero borders of the pen do not contribute.
+  auto rows= [&] (int ya, int yb) {
+    for (int y= ya; y < yb; y++) {
+      int y1a= max (0, y - s2h + 1), y1b= min (s1h, y + 1);
+      for (int y1= y1a; y1 < y1b; y1++) {
+        int y2= y - y1, x2a= lo[y2], x2b= hi[y2];
+        if (x2a >= x2b) continue;
+        C* p1= temp->a + y1 * s1w;
+        S* p2= s2->a + y2 * s2w;
+        C* o = d->a + y * dw;
+        for (int x1= 0; x1 < s1w; x1++) {
+          if (get_alpha (p1[x1]) == 0) continue;
+          C c= p1[x1];
+          for (int x2= x2a; x2 < x2b; x2++)
+            o[x1 + x2]+= c * p2[x2];
+        }
+      }
     }
+  };
+  parallel_rows (dh, ((double) s1w * s1h) * s2w * s2h, rows);
+  tm_delete_array (lo);
+  tm_delete_array (hi);
   return div_alpha (d);
 }
 
@@ -923,20 +1005,34 @@ factored_convolute (raster<C> s1, raster<S> s2) {
   raster<C> temp= mul_alpha (s1);
   raster<C> aux (dw, s1h, s1->ox + s2->ox, s1->oy);
   clear (aux);
-  for (int y1= 0; y1 < s1h; y1++) {
-    int o1= y1 * s1w, o= y1 * dw;
-    for (int x1= 0; x1 < s1w; x1++)
-      for (int x2= 0; x2 < s2w; x2++)
-        aux->a[o + x1 + x2]+= temp->a[o1 + x1] * xs->a[x2];
-  }
+  auto hrows= [&] (int ya, int yb) {
+    for (int y1= ya; y1 < yb; y1++) {
+      C* p1= temp->a + y1 * s1w;
+      C* o = aux->a + y1 * dw;
+      for (int x1= 0; x1 < s1w; x1++) {
+        if (get_alpha (p1[x1]) == 0) continue;
+        C c= p1[x1];
+        for (int x2= 0; x2 < s2w; x2++)
+          o[x1 + x2]+= c * xs->a[x2];
+      }
+    }
+  };
+  parallel_rows (s1h, ((double) s1w * s1h) * s2w, hrows);
   raster<C> d (dw, dh, s1->ox + s2->ox, s1->oy + s2->oy);
   clear (d);
-  for (int y1= 0; y1 < s1h; y1++)
-    for (int y2= 0; y2 < s2h; y2++) {
-      int o1= y1 * dw, o= (y1 + y2) * dw;
-      for (int x1= 0; x1 < dw; x1++)
-        d->a[o + x1]+= aux->a[o1 + x1] * ys->a[y2];
+  auto vrows= [&] (int ya, int yb) {
+    for (int y= ya; y < yb; y++) {
+      int y1a= max (0, y - s2h + 1), y1b= min (s1h, y + 1);
+      C*  o  = d->a + y * dw;
+      for (int y1= y1a; y1 < y1b; y1++) {
+        C* p1= aux->a + y1 * dw;
+        S  f = ys->a[y - y1];
+        for (int x1= 0; x1 < dw; x1++)
+          o[x1]+= p1[x1] * f;
+      }
     }
+  };
+  parallel_rows (dh, ((double) dw * s1h) * s2h, vrows);
   return div_alpha (d);
 }
 
@@ -983,14 +1079,32 @@ thicken (raster<C> s1, raster<S> s2) {
   int       s1w= s1->w, s1h= s1->h, s2w= s2->w, s2h= s2->h, dw= d->w;
   raster<F> temp= get_alpha (s1);
   clear_alpha (d);
-  for (int y1= 0; y1 < s1h; y1++)
-    for (int y2= 0; y2 < s2h; y2++) {
-      int o1= y1 * s1w, o2= y2 * s2w, o= (y1 + y2) * dw;
-      for (int x1= 0; x1 < s1w; x1++)
-        for (int x2= 0; x2 < s2w; x2++)
-          src_over (get_alpha (d->a[o + x1 + x2]),
-                    temp->a[o1 + x1] * s2->a[o2 + x2]);
+  int* lo= tm_new_array<int> (s2h);
+  int* hi= tm_new_array<int> (s2h);
+  pen_support (s2, lo, hi);
+  // Same traversal as for convolute, which preserves the order in which
+  // the contributions are composed onto each destination pixel
+  auto rows= [&] (int ya, int yb) {
+    for (int y= ya; y < yb; y++) {
+      int y1a= max (0, y - s2h + 1), y1b= min (s1h, y + 1);
+      for (int y1= y1a; y1 < y1b; y1++) {
+        int y2= y - y1, x2a= lo[y2], x2b= hi[y2];
+        if (x2a >= x2b) continue;
+        F* p1= temp->a + y1 * s1w;
+        S* p2= s2->a + y2 * s2w;
+        C* o = d->a + y * dw;
+        for (int x1= 0; x1 < s1w; x1++) {
+          if (p1[x1] == 0) continue;
+          F c= p1[x1];
+          for (int x2= x2a; x2 < x2b; x2++)
+            src_over (get_alpha (o[x1 + x2]), c * p2[x2]);
+        }
+      }
     }
+  };
+  parallel_rows (d->h, ((double) s1w * s1h) * s2w * s2h, rows);
+  tm_delete_array (lo);
+  tm_delete_array (hi);
   return d;
 }
 
@@ -1019,6 +1133,17 @@ erode (C& dest_a, const C& src_a, const C& pen_a) {
   dest_a= min (dest_a, a);
 }
 
+template <typename F>
+inline F
+window_min (F* g, F* h, int n, int l, int s, int e) {
+  // Minimum over the intersection of [s, e] with [0, n), where e - s < l,
+  // using the prefix and suffix minima g and h inside blocks of length l
+  if (s <= 0 && e >= n - 1) return g[n - 1];
+  if (s <= 0) return g[e];
+  if (e >= n - 1) return (s / l == (n - 1) / l ? h[s] : min (h[s], g[n - 1]));
+  return (s % l == 0 ? g[e] : min (h[s], g[e]));
+}
+
 template <typename C, typename S>
 raster<C>
 erode (raster<C> s1, raster<S> s2) {
@@ -1027,21 +1152,59 @@ erode (raster<C> s1, raster<S> s2) {
   ASSERT (s2->w * s2->h != 0, "empty pen");
   raster<C> d= copy (s1);
   int s1w= s1->w, s1h= s1->h, s2w= s2->w, s2h= s2->h, dw= d->w; //, dh= d->h;
+  int ox= s2->ox, oy= s2->oy;
   raster<F> temp= get_alpha (s1);
   // for (int i=0; i<dw*dh; i++)
   //   get_alpha (d->a[i])= F (1.0);
-  for (int y1= 0; y1 < s1h; y1++)
-    for (int y2= 0; y2 < s2h; y2++) {
-      int yd= y1 + y2 - s2->oy;
-      if (yd < 0 || yd >= s1h) continue;
-      int o1= y1 * s1w, o2= y2 * s2w, o= yd * dw;
-      for (int x1= 0; x1 < s1w; x1++)
-        for (int x2= 0; x2 < s2w; x2++) {
-          int xd= x1 + x2 - s2->ox;
-          if (xd < 0 || xd >= s1w) continue;
-          erode (get_alpha (d->a[o + xd]), temp->a[o1 + x1], s2->a[o2 + x2]);
+  // Vanishing pen entries may be ignored as long as all alphas are at most
+  // one.  Runs of full pen entries amount to a minimum over a sliding window
+  // of the source row, which is computed in constant time per pixel using
+  // the van Herk-Gil-Werman algorithm.
+  bool skip_zero= true;
+  for (int i= 0; i < s1w * s1h; i++)
+    if (temp->a[i] > F (1.0)) skip_zero= false;
+  auto rows= [&] (int ya, int yb) {
+    F* g= tm_new_array<F> (s1w);
+    F* h= tm_new_array<F> (s1w);
+    for (int yd= ya; yd < yb; yd++) {
+      C* o= d->a + yd * dw;
+      for (int y2= 0; y2 < s2h; y2++) {
+        int y1= yd - y2 + oy;
+        if (y1 < 0 || y1 >= s1h) continue;
+        F* p1= temp->a + y1 * s1w;
+        S* p2= s2->a + y2 * s2w;
+        int x2= 0;
+        while (x2 < s2w) {
+          int b= x2;
+          while (b < s2w && p2[b] == 1) b++;
+          if (b - x2 >= 3) {
+            int l= b - x2;
+            for (int x1= 0; x1 < s1w; x1++)
+              g[x1]= (x1 % l == 0 ? p1[x1] : min (g[x1 - 1], p1[x1]));
+            for (int x1= s1w - 1; x1 >= 0; x1--)
+              if (x1 == s1w - 1 || (x1 + 1) % l == 0) h[x1]= p1[x1];
+              else h[x1]= min (h[x1 + 1], p1[x1]);
+            int xa= max (0, x2 - ox), xb= min (s1w, s1w + b - 1 - ox);
+            for (int xd= xa; xd < xb; xd++) {
+              F m= window_min (g, h, s1w, l, xd + ox - b + 1, xd + ox - x2);
+              get_alpha (o[xd])= min (get_alpha (o[xd]), m);
+            }
+            x2= b;
+            continue;
+          }
+          if (p2[x2] != 0 || !skip_zero) {
+            int xa= max (0, ox - x2), xb= min (s1w, s1w + ox - x2);
+            for (int x1= xa; x1 < xb; x1++)
+              erode (get_alpha (o[x1 + x2 - ox]), p1[x1], p2[x2]);
+          }
+          x2++;
         }
+      }
     }
+    tm_delete_array (g);
+    tm_delete_array (h);
+  };
+  parallel_rows (s1h, ((double) s1w * s1h) * s2w * s2h, rows);
   return d;
 }
 
@@ -1059,20 +1222,24 @@ variation (raster<C> s1, raster<S> s2) {
   int       s2w= s2->w, s2h= s2->h, dw= d->w, dh= d->h;
   int       s2ox= s2->ox, s2oy= s2->oy;
   raster<F> temp= get_alpha (s1);
-  for (int y0= 0; y0 < dh; y0++)
-    for (int x0= 0; x0 < dw; x0++) {
-      int x1= x0 - s2ox, y1= y0 - s2oy;
-      F   ref  = temp->internal_get_pixel (x1, y1);
-      F   min_v= 0, max_v= 0;
-      for (int y2= 0; y2 < s2h; y2++)
-        for (int x2= 0; x2 < s2w; x2++) {
-          F cur= temp->internal_get_pixel (x1 - (x2 - s2ox), y1 - (y2 - s2oy));
-          F v  = (cur - ref) * s2->a[y2 * s2w + x2];
-          max_v= max (max_v, v);
-          min_v= min (min_v, v);
-        }
-      get_alpha (d->a[y0 * dw + x0])= max_v - min_v;
-    }
+  auto      rows= [&] (int ya, int yb) {
+    for (int y0= ya; y0 < yb; y0++)
+      for (int x0= 0; x0 < dw; x0++) {
+        int x1= x0 - s2ox, y1= y0 - s2oy;
+        F   ref  = temp->internal_get_pixel (x1, y1);
+        F   min_v= 0, max_v= 0;
+        for (int y2= 0; y2 < s2h; y2++)
+          for (int x2= 0; x2 < s2w; x2++) {
+            F cur=
+                temp->internal_get_pixel (x1 - (x2 - s2ox), y1 - (y2 - s2oy));
+            F v  = (cur - ref) * s2->a[y2 * s2w + x2];
+            max_v= max (max_v, v);
+            min_v= min (min_v, v);
+          }
+        get_alpha (d->a[y0 * dw + x0])= max_v - min_v;
+      }
+  };
+  parallel_rows (dh, ((double) dw * dh) * s2w * s2h, rows);
   return d;
 }
 
@@ -41,6 +41,11 @@ div_alpha (const C& x) {
 }
 template <typename C>
 inline C
+get_alpha (const C& x) {
+  return x;
+}
+template <typename C>
+inline C
 alpha_distance (const C& x, const C& y) {
   return 2.0 * fabs (y - x);
 }
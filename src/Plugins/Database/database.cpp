@@ -0,0 +1,704 @@
+
+/******************************************************************************
+ * MODULE     : database.cpp
+ * DESCRIPTION: indexed storage of TeXmacs databases
+ * COPYRIGHT  : (C) 2026  Darcy Shen
+ *******************************************************************************
+ * This software falls under the GNU general public license version 3 or later.
+ * It comes WITHOUT ANY WARRANTY WHATSOEVER. For details, see the file LICENSE
+ * in the root directory or <http://www.gnu.org/licenses/gpl-3.0.html>.
+ ******************************************************************************/
+
+#include "database.hpp"
+#include "analyze.hpp"
+#include "file.hpp"
+#include "merge_sort.hpp"
+#include "tm_debug.hpp"
+#include "tm_url.hpp"
+#include "tree_helper.hpp"
+
+#include <moebius/data/scheme.hpp>
+#include <string.h>
+
+using namespace moebius;
+using moebius::data::scm_quote;
+using moebius::data::scm_unquote;
+
+#define DB_MAGIC "TMD1"
+
+/******************************************************************************
+ * Prefix tries
+ ******************************************************************************/
+
+db_trie::db_trie () {
+  first << -1;
+  next << -1;
+  key << '\0';
+  data << -1;
+}
+
+int
+db_trie::step (int node, char c, bool create) {
+  int child= first[node];
+  while (child >= 0 && key[child] != c)
+    child= next[child];
+  if (child < 0 && create) {
+    child= N (key);
+    first << -1;
+    next << first[node];
+    key << c;
+    data << -1;
+    first[node]= child;
+  }
+  return child;
+}
+
+int
+db_trie::find (string s, bool create) {
+  int node= 0;
+  for (int i= 0; i < N (s) && node >= 0; i++)
+    node= step (node, s[i], create);
+  return node;
+}
+
+void
+db_trie::collect (int node, array<int>& r) {
+  array<int> todo;
+  todo << node;
+  while (N (todo) > 0) {
+    int n= todo[N (todo) - 1];
+    todo->resize (N (todo) - 1);
+    if (data[n] >= 0) r << data[n];
+    for (int c= first[n]; c >= 0; c= next[c])
+      todo << c;
+  }
+}
+
+/******************************************************************************
+ * Words in values
+ ******************************************************************************/
+
+static inline bool
+is_word_char (char c) {
+  return is_alpha (c) || is_digit (c) || ((unsigned char) c) >= 128;
+}
+
+array<string>
+db_words (string s) {
+  array<string> r;
+  int           i= 0, n= N (s);
+  while (i < n) {
+    while (i < n && !is_word_char (s[i]))
+      i++;
+    int start= i;
+    while (i < n && is_word_char (s[i]))
+      i++;
+    if (i > start) r << locase_all (s (start, i));
+  }
+  return r;
+}
+
+/******************************************************************************
+ * Encoding of records
+ ******************************************************************************/
+
+static void
+put_number (string& s, unsigned long long n) {
+  while (n >= 128) {
+    s << (char) ((n & 127) | 128);
+    n>>= 7;
+  }
+  s << (char) n;
+}
+
+static void
+put_string (string& s, string r) {
+  put_number (s, N (r));
+  s << r;
+}
+
+static void
+put_time (string& s, double t) {
+  if (t >= DB_MAX_TIME) put_number (s, 0);
+  else if (t >= 0 && t < 1.0e15 && t == (double) ((long long) t))
+    put_number (s, ((unsigned long long) t) + 2);
+  else {
+    unsigned long long b;
+    memcpy (&b, &t, sizeof (double));
+    put_number (s, 1);
+    for (int i= 0; i < 8; i++)
+      s << (char) ((b >> (8 * i)) & 255);
+  }
+}
+
+static bool
+get_number (string s, int& pos, int end, unsigned long long& n) {
+  n= 0;
+  for (int shift= 0; pos < end && shift < 64; shift+= 7) {
+    unsigned char c= (unsigned char) s[pos++];
+    n|= ((unsigned long long) (c & 127)) << shift;
+    if (c < 128) return true;
+  }
+  return false;
+}
+
+static bool
+get_index (string s, int& pos, int end, int bound, int& i) {
+  unsigned long long n;
+  if (!get_number (s, pos, end, n) || n >= (unsigned long long) bound)
+    return false;
+  i= (int) n;
+  return true;
+}
+
+static bool
+get_time (string s, int& pos, int end, double& t) {
+  unsigned long long n;
+  if (!get_number (s, pos, end, n)) return false;
+  if (n == 0) t= DB_MAX_TIME;
+  else if (n >= 2) t= (double) (n - 2);
+  else {
+    if (end - pos < 8) return false;
+    unsigned long long b= 0;
+    for (int i= 0; i < 8; i++)
+      b|= ((unsigned long long) (unsigned char) s[pos++]) << (8 * i);
+    memcpy (&t, &b, sizeof (double));
+  }
+  return true;
+}
+
+static void
+put_line_record (string& rec, int id, int attr, int val, double created,
+                 double expires) {
+  string r= "L";
+  put_number (r, id);
+  put_number (r, attr);
+  put_number (r, val);
+  put_time (r, created);
+  put_time (r, expires);
+  put_string (rec, r);
+}
+
+static void
+put_expire_record (string& rec, int l, double t) {
+  string r= "E";
+  put_number (r, l);
+  put_time (r, t);
+  put_string (rec, r);
+}
+
+static void
+put_drop_record (string& rec, int l) {
+  string r= "D";
+  put_number (r, l);
+  put_string (rec, r);
+}
+
+/******************************************************************************
+ * Atoms and lines
+ ******************************************************************************/
+
+database_rep::database_rep (url file2)
+    : file (file2), history (true), atom_nr (-1), dropped (0) {}
+
+database::database (url file) : rep (tm_new<database_rep> (file)) {}
+
+int
+database_rep::find_atom (string s) {
+  return atom_nr[s];
+}
+
+int
+database_rep::make_atom (string s, string& rec) {
+  int nr= atom_nr[s];
+  if (nr >= 0) return nr;
+  nr= N (atoms);
+  atoms << s;
+  atom_nr (s)= nr;
+  put_string (rec, "A" * s);
+  return nr;
+}
+
+static void
+add_to (hashmap<int, array<int>>& h, int k, int l) {
+  if (!h->contains (k)) h (k)= array<int> ();
+  h (k) << l;
+}
+
+int
+database_rep::add_line (int id, int attr, int val, double created,
+                        double expires) {
+  int l= N (line_id);
+  line_id << id;
+  line_attr << attr;
+  line_val << val;
+  line_created << created;
+  line_expires << expires;
+  add_to (id_lines, id, l);
+  add_to (val_lines, val, l);
+  index_words (l);
+  if (atoms[attr] == "name") {
+    int node            = name_trie.find (atoms[val], true);
+    name_trie.data[node]= val;
+  }
+  return l;
+}
+
+void
+database_rep::index_words (int l) {
+  // same words as db_words, but without building intermediate strings
+  string s= atoms[line_val[l]];
+  int    i= 0, n= N (s);
+  while (i < n) {
+    while (i < n && !is_word_char (s[i]))
+      i++;
+    if (i == n) break;
+    int start= i, node= 0;
+    while (i < n && is_word_char (s[i]))
+      node= word_trie.step (node, locase (s[i++]), true);
+    if (word_trie.data[node] < 0) {
+      word_trie.data[node]= N (words);
+      words << locase_all (s (start, i));
+      word_lines << array<int> ();
+    }
+    array<int>& ls= word_lines[word_trie.data[node]];
+    if (N (ls) == 0 || ls[N (ls) - 1] != l) ls << l;
+  }
+}
+
+void
+database_rep::expire_line (int l, double t) {
+  line_expires[l]= t;
+}
+
+void
+database_rep::drop_line (int l) {
+  array<int> a= id_lines[line_id[l]];
+  array<int> r;
+  for (int i= 0; i < N (a); i++)
+    if (a[i] != l) r << a[i];
+  id_lines (line_id[l])= r;
+  line_id[l]           = -1;
+  dropped++;
+}
+
+bool
+database_rep::valid (int l, double t) {
+  if (line_id[l] < 0) return false;
+  return t == 0 || (line_created[l] <= t && t < line_expires[l]);
+}
+
+bool
+database_rep::alive (int l) {
+  return line_id[l] >= 0 && line_expires[l] >= DB_MAX_TIME;
+}
+
+void
+database_rep::remove_line (int l, double t, string& rec) {
+  if (history && t > 0) {
+    expire_line (l, t);
+    put_expire_record (rec, l, t);
+  }
+  else {
+    drop_line (l);
+    put_drop_record (rec, l);
+  }
+}
+
+void
+database_rep::rebuild (database_rep& img) {
+  // copy the lines which were not dropped into a fresh image
+  string rec;
+  for (int l= 0; l < N (line_id); l++)
+    if (line_id[l] >= 0)
+      img.add_line (img.make_atom (atoms[line_id[l]], rec),
+                    img.make_atom (atoms[line_attr[l]], rec),
+                    img.make_atom (atoms[line_val[l]], rec), line_created[l],
+                    line_expires[l]);
+}
+
+void
+database_rep::adopt (database_rep& img) {
+  atoms       = img.atoms;
+  atom_nr     = img.atom_nr;
+  line_id     = img.line_id;
+  line_attr   = img.line_attr;
+  line_val    = img.line_val;
+  line_created= img.line_created;
+  line_expires= img.line_expires;
+  dropped     = img.dropped;
+  id_lines    = img.id_lines;
+  val_lines   = img.val_lines;
+  words       = img.words;
+  word_lines  = img.word_lines;
+  word_trie   = img.word_trie;
+  name_trie   = img.name_trie;
+}
+
+/******************************************************************************
+ * Loading and saving
+ ******************************************************************************/
+
+bool
+database_rep::replay (string s, int pos, int end) {
+  char c= s[pos++];
+  if (c == 'A') {
+    string a= s (pos, end);
+    atom_nr (a)= N (atoms);
+    atoms << a;
+    return true;
+  }
+  if (c == 'L') {
+    int    id, attr, val, na= N (atoms);
+    double created, expires;
+    if (!get_index (s, pos, end, na, id) ||
+        !get_index (s, pos, end, na, attr) ||
+        !get_index (s, pos, end, na, val) ||
+        !get_time (s, pos, end, created) ||
+        !get_time (s, pos, end, expires) || pos != end)
+      return false;
+    add_line (id, attr, val, created, expires);
+    return true;
+  }
+  if (c == 'E' || c == 'D') {
+    int    l;
+    double t= 0;
+    if (!get_index (s, pos, end, N (line_id), l) || line_id[l] < 0 ||
+        (c == 'E' && !get_time (s, pos, end, t)) || pos != end)
+      return false;
+    if (c == 'E') expire_line (l, t);
+    else drop_line (l);
+    return true;
+  }
+  return false;
+}
+
+bool
+database_rep::load () {
+  string s;
+  if (is_none (file) || !exists (file)) return true;
+  if (load_string (file, s, false)) {
+    std_warning << "Could not read the database " << file << LF;
+    file= url_none ();
+    return true;
+  }
+  int m= N (string (DB_MAGIC));
+  if (N (s) < m || s (0, m) != DB_MAGIC) return false;
+  int pos= m, n= N (s);
+  while (pos < n) {
+    int                start= pos;
+    unsigned long long len;
+    if (!get_number (s, pos, n, len) || len == 0 ||
+        len > (unsigned long long) (n - pos) ||
+        !replay (s, pos, pos + (int) len)) {
+      // a record was truncated by a crash during an append
+      std_warning << "Ignoring the damaged end of the database " << file
+                  << LF;
+      pos= start;
+      break;
+    }
+    pos+= (int) len;
+  }
+  if ((pos < n || 2 * dropped > N (line_id)) && !rewrite () && pos < n)
+    // records appended after the damaged end would be lost on reload
+    file= url_none ();
+  return true;
+}
+
+string
+database_rep::save () {
+  string s= DB_MAGIC;
+  for (int i= 0; i < N (atoms); i++)
+    put_string (s, "A" * atoms[i]);
+  for (int l= 0; l < N (line_id); l++)
+    put_line_record (s, line_id[l], line_attr[l], line_val[l], line_created[l],
+                     line_expires[l]);
+  return s;
+}
+
+static bool
+db_replace (url u, string s) {
+  // write a sibling file and rename it over the target
+  url  tmp   = glue (u, ".new");
+  bool failed= save_string (tmp, s);
+  if (!failed) {
+    move (tmp, u);
+    failed= exists (tmp);
+  }
+  if (failed && exists (tmp)) remove (tmp);
+  return failed;
+}
+
+bool
+database_rep::rewrite () {
+  // compact into an image first, so that the line numbers used by
+  // the records already on disk remain valid if the file cannot be replaced
+  bool         compact= dropped > 0;
+  database_rep img (file);
+  if (compact) rebuild (img);
+  if (!is_none (file) && db_replace (file, compact ? img.save () : save ())) {
+    std_warning << "Could not rewrite the database " << file << LF;
+    return false;
+  }
+  if (compact) adopt (img);
+  return true;
+}
+
+void
+database_rep::commit (string rec) {
+  if (N (rec) == 0 || is_none (file)) return;
+  bool compact= dropped > 1000 && 2 * dropped > N (line_id);
+  if (!exists (file)) rewrite ();
+  // after a failed compaction the line numbers in rec are still those on disk
+  else if (!compact || !rewrite ()) append_string (file, rec, false);
+}
+
+/******************************************************************************
+ * Fields and entries
+ ******************************************************************************/
+
+void
+database_rep::set_field (string id, string attr, array<string> vals, double t,
+                         string& rec) {
+  if (get_field (id, attr, t) == vals) return;
+  remove_field (id, attr, t, rec);
+  int i= make_atom (id, rec), a= make_atom (attr, rec);
+  for (int j= 0; j < N (vals); j++) {
+    int v= make_atom (vals[j], rec);
+    add_line (i, a, v, t, DB_MAX_TIME);
+    put_line_record (rec, i, a, v, t, DB_MAX_TIME);
+  }
+}
+
+void
+database_rep::remove_field (string id, string attr, double t, string& rec) {
+  int i= find_atom (id), a= find_atom (attr);
+  if (i < 0 || a < 0) return;
+  array<int> ls= copy (id_lines[i]);
+  for (int j= 0; j < N (ls); j++)
+    if (line_attr[ls[j]] == a && valid (ls[j], t)) remove_line (ls[j], t, rec);
+}
+
+void
+database_rep::set_field (string id, string attr, array<string> vals,
+                         double t) {
+  string rec;
+  set_field (id, attr, vals, t, rec);
+  commit (rec);
+}
+
+array<string>
+database_rep::get_field (string id, string attr, double t) {
+  array<string> r;
+  int           i= find_atom (id), a= find_atom (attr);
+  if (i < 0 || a < 0) return r;
+  array<int> ls= id_lines[i];
+  for (int j= 0; j < N (ls); j++)
+    if (line_attr[ls[j]] == a && valid (ls[j], t)) r << atoms[line_val[ls[j]]];
+  return r;
+}
+
+void
+database_rep::remove_field (string id, string attr, double t) {
+  string rec;
+  remove_field (id, attr, t, rec);
+  commit (rec);
+}
+
+array<string>
+database_rep::get_attributes (string id, double t) {
+  array<string> r;
+  int           i= find_atom (id);
+  if (i < 0) return r;
+  array<int> ls= id_lines[i];
+  for (int j= 0; j < N (ls); j++)
+    if (valid (ls[j], t) && !contains (atoms[line_attr[ls[j]]], r))
+      r << atoms[line_attr[ls[j]]];
+  return r;
+}
+
+static string
+db_unquote (string s) {
+  return is_quoted (s) ? scm_unquote (s) : s;
+}
+
+void
+database_rep::set_entry (string id, tree e, double t) {
+  string        rec;
+  array<string> attrs;
+  for (int i= 0; i < N (e); i++)
+    if (is_tuple (e[i]) && N (e[i]) >= 1 && is_atomic (e[i][0])) {
+      string        attr= db_unquote (e[i][0]->label);
+      array<string> vals;
+      for (int j= 1; j < N (e[i]); j++)
+        if (is_atomic (e[i][j])) vals << db_unquote (e[i][j]->label);
+      set_field (id, attr, vals, t, rec);
+      attrs << attr;
+    }
+  array<string> old= get_attributes (id, t);
+  for (int i= 0; i < N (old); i++)
+    if (!contains (old[i], attrs)) remove_field (id, old[i], t, rec);
+  commit (rec);
+}
+
+tree
+database_rep::get_entry (string id, double t) {
+  tree          r (TUPLE);
+  array<string> attrs= get_attributes (id, t);
+  for (int i= 0; i < N (attrs); i++) {
+    tree          f (TUPLE, scm_quote (attrs[i]));
+    array<string> vals= get_field (id, attrs[i], t);
+    for (int j= 0; j < N (vals); j++)
+      f << tree (scm_quote (vals[j]));
+    r << f;
+  }
+  return r;
+}
+
+void
+database_rep::remove_entry (string id, double t) {
+  string rec;
+  int    i= find_atom (id);
+  if (i < 0) return;
+  array<int> ls= copy (id_lines[i]);
+  for (int j= 0; j < N (ls); j++)
+    if (valid (ls[j], t)) remove_line (ls[j], t, rec);
+  commit (rec);
+}
+
+void
+database_rep::inspect_history (string id) {
+  int i= find_atom (id);
+  if (i < 0) return;
+  array<int> ls= id_lines[i];
+  for (int j= 0; j < N (ls); j++) {
+    int l= ls[j];
+    cout << atoms[line_attr[l]] << "\t" << atoms[line_val[l]] << "\t"
+         << as_string (line_created[l]) << "\t"
+         << (line_expires[l] >= DB_MAX_TIME ? string ("-")
+                                             : as_string (line_expires[l]))
+         << LF;
+  }
+}
+
+/******************************************************************************
+ * Completions
+ ******************************************************************************/
+
+array<string>
+database_rep::get_completions (string prefix) {
+  array<string> r;
+  int           node= word_trie.find (locase_all (prefix), false);
+  if (node < 0) return r;
+  array<int> a;
+  word_trie.collect (node, a);
+  for (int i= 0; i < N (a); i++) {
+    array<int> ls= word_lines[a[i]];
+    for (int j= 0; j < N (ls); j++)
+      if (alive (ls[j])) {
+        r << words[a[i]];
+        break;
+      }
+  }
+  merge_sort (r);
+  return r;
+}
+
+array<string>
+database_rep::get_name_completions (string prefix) {
+  array<string> r;
+  int           node= name_trie.find (prefix, false);
+  if (node < 0) return r;
+  array<int> a;
+  name_trie.collect (node, a);
+  for (int i= 0; i < N (a); i++) {
+    array<int> ls= val_lines[a[i]];
+    for (int j= 0; j < N (ls); j++)
+      if (alive (ls[j]) && atoms[line_attr[ls[j]]] == "name") {
+        r << atoms[a[i]];
+        break;
+      }
+  }
+  merge_sort (r);
+  return r;
+}
+
+/******************************************************************************
+ * Interface with the file system and scheme
+ ******************************************************************************/
+
+static hashmap<string, database> databases;
+
+database
+get_database (url u) {
+  string name= as_string (u);
+  if (databases->contains (name)) return databases[name];
+  database db (u);
+  if (!db->load ()) {
+    std_warning << "Unrecognized database " << u << ", kept as "
+                << glue (u, "~") << LF;
+    move (u, glue (u, "~"));
+  }
+  databases (name)= db;
+  return db;
+}
+
+void
+keep_history (url u, bool flag) {
+  get_database (u)->history= flag;
+}
+
+void
+set_field (url u, string id, string attr, array<string> vals, double t) {
+  get_database (u)->set_field (id, attr, vals, t);
+}
+
+array<string>
+get_field (url u, string id, string attr, double t) {
+  return get_database (u)->get_field (id, attr, t);
+}
+
+void
+remove_field (url u, string id, string attr, double t) {
+  get_database (u)->remove_field (id, attr, t);
+}
+
+array<string>
+get_attributes (url u, string id, double t) {
+  return get_database (u)->get_attributes (id, t);
+}
+
+void
+set_entry (url u, string id, tree e, double t) {
+  get_database (u)->set_entry (id, e, t);
+}
+
+tree
+get_entry (url u, string id, double t) {
+  return get_database (u)->get_entry (id, t);
+}
+
+void
+remove_entry (url u, string id, double t) {
+  get_database (u)->remove_entry (id, t);
+}
+
+array<string>
+query (url u, tree q, double t, int limit) {
+  return get_database (u)->query (q, t, limit);
+}
+
+void
+inspect_history (url u, string id) {
+  get_database (u)->inspect_history (id);
+}
+
+array<string>
+get_completions (url u, string prefix) {
+  return get_database (u)->get_completions (prefix);
+}
+
+array<string>
+get_name_completions (url u, string prefix) {
+  return get_database (u)->get_name_completions (prefix);
+}
@@ -0,0 +1,144 @@
+
+/******************************************************************************
+ * MODULE     : database.hpp
+ * DESCRIPTION: indexed storage of TeXmacs databases
+ * COPYRIGHT  : (C) 2026  Darcy Shen
+ *******************************************************************************
+ * A database is a set of lines (id, attribute, value, created, expires).
+ * An entry consists of all lines with a given id; a field of an entry of
+ * all lines with a given id and attribute. A line is valid at time t if
+ * created <= t < expires; the special time 0 stands for all times.
+ * When the history is kept, removed fields expire instead of being dropped,
+ * so that former states of the database remain accessible.
+ *
+ * Lines are indexed by id, by value and by the lower case words which occur
+ * in their values. Words and names are also stored in prefix tries for the
+ * purpose of completion. On disk, a database is a sequence of length prefixed
+ * binary records, which is appended to on each change and rewritten in full
+ * when too many dropped lines accumulate.
+ *******************************************************************************
+ * This software falls under the GNU general public license version 3 or later.
+ * It comes WITHOUT ANY WARRANTY WHATSOEVER. For details, see the file LICENSE
+ * in the root directory or <http://www.gnu.org/licenses/gpl-3.0.html>.
+ ******************************************************************************/
+
+#ifndef DATABASE_H
+#define DATABASE_H
+
+#include "hashmap.hpp"
+#include "tree.hpp"
+#include "url.hpp"
+
+#define DB_MAX_TIME 1.0e300
+
+/******************************************************************************
+ * Prefix tries
+ ******************************************************************************/
+
+struct db_trie {
+  array<int>  first; // first child of each node or -1
+  array<int>  next;  // next sibling of each node or -1
+  array<char> key;   // byte on the edge leading to each node
+  array<int>  data;  // number stored at each node or -1
+
+  db_trie ();
+  int  step (int node, char c, bool create);
+  int  find (string s, bool create);
+  void collect (int node, array<int>& r);
+};
+
+/******************************************************************************
+ * The database class
+ ******************************************************************************/
+
+class database_rep : concrete_struct {
+public:
+  url                      file;         // backing file or url_none ()
+  bool                     history;      // keep removed fields as expired
+  array<string>            atoms;        // ids, attributes and values
+  hashmap<string, int>     atom_nr;      // number of each atom
+  array<int>               line_id;      // id of each line or -1 if dropped
+  array<int>               line_attr;    // attribute of each line
+  array<int>               line_val;     // value of each line
+  array<double>            line_created; // creation time of each line
+  array<double>            line_expires; // expiration time of each line
+  int                      dropped;      // number of dropped lines
+  hashmap<int, array<int>> id_lines;     // lines of each entry
+  hashmap<int, array<int>> val_lines;    // lines with a given value
+  array<string>            words;        // lower case words in values
+  array<array<int>>        word_lines;   // lines in which each word occurs
+  db_trie                  word_trie;    // words by prefix
+  db_trie                  name_trie;    // atoms of names by prefix
+
+public:
+  database_rep (url file);
+
+  int  find_atom (string s);
+  int  make_atom (string s, string& rec);
+  int  add_line (int id, int attr, int val, double created, double expires);
+  void index_words (int l);
+  void expire_line (int l, double t);
+  void drop_line (int l);
+  bool valid (int l, double t);
+  bool alive (int l);
+  void remove_line (int l, double t, string& rec);
+  void rebuild (database_rep& img);
+  void adopt (database_rep& img);
+
+  bool   replay (string s, int pos, int end);
+  bool   load ();
+  string save ();
+  bool   rewrite ();
+  void   commit (string rec);
+
+  void set_field (string id, string attr, array<string> vals, double t,
+                  string& rec);
+  void remove_field (string id, string attr, double t, string& rec);
+  bool matches (int id, tree c, double t);
+  void candidates (tree c, double t, array<int>& ids);
+  int  estimate (tree c);
+
+  void          set_field (string id, string attr, array<string> vals,
+                           double t);
+  array<string> get_field (string id, string attr, double t);
+  void          remove_field (string id, string attr, double t);
+  array<string> get_attributes (string id, double t);
+  void          set_entry (string id, tree e, double t);
+  tree          get_entry (string id, double t);
+  void          remove_entry (string id, double t);
+  array<string> query (tree q, double t, int limit);
+  void          inspect_history (string id);
+  array<string> get_completions (string prefix);
+  array<string> get_name_completions (string prefix);
+
+  friend class database;
+};
+
+class database {
+  CONCRETE_NULL (database);
+  database (url file);
+};
+CONCRETE_NULL_CODE (database);
+
+array<string> db_words (string s);
+
+/******************************************************************************
+ * Interface with the file system and scheme
+ ******************************************************************************/
+
+database      get_database (url u);
+void          keep_history (url u, bool flag);
+void          set_field (url u, string id, string attr, array<string> vals,
+                         double t);
+array<string> get_field (url u, string id, string attr, double t);
+void          remove_field (url u, string id, string attr, double t);
+array<string> get_attributes (url u, string id, double t);
+void          set_entry (url u, string id, tree e, double t);
+tree          get_entry (url u, string id, double t);
+void          remove_entry (url u, string id, double t);
+array<string> query (url u, tree q, double t, int limit);
+void          inspect_history (url u, string id);
+array<string> get_completions (url u, string prefix);
+array<string> get_name_completions (url u, string prefix);
+
+#endif // defined DATABASE_H
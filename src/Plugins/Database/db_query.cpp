@@ -0,0 +1,273 @@
+
+/******************************************************************************
+ * MODULE     : db_query.cpp
+ * DESCRIPTION: queries on TeXmacs databases
+ * COPYRIGHT  : (C) 2026  Darcy Shen
+ *******************************************************************************
+ * A query is a list of constraints, which are all to be satisfied:
+ *   ("attr" "val1" ... "valn")  a field attr with one of the given values
+ *   (contains "s")              all words of s occur in the entry
+ *   (completes "s")             all words of s start words of the entry
+ *   (modified "t1" "t2")        a field changed between the times t1 and t2
+ *   (order "attr" ascending?)   sort the results on the values of attr
+ * The most selective constraint for which an index exists is used in order
+ * to obtain the candidate entries; the others are checked for each candidate.
+ *******************************************************************************
+ * This software falls under the GNU general public license version 3 or later.
+ * It comes WITHOUT ANY WARRANTY WHATSOEVER. For details, see the file LICENSE
+ * in the root directory or <http://www.gnu.org/licenses/gpl-3.0.html>.
+ ******************************************************************************/
+
+#include "database.hpp"
+#include "analyze.hpp"
+#include "merge_sort.hpp"
+#include "tree_helper.hpp"
+
+#include <moebius/data/scheme.hpp>
+
+using namespace moebius;
+using moebius::data::scm_unquote;
+
+/******************************************************************************
+ * Subroutines
+ ******************************************************************************/
+
+static string
+db_head (tree c) {
+  if (!is_tuple (c) || N (c) == 0 || !is_atomic (c[0])) return "";
+  return c[0]->label;
+}
+
+static array<string>
+db_args (tree c) {
+  array<string> r;
+  for (int i= 1; i < N (c); i++)
+    if (is_atomic (c[i])) {
+      string s= c[i]->label;
+      r << (is_quoted (s) ? scm_unquote (s) : s);
+    }
+  return r;
+}
+
+static array<string>
+db_entry_words (database_rep* db, int id, double t) {
+  array<string> r;
+  array<int>    ls= db->id_lines[id];
+  for (int i= 0; i < N (ls); i++)
+    if (db->valid (ls[i], t)) r << db_words (db->atoms[db->line_val[ls[i]]]);
+  return r;
+}
+
+static bool
+db_has_word (array<string> ws, string w, bool prefix) {
+  for (int i= 0; i < N (ws); i++)
+    if (prefix ? starts (ws[i], w) : ws[i] == w) return true;
+  return false;
+}
+
+static bool
+db_exact (tree c) {
+  // do the candidates for c necessarily satisfy c?
+  string h= db_head (c);
+  if (is_quoted (h)) return true;
+  if (h != "contains" && h != "completes") return false;
+  array<string> args= db_args (c);
+  int           n   = 0;
+  for (int i= 0; i < N (args); i++)
+    n+= N (db_words (args[i]));
+  return n == 1;
+}
+
+static array<int>
+db_word_numbers (db_trie& trie, string w, bool prefix) {
+  array<int> r;
+  int        node= trie.find (w, false);
+  if (node < 0) return r;
+  if (prefix) trie.collect (node, r);
+  else if (trie.data[node] >= 0) r << trie.data[node];
+  return r;
+}
+
+/******************************************************************************
+ * Candidates and checks for individual constraints
+ ******************************************************************************/
+
+int
+database_rep::estimate (tree c) {
+  string        h   = db_head (c);
+  array<string> args= db_args (c);
+  if (is_quoted (h)) {
+    int cost= 0;
+    for (int i= 0; i < N (args); i++) {
+      int v= find_atom (args[i]);
+      if (v >= 0) cost+= N (val_lines[v]);
+    }
+    return cost;
+  }
+  if (h == "contains" || h == "completes") {
+    int cost= -1;
+    for (int i= 0; i < N (args); i++) {
+      array<string> ws= db_words (args[i]);
+      for (int j= 0; j < N (ws); j++) {
+        array<int> a= db_word_numbers (word_trie, ws[j], h == "completes");
+        int        e= 0;
+        for (int k= 0; k < N (a); k++)
+          e+= N (word_lines[a[k]]);
+        if (cost < 0 || e < cost) cost= e;
+      }
+    }
+    return cost;
+  }
+  return -1;
+}
+
+void
+database_rep::candidates (tree c, double t, array<int>& ids) {
+  string        h   = db_head (c);
+  array<string> args= db_args (c);
+  if (is_quoted (h)) {
+    int a= find_atom (scm_unquote (h));
+    if (a < 0) return;
+    for (int i= 0; i < N (args); i++) {
+      int v= find_atom (args[i]);
+      if (v < 0) continue;
+      array<int> ls= val_lines[v];
+      for (int j= 0; j < N (ls); j++)
+        if (line_attr[ls[j]] == a && valid (ls[j], t)) ids << line_id[ls[j]];
+    }
+  }
+  else if (h == "contains" || h == "completes") {
+    // only use the least frequent word; matches () checks the others
+    array<int> best;
+    int        cost= -1;
+    for (int i= 0; i < N (args); i++) {
+      array<string> ws= db_words (args[i]);
+      for (int j= 0; j < N (ws); j++) {
+        array<int> a= db_word_numbers (word_trie, ws[j], h == "completes");
+        int        e= 0;
+        for (int k= 0; k < N (a); k++)
+          e+= N (word_lines[a[k]]);
+        if (cost < 0 || e < cost) {
+          best= a;
+          cost= e;
+        }
+      }
+    }
+    for (int k= 0; k < N (best); k++) {
+      array<int> ls= word_lines[best[k]];
+      for (int j= 0; j < N (ls); j++)
+        if (valid (ls[j], t)) ids << line_id[ls[j]];
+    }
+  }
+}
+
+bool
+database_rep::matches (int id, tree c, double t) {
+  string        h   = db_head (c);
+  array<string> args= db_args (c);
+  array<int>    ls  = id_lines[id];
+  if (is_quoted (h)) {
+    int a= find_atom (scm_unquote (h));
+    for (int j= 0; j < N (ls); j++)
+      if (line_attr[ls[j]] == a && valid (ls[j], t) &&
+          contains (atoms[line_val[ls[j]]], args))
+        return true;
+    return false;
+  }
+  if (h == "contains" || h == "completes") {
+    array<string> ews= db_entry_words (this, id, t);
+    for (int i= 0; i < N (args); i++) {
+      array<string> ws= db_words (args[i]);
+      for (int j= 0; j < N (ws); j++)
+        if (!db_has_word (ews, ws[j], h == "completes")) return false;
+    }
+    return true;
+  }
+  if (h == "modified") {
+    double t1= N (args) > 0 ? as_double (args[0]) : 0.0;
+    double t2= N (args) > 1 ? as_double (args[1]) : DB_MAX_TIME;
+    for (int j= 0; j < N (ls); j++) {
+      double c= line_created[ls[j]], e= line_expires[ls[j]];
+      if ((t1 <= c && c < t2) || (t1 <= e && e < t2)) return true;
+    }
+    return false;
+  }
+  return true;
+}
+
+/******************************************************************************
+ * Ordering the results
+ ******************************************************************************/
+
+struct db_ascending_operator {
+  static inline bool leq (string& a, string& b) {
+    if (is_double (a) && is_double (b)) return as_double (a) <= as_double (b);
+    return a <= b;
+  }
+};
+
+struct db_descending_operator {
+  static inline bool leq (string& a, string& b) {
+    return db_ascending_operator::leq (b, a);
+  }
+};
+
+static void
+db_sort (database_rep* db, array<int>& ids, tree o, double t) {
+  array<string> args= db_args (o);
+  if (N (args) == 0) return;
+  bool          asc = N (args) < 2 || args[1] != "#f";
+  array<string> keys;
+  for (int i= 0; i < N (ids); i++) {
+    array<string> vals= db->get_field (db->atoms[ids[i]], args[0], t);
+    keys << (N (vals) == 0 ? string ("") : vals[0]);
+  }
+  if (asc) merge_sort_leq<string, int, db_ascending_operator> (keys, ids);
+  else merge_sort_leq<string, int, db_descending_operator> (keys, ids);
+}
+
+/******************************************************************************
+ * Queries
+ ******************************************************************************/
+
+array<string>
+database_rep::query (tree q, double t, int limit) {
+  // fields are cheaper to check than words, so put them first
+  array<tree> cs, ws, os;
+  for (int i= 0; i < N (q); i++)
+    if (db_head (q[i]) == "order") os << q[i];
+    else if (is_quoted (db_head (q[i]))) cs << q[i];
+    else if (db_head (q[i]) != "") ws << q[i];
+  cs << ws;
+  int best= -1, cost= 0;
+  for (int i= 0; i < N (cs); i++) {
+    int e= estimate (cs[i]);
+    if (e >= 0 && (best < 0 || e < cost)) {
+      best= i;
+      cost= e;
+    }
+  }
+  array<int> ids;
+  if (best >= 0) candidates (cs[best], t, ids);
+  else
+    for (int l= 0; l < N (line_id); l++)
+      if (valid (l, t)) ids << line_id[l];
+  merge_sort (ids);
+  bool       exact= best >= 0 && db_exact (cs[best]);
+  array<int> r;
+  for (int i= 0; i < N (ids); i++) {
+    if (i > 0 && ids[i] == ids[i - 1]) continue;
+    bool ok= true;
+    for (int j= 0; j < N (cs) && ok; j++)
+      if (j != best || !exact) ok= matches (ids[i], cs[j], t);
+    if (ok) r << ids[i];
+    // without ordering, the first matches are the results
+    if (N (os) == 0 && N (r) >= limit) break;
+  }
+  for (int k= N (os) - 1; k >= 0; k--)
+    db_sort (this, r, os[k], t);
+  array<string> ret;
+  for (int i= 0; i < N (r) && i < limit; i++)
+    ret << atoms[r[i]];
+  return ret;
+}
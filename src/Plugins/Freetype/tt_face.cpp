@@ -43,7 +43,8 @@ decode_index (FT_Face face, int i) {
  * Freetype faces
  ******************************************************************************/
 
-tt_face_rep::tt_face_rep (string name) : rep<tt_face> (name) {
+tt_face_rep::tt_face_rep (string name)
+    : rep<tt_face> (name), char_size (0.0), char_hdpi (0), char_vdpi (0) {
   bad_face= true;
   if (ft_initialize ()) return;
   if (DEBUG_VERBOSE) debug_fonts << "Loading True Type font " << name << "\n";
@@ -76,6 +77,22 @@ tt_face_rep::tt_face_rep (string name) : rep<tt_face> (name) {
   }
 }
 
+bool
+tt_face_rep::set_char_size (double size, int hdpi, int vdpi) {
+  // faces are shared between sizes, so only switch when needed
+  if (size == char_size && hdpi == char_hdpi && vdpi == char_vdpi)
+    return false;
+  FT_Error err= ft_set_char_size (ft_face, 0, (FT_F26Dot6) (size * 64.0 + 0.5),
+                                  hdpi, vdpi);
+  if (err) char_size= 0.0;
+  else {
+    char_size= size;
+    char_hdpi= hdpi;
+    char_vdpi= vdpi;
+  }
+  return err != 0;
+}
+
 tt_face
 load_tt_face (string name) {
   bench_start ("load tt face");
@@ -93,7 +110,8 @@ static metric error_metric;
 tt_font_metric_rep::tt_font_metric_rep (string name, string family,
                                         double size2, int hdpi2, int vdpi2)
     : font_metric_rep (name), size (size2), hdpi (hdpi2), vdpi (vdpi2),
-      fnm (NULL) {
+      has_kerning (false), fnm (NULL), last_nr (-1), last_block (NULL),
+      kerns (0) {
   face                = load_tt_face (family);
   bool size_set_failed= false;
   if (!face->bad_face) {
@@ -113,17 +131,19 @@ tt_font_metric_rep::tt_font_metric_rep (string name, string family,
         }
       }
       size_set_failed= ft_select_size (face->ft_face, best_size_index) != 0;
+      face->char_size= 0.0;
     }
     else {
       // For scalable fonts, use ft_set_char_size
-      size_set_failed=
-          ft_set_char_size (face->ft_face, 0, (FT_F26Dot6) (size * 64.0 + 0.5),
-                            hdpi, vdpi) != 0;
+      size_set_failed= face->set_char_size (size, hdpi, vdpi);
     }
   }
   bad_font_metric=
       face->bad_face || (size_set_failed && is_nil (face->cbdt_table));
   if (bad_font_metric) return;
+  // For bitmap fonts with CBDT table (like emoji fonts), kerning is usually not
+  // supported
+  has_kerning= FT_HAS_KERNING (face->ft_face) && is_nil (face->cbdt_table);
 
   error_metric->x1= error_metric->y1= 0;
   error_metric->x2= error_metric->y2= 0;
@@ -131,98 +151,165 @@ tt_font_metric_rep::tt_font_metric_rep (string name, string family,
   error_metric->x4= error_metric->y4= 0;
 }
 
+tt_metric_block*
+tt_font_metric_rep::get_block (int nr) {
+  if (nr == last_nr) return last_block;
+  tt_metric_block* B= (tt_metric_block*) fnm[nr];
+  if (B == NULL) {
+    B= tm_new<tt_metric_block> ();
+    for (int k= 0; k < TT_BLOCK_SIZE; k++)
+      B->status[k]= 0;
+    fnm (nr)= (pointer) B;
+  }
+  last_nr   = nr;
+  last_block= B;
+  return B;
+}
+
 bool
 tt_font_metric_rep::exists (int i) {
   if (face->bad_face) return false;
-  if (fnm->contains (i)) return true;
+  if (get_block (i >> TT_BLOCK_BITS)->status[i & (TT_BLOCK_SIZE - 1)] == 1)
+    return true;
   FT_UInt glyph_index= decode_index (face->ft_face, i);
   return glyph_index != 0;
 }
 
-metric&
-tt_font_metric_rep::get (int i) {
-  if (!face->bad_face && !fnm->contains (i)) {
+static void
+tt_mono_size (FT_Outline& outline, int& w, int& h) {
+  // Size of the bitmap which ft_render_glyph would produce in mono mode:
+  // the control box of the outline is rounded so as to include the centers
+  // of the pixels, and collapsed boxes are widened by one pixel.
+  FT_Pos xmin= 0, xmax= 0, ymin= 0, ymax= 0;
+  for (int k= 0; k < outline.n_points; k++) {
+    FT_Pos x= outline.points[k].x, y= outline.points[k].y;
+    if (k == 0 || x < xmin) xmin= x;
+    if (k == 0 || x > xmax) xmax= x;
+    if (k == 0 || y < ymin) ymin= y;
+    if (k == 0 || y > ymax) ymax= y;
+  }
+  FT_Pos x1= (xmin >> 6) + (((xmin & 63) + 31) >> 6);
+  FT_Pos x2= (xmax >> 6) + (((xmax & 63) + 32) >> 6);
+  FT_Pos y1= (ymin >> 6) + (((ymin & 63) + 31) >> 6);
+  FT_Pos y2= (ymax >> 6) + (((ymax & 63) + 32) >> 6);
+  if (x1 == x2) {
+    if ((xmin & 63) + (xmax & 63) > 64) x1--;
+    else x2++;
+  }
+  if (y1 == y2) {
+    if ((ymin & 63) + (ymax & 63) > 64) y1--;
+    else y2++;
+  }
+  w= (int) (x2 - x1);
+  h= (int) (y2 - y1);
+}
 
-    // For fonts with CBDT table, skip ft_set_char_size
-    if (is_nil (face->cbdt_table)) {
-      ft_set_char_size (face->ft_face, 0, (FT_F26Dot6) (size * 64.0 + 0.5),
-                        hdpi, vdpi);
+bool
+tt_font_metric_rep::load_metric (int i, metric_struct* M) {
+  // For fonts with CBDT table, skip ft_set_char_size
+  if (is_nil (face->cbdt_table)) face->set_char_size (size, hdpi, vdpi);
+  FT_UInt glyph_index= decode_index (face->ft_face, i);
+  if (ft_load_glyph (face->ft_face, glyph_index, FT_LOAD_DEFAULT)) return false;
+  FT_GlyphSlot slot= face->ft_face->glyph;
+  int          w, h;
+  // empty outlines, such as spaces, are cheap to render and the size
+  // of their bitmap depends on the version of FreeType
+  if (slot->format == FT_GLYPH_FORMAT_OUTLINE && slot->outline.n_points > 0)
+    tt_mono_size (slot->outline, w, h);
+  else if (slot->format == FT_GLYPH_FORMAT_BITMAP) {
+    w= slot->bitmap.width;
+    h= slot->bitmap.rows;
+  }
+  else {
+    if (ft_render_glyph (slot, ft_render_mode_mono)) return false;
+    w= slot->bitmap.width;
+    h= slot->bitmap.rows;
+  }
+  SI xw= tt_si (slot->metrics.width);
+  SI xh= tt_si (slot->metrics.height);
+  SI dx= tt_si (slot->metrics.horiBearingX);
+  SI dy= tt_si (slot->metrics.horiBearingY);
+  SI ll= tt_si (slot->metrics.horiAdvance);
+  (void) xw;
+
+  bool is_emoji= !is_nil (face->cbdt_table) && is_emoji_character (i);
+  if (is_emoji) {
+
+    // For PNG fonts (CBDT), apply scaling factor to make them scalable
+    double scale_factor= 1.0;
+    if (!is_nil (face->cbdt_table)) {
+      int target_pixel_size= (int) (size * hdpi / 72 + 0.5);
+      int actual_pixel_size= face->ft_face->size->metrics.y_ppem;
+      scale_factor         = (double) target_pixel_size / actual_pixel_size;
     }
-    FT_UInt glyph_index= decode_index (face->ft_face, i);
-    if (ft_load_glyph (face->ft_face, glyph_index, FT_LOAD_DEFAULT))
-      return error_metric;
-    FT_GlyphSlot slot= face->ft_face->glyph;
-    if (ft_render_glyph (slot, ft_render_mode_mono)) return error_metric;
-    metric_struct* M= tm_new<metric_struct> ();
-    fnm (i)         = (pointer) M;
-    int w           = slot->bitmap.width;
-    int h           = slot->bitmap.rows;
-    SI  xw          = tt_si (slot->metrics.width);
-    SI  xh          = tt_si (slot->metrics.height);
-    SI  dx          = tt_si (slot->metrics.horiBearingX);
-    SI  dy          = tt_si (slot->metrics.horiBearingY);
-    SI  ll          = tt_si (slot->metrics.horiAdvance);
-    (void) xw;
 
-    bool is_emoji= !is_nil (face->cbdt_table) && is_emoji_character (i);
-    if (is_emoji) {
+    int base_w= (ll + PIXEL / 2) / PIXEL;
+    int base_h= base_w; // treating Emojis as Squares
 
-      // For PNG fonts (CBDT), apply scaling factor to make them scalable
-      double scale_factor= 1.0;
-      if (!is_nil (face->cbdt_table)) {
-        int target_pixel_size= (int) (size * hdpi / 72 + 0.5);
-        int actual_pixel_size= face->ft_face->size->metrics.y_ppem;
-        scale_factor         = (double) target_pixel_size / actual_pixel_size;
-      }
+    // Apply scaling factor
+    w = (int) (base_w * scale_factor + 0.5);
+    h = (int) (base_h * scale_factor + 0.5);
+    xw= w * PIXEL; // Logical width in pixels
+    xh= h * PIXEL; // Logical height in pixels
+    dx= 0;
+    dy= (h * PIXEL * 8) / 10;
 
-      int base_w= (ll + PIXEL / 2) / PIXEL;
-      int base_h= base_w; // treating Emojis as Squares
+    // Scale the horizontal advance as well
+    ll= (SI) (ll * scale_factor + 0.5);
+  }
 
-      // Apply scaling factor
-      w = (int) (base_w * scale_factor + 0.5);
-      h = (int) (base_h * scale_factor + 0.5);
-      xw= w * PIXEL; // Logical width in pixels
-      xh= h * PIXEL; // Logical height in pixels
-      dx= 0;
-      dy= (h * PIXEL * 8) / 10;
-
-      // Scale the horizontal advance as well
-      ll= (SI) (ll * scale_factor + 0.5);
-    }
+  SI ww= w * PIXEL;
+  SI hh= h * PIXEL;
+  M->x1= 0;
+  M->y1= dy - xh;
+  M->x2= ll;
+  M->y2= dy;
+  M->x3= dx;
+  M->y3= dy - hh;
+  M->x4= dx + ww;
+  M->y4= dy;
+  // cout << "Glyph " << i << " of " << res_name << "\n";
+  // cout << "Logical : " << M->x1/PIXEL << ", " << M->y1/PIXEL
+  //      << "; " << M->x2/PIXEL << ", " << M->y2/PIXEL << "\n";
+  // cout << "Physical: " << M->x3/PIXEL << ", " << M->y3/PIXEL
+  //      << "; " << M->x4/PIXEL << ", " << M->y4/PIXEL << "\n";
+  return true;
+}
 
-    SI ww= w * PIXEL;
-    SI hh= h * PIXEL;
-    M->x1= 0;
-    M->y1= dy - xh;
-    M->x2= ll;
-    M->y2= dy;
-    M->x3= dx;
-    M->y3= dy - hh;
-    M->x4= dx + ww;
-    M->y4= dy;
-    // cout << "Glyph " << i << " of " << res_name << "\n";
-    // cout << "Logical : " << M->x1/PIXEL << ", " << M->y1/PIXEL
-    //      << "; " << M->x2/PIXEL << ", " << M->y2/PIXEL << "\n";
-    // cout << "Physical: " << M->x3/PIXEL << ", " << M->y3/PIXEL
-    //      << "; " << M->x4/PIXEL << ", " << M->y4/PIXEL << "\n";
-  }
-  return *((metric*) ((void*) fnm[i]));
+metric&
+tt_font_metric_rep::get (int i) {
+  if (face->bad_face) return error_metric;
+  tt_metric_block* B= get_block (i >> TT_BLOCK_BITS);
+  int              k= i & (TT_BLOCK_SIZE - 1);
+  if (B->status[k] == 0)
+    B->status[k]= (load_metric (i, B->metrics + k) ? 1 : 2);
+  if (B->status[k] == 2) return error_metric;
+  return *((metric*) ((void*) (B->metrics + k)));
 }
 
 SI
 tt_font_metric_rep::kerning (int left, int right) {
-  if (face->bad_face || !FT_HAS_KERNING (face->ft_face)) return 0;
-
-  // For bitmap fonts with CBDT table (like emoji fonts), kerning is usually not
-  // supported
-  if (!is_nil (face->cbdt_table)) return 0;
+  if (!has_kerning) return 0;
+  pair<int, int> p (left, right);
+  if (kerns->contains (p)) return kerns[p];
   FT_Vector k;
   FT_UInt   l= decode_index (face->ft_face, left);
   FT_UInt   r= decode_index (face->ft_face, right);
-  ft_set_char_size (face->ft_face, 0, (FT_F26Dot6) (size * 64.0 + 0.5), hdpi,
-                    vdpi);
-  if (ft_get_kerning (face->ft_face, l, r, FT_KERNING_DEFAULT, &k)) return 0;
-  return tt_si (k.x);
+  SI        d= 0;
+  face->set_char_size (size, hdpi, vdpi);
+  if (!ft_get_kerning (face->ft_face, l, r, FT_KERNING_DEFAULT, &k))
+    d= tt_si (k.x);
+  kerns (p)= d;
+  return d;
+}
+
+void
+tt_font_metric_rep::kernings (int* codes, int n, SI* ks) {
+  for (int i= 0; i < n; i++)
+    ks[i]= 0;
+  if (!has_kerning) return;
+  for (int i= 1; i < n; i++)
+    ks[i]= kerning (codes[i - 1], codes[i]);
 }
 
 font_metric
@@ -279,12 +366,11 @@ tt_font_glyphs_rep::tt_font_glyphs_rep (string name, string family,
         }
       }
       size_set_failed= ft_select_size (face->ft_face, best_size_index) != 0;
+      face->char_size= 0.0;
     }
     else {
       // For scalable fonts, use ft_set_char_size
-      size_set_failed=
-          ft_set_char_size (face->ft_face, 0, (FT_F26Dot6) (size * 64.0 + 0.5),
-                            hdpi, vdpi) != 0;
+      size_set_failed= face->set_char_size (size, hdpi, vdpi);
     }
   }
   bad_font_glyphs=
@@ -295,10 +381,7 @@ tt_font_glyphs_rep::tt_font_glyphs_rep (string name, string family,
 glyph&
 tt_font_glyphs_rep::get (int i) {
   if (!face->bad_face && !fng->contains (i)) {
-    if (is_nil (face->cbdt_table)) {
-      ft_set_char_size (face->ft_face, 0, (FT_F26Dot6) (size * 64.0 + 0.5),
-                        hdpi, vdpi);
-    }
+    if (is_nil (face->cbdt_table)) face->set_char_size (size, hdpi, vdpi);
     FT_UInt glyph_index= decode_index (face->ft_face, i);
     if (ft_load_glyph (face->ft_face, glyph_index, FT_LOAD_DEFAULT))
       return error_glyph;
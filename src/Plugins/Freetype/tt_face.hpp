@@ -15,6 +15,7 @@
 #include "Freetype/tt_tools.hpp"
 #include "bitmap_font.hpp"
 #include "hashmap.hpp"
+#include "ntuple.hpp"
 
 RESOURCE (tt_face);
 
@@ -23,22 +24,39 @@ struct tt_face_rep : rep<tt_face> {
   FT_Face      ft_face;
   ot_mathtable math_table;
   ot_cbdttable cbdt_table;
+  double       char_size; // character size currently selected in ft_face
+  int          char_hdpi, char_vdpi;
   tt_face_rep (string name);
+  bool set_char_size (double size, int hdpi, int vdpi);
+};
+
+// Glyph metrics are stored in dense blocks of consecutive character codes
+#define TT_BLOCK_BITS 8
+#define TT_BLOCK_SIZE (1 << TT_BLOCK_BITS)
+
+struct tt_metric_block {
+  metric_struct metrics[TT_BLOCK_SIZE];
+  char          status[TT_BLOCK_SIZE]; // 0: unknown, 1: loaded, 2: error
 };
 
 struct tt_font_metric_rep : font_metric_rep {
-  bool                  bad_metric;
-  tt_face               face;
-  double                size;
-  int                   hdpi, vdpi;
-  hashmap<int, pointer> fnm;
-  // metric* fnm;
-  // bool* done;
+  bool                         bad_metric;
+  tt_face                      face;
+  double                       size;
+  int                          hdpi, vdpi;
+  bool                         has_kerning;
+  hashmap<int, pointer>        fnm; // blocks of metrics by block number
+  int                          last_nr;
+  tt_metric_block*             last_block;
+  hashmap<pair<int, int>, int> kerns; // kerning pairs already looked up
   tt_font_metric_rep (string name, string family, double size, int hdpi,
                       int vdpi);
-  bool    exists (int char_code);
-  metric& get (int char_code);
-  SI      kerning (int left_code, int right_code);
+  bool             exists (int char_code);
+  metric&          get (int char_code);
+  SI               kerning (int left_code, int right_code);
+  void             kernings (int* codes, int n, SI* ks);
+  tt_metric_block* get_block (int nr);
+  bool             load_metric (int char_code, metric_struct* M);
 };
 
 struct tt_font_glyphs_rep : font_glyphs_rep {
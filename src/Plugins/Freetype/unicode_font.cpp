@@ -678,11 +678,18 @@ unicode_font_rep::get_extents (string s, metric& ex) {
     ex->y4= ex->y2= yx;
   }
   else {
-    int          i= 0, n= N (s);
-    unsigned int uc= read_unicode_char (s, i);
-    if (ligs > 0 && (((char) uc) == 'f' || ((char) uc) == 's'))
-      uc= ligature_replace (uc, s, i);
-    metric_struct* first= fnm->get (uc);
+    int i= 0, n= N (s), m= 0;
+    STACK_NEW_ARRAY (codes, int, n);
+    STACK_NEW_ARRAY (ks, SI, n);
+    while (i < n) {
+      unsigned int uc= read_unicode_char (s, i);
+      if (ligs > 0 && (((char) uc) == 'f' || ((char) uc) == 's'))
+        uc= ligature_replace (uc, s, i);
+      codes[m++]= (int) uc;
+    }
+    fnm->kernings (codes, m, ks);
+
+    metric_struct* first= fnm->get (codes[0]);
     ex->x1              = ROUND (first->x1);
     ex->y1              = ROUND (first->y1);
     ex->x2              = ROUND (first->x2);
@@ -693,13 +700,9 @@ unicode_font_rep::get_extents (string s, metric& ex) {
     ex->y4              = CEIL (first->y4);
     SI x                = ROUND (first->x2);
 
-    while (i < n) {
-      unsigned int pc= uc;
-      uc             = read_unicode_char (s, i);
-      if (ligs > 0 && (((char) uc) == 'f' || ((char) uc) == 's'))
-        uc= ligature_replace (uc, s, i);
-      x+= ROUND (fnm->kerning (pc, uc));
-      metric_struct* next= fnm->get (uc);
+    for (int k= 1; k < m; k++) {
+      x+= ROUND (ks[k]);
+      metric_struct* next= fnm->get (codes[k]);
       ex->x1             = min (ex->x1, x + ROUND (next->x1));
       ex->y1             = min (ex->y1, ROUND (next->y1));
       ex->x2             = max (ex->x2, x + ROUND (next->x2));
@@ -709,39 +712,45 @@ unicode_font_rep::get_extents (string s, metric& ex) {
       ex->x4             = max (ex->x4, x + CEIL (next->x4));
       ex->y4             = max (ex->y4, CEIL (next->y4));
       x+= ROUND (next->x2);
-      // if (fnm->kerning (pc, uc) != 0)
-      // cout << "Kerning " << ((char) pc) << ((char) uc) << " " << ROUND
-      // (fnm->kerning (pc, uc)) << ", " << ROUND (next->x2) << "\n";
     }
+    STACK_DELETE_ARRAY (codes);
+    STACK_DELETE_ARRAY (ks);
   }
 }
 
 void
 unicode_font_rep::get_xpositions (string s, SI* xpos, bool ligf) {
-  int i= 0, n= N (s);
+  int i= 0, n= N (s), m= 0;
   if (n == 0) {
     xpos[0]= 0;
     return;
   }
 
-  SI           x = 0;
-  unsigned int uc= 0xffffffff;
+  STACK_NEW_ARRAY (codes, int, n);
+  STACK_NEW_ARRAY (starts, int, n + 1);
+  STACK_NEW_ARRAY (ks, SI, n);
   while (i < n) {
-    int          start= i;
-    unsigned int pc   = uc;
-    uc                = read_unicode_char (s, i);
+    starts[m]      = i;
+    unsigned int uc= read_unicode_char (s, i);
     if (ligs > 0 && ligf && (((char) uc) == 'f' || ((char) uc) == 's'))
       uc= ligature_replace (uc, s, i);
-    if (pc != 0xffffffff) x+= ROUND (fnm->kerning (pc, uc));
-    metric_struct* next= fnm->get (uc);
-    for (int j= start; j < i; j++)
+    codes[m++]= (int) uc;
+  }
+  starts[m]= n;
+  fnm->kernings (codes, m, ks);
+
+  SI x= 0;
+  for (int k= 0; k < m; k++) {
+    x+= ROUND (ks[k]);
+    metric_struct* next= fnm->get (codes[k]);
+    for (int j= starts[k]; j < starts[k + 1]; j++)
       xpos[j]= x;
     x+= ROUND (next->x2);
-    // if (fnm->kerning (pc, uc) != 0)
-    // cout << "Kerning " << ((char) pc) << ((char) uc) << " " << ROUND
-    // (fnm->kerning (pc, uc)) << ", " << ROUND (next->x2) << "\n";
   }
   xpos[n]= x;
+  STACK_DELETE_ARRAY (codes);
+  STACK_DELETE_ARRAY (starts);
+  STACK_DELETE_ARRAY (ks);
 }
 
 void
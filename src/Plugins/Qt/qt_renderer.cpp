@@ -17,6 +17,7 @@
 #include "frame.hpp"
 #include "image_files.hpp"
 #include "picture.hpp"
+#include "preferences.hpp"
 #include "qimage.h"
 #include "qt_picture.hpp"
 #include "qt_utilities.hpp"
@@ -76,12 +77,103 @@ class qt_pixmap {
 
 CONCRETE_NULL_CODE (qt_pixmap);
 
+/******************************************************************************
+ * Bounded cache of character images
+ *
+ * Glyphs are first rendered into coverage masks with one byte per pixel,
+ * which are shared by all colors; their keys have the background color 1.
+ * The colored images which are actually drawn are derived from these masks.
+ * Both are kept in a cache whose size is bounded by the preference
+ * "glyph cache size" (in megabytes), the least recently used entry
+ * being evicted first.
+ ******************************************************************************/
+
+#define GLYPH_CACHE_SIZE "32"
+
+struct glyph_entry {
+  basic_character key;   // the character and its color
+  qt_image        img;   // colored image, nil for coverage masks
+  string          cov;   // coverage of each pixel, for coverage masks
+  SI              xo, yo;
+  int             w, h;
+  int             bytes; // memory used by the image or the mask
+  int             prev;  // more recently used entry
+  int             next;  // less recently used entry
+};
+
+static hashmap<basic_character, int> glyph_slot (-1);
+static array<glyph_entry>            glyph_cache;
+static array<int>                    glyph_free;
+static int                           glyph_first = -1;
+static int                           glyph_last  = -1;
+static int                           glyph_used  = 0;
+static int                           glyph_budget= -1;
+
+static void
+glyph_unlink (int k) {
+  glyph_entry& e= glyph_cache[k];
+  if (e.prev >= 0) glyph_cache[e.prev].next= e.next;
+  else glyph_first= e.next;
+  if (e.next >= 0) glyph_cache[e.next].prev= e.prev;
+  else glyph_last= e.prev;
+}
+
+static void
+glyph_push (int k) {
+  glyph_cache[k].prev= -1;
+  glyph_cache[k].next= glyph_first;
+  if (glyph_first >= 0) glyph_cache[glyph_first].prev= k;
+  else glyph_last= k;
+  glyph_first= k;
+}
+
+static int
+glyph_lookup (basic_character xc) {
+  int k= glyph_slot[xc];
+  if (k >= 0 && k != glyph_first) {
+    glyph_unlink (k);
+    glyph_push (k);
+  }
+  return k;
+}
+
+static int
+glyph_insert (basic_character xc, int bytes) {
+  if (glyph_budget < 0) {
+    string s    = get_preference ("glyph cache size", GLYPH_CACHE_SIZE);
+    glyph_budget= max (1, is_int (s) ? as_int (s) : 32) * 1024 * 1024;
+  }
+  while (glyph_last >= 0 && glyph_used + bytes > glyph_budget) {
+    int          k= glyph_last;
+    glyph_entry& e= glyph_cache[k];
+    glyph_unlink (k);
+    glyph_slot->reset (e.key);
+    glyph_used-= e.bytes;
+    e.img      = qt_image ();
+    e.cov      = string ();
+    glyph_free << k;
+  }
+  int k;
+  if (N (glyph_free) > 0) {
+    k= glyph_free[N (glyph_free) - 1];
+    glyph_free->resize (N (glyph_free) - 1);
+  }
+  else {
+    k= N (glyph_cache);
+    glyph_cache << glyph_entry ();
+  }
+  glyph_cache[k].key  = xc;
+  glyph_cache[k].bytes= bytes;
+  glyph_slot (xc)     = k;
+  glyph_used+= bytes;
+  glyph_push (k);
+  return k;
+}
+
 /******************************************************************************
  * Global support variables for all qt_renderers
  ******************************************************************************/
 
-// bitmaps of all characters
-static hashmap<basic_character, qt_image> character_image;
 // image cache
 static hashmap<string, qt_pixmap> images;
 
@@ -92,8 +184,13 @@ static hashmap<string, qt_pixmap> images;
 */
 void
 del_obj_qt_renderer (void) {
-  character_image= hashmap<basic_character, qt_image> ();
-  images         = hashmap<string, qt_pixmap> ();
+  glyph_slot = hashmap<basic_character, int> (-1);
+  glyph_cache= array<glyph_entry> ();
+  glyph_free = array<int> ();
+  glyph_first= -1;
+  glyph_last = -1;
+  glyph_used = 0;
+  images     = hashmap<string, qt_pixmap> ();
 }
 
 /******************************************************************************
@@ -616,78 +713,62 @@ qt_renderer_rep::draw (int c, font_glyphs fng, SI x, SI y) {
     return;
   }
 
-  // get the pixmap
+  // get the colored image, or make it out of the coverage mask
   color           fgc= pen->get_color ();
   basic_character xc (c, fng, std_shrinkf, fgc, 0);
-  qt_image        mi= character_image[xc];
-  if (is_nil (mi)) {
-    int r, g, b, a;
+  int             k= glyph_lookup (xc);
+  if (k < 0) {
+    basic_character xm (c, fng, std_shrinkf, 0, 1);
+    int             m= glyph_lookup (xm);
+    if (m < 0) {
+      SI    xo, yo;
+      glyph pre_gl= fng->get (c);
+      if (is_nil (pre_gl)) return;
+      glyph  gl= shrink (pre_gl, std_shrinkf, std_shrinkf, xo, yo);
+      int    w= gl->width, h= gl->height;
+      string cov (w * h);
+      for (int j= 0; j < h; j++)
+        for (int i= 0; i < w; i++)
+          cov[j * w + i]= (char) gl->get_x (i, j);
+      m             = glyph_insert (xm, w * h);
+      glyph_entry& e= glyph_cache[m];
+      e.cov         = cov;
+      e.xo          = xo;
+      e.yo          = yo;
+      e.w           = w;
+      e.h           = h;
+    }
+
+    // make the colored image out of the mask
+    glyph_entry mask= glyph_cache[m];
+    int         r, g, b, a;
     get_rgb (fgc, r, g, b, a);
     if (get_reverse_colors ()) reverse (r, g, b);
-    SI    xo, yo;
-    glyph pre_gl= fng->get (c);
-    if (is_nil (pre_gl)) return;
-    glyph gl= shrink (pre_gl, std_shrinkf, std_shrinkf, xo, yo);
-    int   i, j, w= gl->width, h= gl->height;
+    int nr_cols= std_shrinkf * std_shrinkf;
+    if (nr_cols >= 64) nr_cols= 64;
+    int    w= mask.w, h= mask.h;
+    QImage aux (w, h, QImage::Format_ARGB32);
+    for (int j= 0; j < h; j++) {
+      QRgb*       line= (QRgb*) aux.scanLine (j);
+      const char* cov = &mask.cov[j * w];
+      for (int i= 0; i < w; i++)
+        line[i]= qRgba (r, g, b, (a * (int) (unsigned char) cov[i]) / nr_cols);
+    }
 #ifdef QTMPIXMAPS
     QTMPixmapOrImage* im= new QTMPixmapOrImage (w, h);
-    if (!headless_mode) {
-      int nr_cols= std_shrinkf * std_shrinkf;
-      if (nr_cols >= 64) nr_cols= 64;
-
-      im->fill (Qt::transparent);
-      QPainter pp (im->QPixmap_ptr ());
-      QPen     pen (painter->pen ());
-      QBrush   br (pen.color ());
-      pp.setPen (Qt::NoPen);
-      for (j= 0; j < h; j++)
-        for (i= 0; i < w; i++) {
-          int col= gl->get_x (i, j);
-          br.setColor (QColor (r, g, b, (a * col) / nr_cols));
-          pp.fillRect (i, j, 1, 1, br);
-        }
-      pp.end ();
-    }
-    else {
-      QImage* aux    = im->QImage_ptr ();
-      int     nr_cols= std_shrinkf * std_shrinkf;
-      if (nr_cols >= 64) nr_cols= 64;
-      im->fill (Qt::transparent);
-      for (j= 0; j < h; j++)
-        for (i= 0; i < w; i++) {
-          int col= gl->get_x (i, j);
-          aux->setPixel (i, j, qRgba (r, g, b, (a * col) / nr_cols));
-        }
-    }
+    if (!headless_mode) *(im->QPixmap_ptr ())= QPixmap::fromImage (aux);
+    else *(im->QImage_ptr ())= aux;
 #else
-    QTMImage* im= new QImage (w, h, QImage::Format_ARGB32);
-    // QTMImage *im= new QImage (w, h, QImage::Format_ARGB32_Premultiplied);
-    {
-      int nr_cols= std_shrinkf * std_shrinkf;
-      if (nr_cols >= 64) nr_cols= 64;
-
-      // the following line is disabled because
-      // it causes a crash on Qt/X11 4.4.3
-      // im->fill (Qt::transparent);
-
-      for (j= 0; j < h; j++)
-        for (i= 0; i < w; i++) {
-          int col= gl->get_x (i, j);
-          im->setPixel (i, j, qRgba (r, g, b, (a * col) / nr_cols));
-        }
-    }
+    QTMImage* im= new QImage (aux);
 #endif
-    qt_image mi2 (im, xo, yo, w, h);
-    mi= mi2;
-    //[im release]; // qt_image retains im
-    character_image (xc)= mi;
-    // FIXME: we must release the image at some point
-    //        (this should be ok now, see qt_image)
+    k                 = glyph_insert (xc, 4 * w * h);
+    glyph_cache[k].img= qt_image (im, mask.xo, mask.yo, w, h);
   }
 
   // draw the character
   // cout << (char)c << ": " << cx1/256 << ","  << cy1/256 << ","
   //<< cx2/256 << ","  << cy2/256 << LF;
+  qt_image mi= glyph_cache[k].img;
   draw_clipped (mi->img, mi->w, mi->h, x - mi->xo * std_shrinkf,
                 y + mi->yo * std_shrinkf);
 }
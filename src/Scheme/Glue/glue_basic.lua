@@ -168,6 +168,24 @@ function main()
                 cpp_name = "bench_print_all",
                 ret_type = "void"
             },
+            {
+                scm_name = "profile-enabled?",
+                cpp_name = "profile_enabled",
+                ret_type = "bool"
+            },
+            {
+                scm_name = "profile-reset",
+                cpp_name = "profile_reset",
+                ret_type = "void"
+            },
+            {
+                scm_name = "profile-export",
+                cpp_name = "profile_export",
+                ret_type = "bool",
+                arg_list = {
+                    "url"
+                }
+            },
             {
                 scm_name = "system-wait",
                 cpp_name = "system_wait",
@@ -1463,6 +1481,36 @@ function main()
                     "url"
                 }
             },
+            {
+                scm_name = "buffer-journal-reset",
+                cpp_name = "buffer_journal_reset",
+                ret_type = "bool",
+                arg_list = {
+                    "url",
+                    "url",
+                    "url"
+                }
+            },
+            {
+                scm_name = "buffer-journal-append",
+                cpp_name = "buffer_journal_append",
+                ret_type = "bool",
+                arg_list = {
+                    "url",
+                    "url",
+                    "url"
+                }
+            },
+            {
+                scm_name = "buffer-journal-replay",
+                cpp_name = "buffer_journal_replay",
+                ret_type = "tree",
+                arg_list = {
+                    "tree",
+                    "url",
+                    "url"
+                }
+            },
             {
                 scm_name = "tree-import-loaded",
                 cpp_name = "import_loaded_tree",
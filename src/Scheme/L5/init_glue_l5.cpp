@@ -29,6 +29,7 @@
 #include "promise.hpp"
 #include "tm_debug.hpp"
 #include "tm_locale.hpp"
+#include "tm_profile.hpp"
 #include "tree_observer.hpp"
 #include "universal.hpp"
 #include "widget.hpp"
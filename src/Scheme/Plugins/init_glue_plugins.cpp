@@ -17,6 +17,9 @@
 
 #include "LaTeX_Preview/latex_preview.hpp"
 
+#include "Database/database.hpp"
+#include "glue_tmdb.cpp"
+
 #include "Xml/xml.hpp"
 #include "glue_xml.cpp"
 
@@ -116,6 +119,7 @@ void
 initialize_glue_plugins () {
   initialize_glue_plugin ();
   initialize_glue_xml ();
+  initialize_glue_tmdb ();
 
 #ifdef USE_PLUGIN_HTML
   initialize_glue_html ();
@@ -61,15 +61,183 @@
 #include "config.h"
 
 #include "analyze.hpp"
+#include "data_cache.hpp"
 #include "file.hpp"
 #include "scheme.hpp"
 #include "sys_utils.hpp"
 #include "tm_file.hpp"
+#include "tm_timer.hpp"
 #include "tm_url.hpp"
 #include "tmfs_url.hpp"
 #include "url.hpp"
 #include "web_files.hpp"
 
+#include <time.h>
+
+/******************************************************************************
+ * Cached directory listings
+ *
+ * Path searches test many candidate files, most of which do not exist.
+ * For directories which TeXmacs does not modify itself, namely those of
+ * the installation and of the executable path, we keep the list of entries
+ * in memory, so that missing candidates are rejected without accessing the
+ * disk. The attributes of an existing entry are determined once, when it
+ * is first tested. A listing is checked against the modification time of
+ * its directory at most every URL_INDEX_RECHECK milliseconds.
+ ******************************************************************************/
+
+#define URL_INDEX_RECHECK 2000
+
+struct url_index_rep : concrete_struct {
+  bool                 active;  // whether the directory is indexed at all
+  int                  stamp;   // modification time of the directory
+  time_t               checked; // when the stamp was last verified
+  array<string>        names;   // entries of the directory
+  hashmap<string, int> info;    // known attributes of each entry
+
+  url_index_rep (bool active2, int stamp2, time_t checked2)
+      : active (active2), stamp (stamp2), checked (checked2), info (0) {}
+};
+
+class url_index {
+  CONCRETE_NULL (url_index);
+  url_index (bool active, int stamp, time_t checked)
+      : rep (tm_new<url_index_rep> (active, stamp, checked)) {}
+};
+CONCRETE_NULL_CODE (url_index);
+
+static hashmap<string, url_index> url_indices;
+static hashset<string>            url_index_bin;
+static bool                       url_index_bin_done= false;
+
+static string
+url_index_key (string name) {
+#if defined(OS_WIN) || defined(OS_MINGW) || defined(OS_MACOS)
+  // file names are usually case insensitive on these systems
+  return locase_all (name);
+#else
+  return name;
+#endif
+}
+
+static void
+url_index_collect (hashset<string>& h, url u) {
+  if (is_or (u)) {
+    url_index_collect (h, u[1]);
+    url_index_collect (h, u[2]);
+  }
+  else if (is_rooted (u, "default")) h->insert (concretize (u));
+}
+
+static bool
+url_index_scope (string dir) {
+  if (do_cache_dir (dir)) return true;
+  if (!url_index_bin_done) {
+    url_index_collect (url_index_bin, expand (url_path ("$PATH")));
+    url_index_bin_done= true;
+  }
+  return url_index_bin->contains (dir);
+}
+
+static url_index
+get_url_index (url dir) {
+  // dir must be rooted by "default" or "file"
+  string    name= as_string (dir);
+  time_t    now = texmacs_time ();
+  url_index idx = url_indices[name];
+  if (!is_nil (idx)) {
+    if (!idx->active || now - idx->checked < URL_INDEX_RECHECK) return idx;
+    idx->checked= now;
+    if (last_modified (dir) == idx->stamp) return idx;
+  }
+  else if (!url_index_scope (concretize (dir))) {
+    url_indices (name)= url_index (false, -1, now);
+    return url_indices[name];
+  }
+  int           stamp= last_modified (dir);
+  bool          error_flag;
+  array<string> a= read_directory (dir, error_flag);
+  // unreadable directories may still contain accessible files
+  idx= url_index (!error_flag || stamp == -1, stamp, now);
+  for (int i= 0; i < N (a); i++)
+    if (a[i] != "." && a[i] != "..") {
+      idx->names << a[i];
+      idx->info (url_index_key (a[i]))= 0;
+    }
+  // entries may still be added within the second of the stamp
+  if (stamp >= ((int) time (NULL)) - 1) idx->stamp= -2;
+  url_indices (name)= idx;
+  return idx;
+}
+
+static bool
+url_index_attribute (int& info, url dir, string entry, char c) {
+  // info holds a pair of bits for each of the attributes d, r, w and x:
+  // whether the attribute has been determined and whether it holds
+  int i    = (c == 'd' ? 0 : (c == 'r' ? 1 : (c == 'w' ? 2 : 3)));
+  int known= 1 << (2 * i), holds= 2 << (2 * i);
+  if ((info & known) == 0) {
+    url name= dir * entry;
+    info|= known;
+    if (c == 'd' ? is_directory (name) : is_of_type (name, string (c)))
+      info|= holds;
+  }
+  return (info & holds) != 0;
+}
+
+static int
+url_index_test (url dir, string entry, string filter) {
+  // returns 1 or 0 if the index decides whether dir/entry passes the filter
+  // and -1 if the file system should be queried instead
+  if (filter == "" || entry == "" || entry == "." || entry == "..") return -1;
+  for (int i= 0; i < N (filter); i++)
+    if (filter[i] == 'l') return -1;
+#if defined(OS_WIN) || defined(OS_MINGW)
+  if (filter == "x") return -1; // executables may omit their suffix
+#endif
+  url_index idx= get_url_index (dir);
+  if (!idx->active) return -1;
+  string key= url_index_key (entry);
+  if (!idx->info->contains (key)) return 0;
+  int  info= idx->info[key], old= info;
+  bool ok  = true;
+  for (int i= 0; i < N (filter) && ok; i++)
+    switch (filter[i]) {
+    case 'f':
+      ok= !url_index_attribute (info, dir, entry, 'd');
+      break;
+    case 'd':
+    case 'r':
+    case 'w':
+    case 'x':
+      ok= url_index_attribute (info, dir, entry, filter[i]);
+      break;
+    }
+  if (info != old) idx->info (key)= info;
+  return ok ? 1 : 0;
+}
+
+static array<string>
+url_index_read (url dir) {
+  url_index idx= get_url_index (dir);
+  if (idx->active) return idx->names;
+  bool error_flag;
+  return read_directory (dir, error_flag);
+}
+
+static url
+join_or (array<url> a) {
+  // joining from the right takes linear time, from the left quadratic time
+  url r= url_none ();
+  for (int i= N (a) - 1; i >= 0; i--)
+    r= a[i] | r;
+  return r;
+}
+
+/******************************************************************************
+ * Testing urls
+ ******************************************************************************/
+
 bool
 url_test (url name, string filter) {
   if (filter == "") return true;
@@ -170,7 +338,10 @@ complete (url base, url u, string filter, bool flag) {
   if (is_name (u) || (is_concat (u) && is_root (u[1]) && is_name (u[2]))) {
     url comp= base * u;
     if (is_rooted (comp, "default") || is_rooted (comp, "file")) {
-      if (url_test (comp, filter)) return reroot (u, "default");
+      int cached= -1;
+      if (is_name (u)) cached= url_index_test (base, u->t->label, filter);
+      if (cached == 1 || (cached < 0 && url_test (comp, filter)))
+        return reroot (u, "default");
       return url_none ();
     }
     if (is_rooted_web (comp) || is_rooted_tmfs (comp) || is_ramdisc (comp)) {
@@ -184,28 +355,29 @@ complete (url base, url u, string filter, bool flag) {
     return u;
   }
   if (is_concat (u) && is_wildcard (u[1], 0) && is_wildcard (u[2], 1)) {
-    // FIXME: ret= ret | ... is unefficient (quadratic) in main loop
     if (!(is_rooted (base, "default") || is_rooted (base, "file"))) {
       failed_error << "base  = " << base << LF;
       failed_error << "u     = " << u << LF;
       failed_error << "filter= " << filter << LF;
       TM_FAILED ("wildcards only implemented for files");
     }
-    url           ret= url_none ();
-    bool          error_flag;
-    array<string> dir= read_directory (base, error_flag);
+    array<url>    ret;
+    array<string> dir= url_index_read (base);
     int           i, n= N (dir);
     for (i= 0; i < n; i++) {
-      if ((!is_none (ret)) && flag) return ret;
+      if ((N (ret) != 0) && flag) break;
       if ((dir[i] == ".") || (dir[i] == "..")) continue;
       if (starts (dir[i], "http://") || starts (dir[i], "https://") ||
           starts (dir[i], "ftp://"))
         if (is_directory (base * dir[i])) continue;
-      ret= ret | (dir[i] * complete (base * dir[i], u, filter, flag));
-      if (match_wildcard (dir[i], u[2][1]->t->label))
-        ret= ret | complete (base, dir[i], filter, flag);
+      url sub= complete (base * dir[i], u, filter, flag);
+      if (!is_none (sub)) ret << dir[i] * sub;
+      if (match_wildcard (dir[i], u[2][1]->t->label)) {
+        sub= complete (base, dir[i], filter, flag);
+        if (!is_none (sub)) ret << sub;
+      }
     }
-    return ret;
+    return join_or (ret);
   }
   if (is_concat (u)) {
     url sub= complete (base, u[1], "", false);
@@ -218,30 +390,32 @@ complete (url base, url u, string filter, bool flag) {
     return res1 | complete (base, u[2], filter, flag);
   }
   if (is_wildcard (u)) {
-    // FIXME: ret= ret | ... is unefficient (quadratic) in main loop
     if (!(is_rooted (base, "default") || is_rooted (base, "file"))) {
       failed_error << "base  = " << base << LF;
       failed_error << "u     = " << u << LF;
       failed_error << "filter= " << filter << LF;
       TM_FAILED ("wildcards only implemented for files");
     }
-    url ret= url_none ();
-    if (is_wildcard (u, 0) && url_test (base, filter)) ret= url_here ();
-    bool          error_flag;
-    array<string> dir= read_directory (base, error_flag);
+    array<url> ret;
+    if (is_wildcard (u, 0) && url_test (base, filter)) ret << url_here ();
+    array<string> dir= url_index_read (base);
     int           i, n= N (dir);
     for (i= 0; i < n; i++) {
-      if ((!is_none (ret)) && flag) return ret;
+      if ((N (ret) != 0) && flag) break;
       if ((dir[i] == ".") || (dir[i] == "..")) continue;
       if (starts (dir[i], "http://") || starts (dir[i], "https://") ||
           starts (dir[i], "ftp://"))
         if (is_directory (base * dir[i])) continue;
-      if (is_wildcard (u, 0))
-        ret= ret | (dir[i] * complete (base * dir[i], u, filter, flag));
+      url sub= url_none ();
+      if (is_wildcard (u, 0)) {
+        sub= complete (base * dir[i], u, filter, flag);
+        if (!is_none (sub)) sub= dir[i] * sub;
+      }
       else if (match_wildcard (dir[i], u[1]->t->label))
-        ret= ret | complete (base, dir[i], filter, flag);
+        sub= complete (base, dir[i], filter, flag);
+      if (!is_none (sub)) ret << sub;
     }
-    return ret;
+    return join_or (ret);
   }
   failed_error << "url= " << u << LF;
   TM_FAILED ("bad url");
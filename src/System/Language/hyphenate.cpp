@@ -13,6 +13,8 @@
 #include "analyze.hpp"
 #include "converter.hpp"
 #include "file.hpp"
+#include "iterator.hpp"
+#include "merge_sort.hpp"
 #include "universal.hpp"
 
 #include <stdio.h>
@@ -126,12 +128,6 @@ load_hyphen_tables (string file_name, hashmap<string, string>& patterns,
   }
 }
 
-array<int>
-get_hyphens (string s, hashmap<string, string> patterns,
-             hashmap<string, string> hyphenations) {
-  return get_hyphens (s, patterns, hyphenations, false);
-}
-
 string
 sub_str (string s, int i, int len, bool utf8) {
   // i: start (index is encoding-dependent, i.e. it is not a number of
@@ -163,9 +159,92 @@ str_length (string s, bool utf8) {
   else return N (s);
 }
 
+/******************************************************************************
+ * Compilation of the patterns into a trie
+ ******************************************************************************/
+
+static string
+pattern_weights (string key, string r, bool utf8) {
+  // length of the key, followed by the weights before each of its letters
+  int    len= (utf8 ? str_length (key, utf8) : N (key));
+  string w;
+  w << (char) len;
+  for (int j= 0, k= 0; j <= len; j++, goto_next_char (r, k, utf8)) {
+    int m= 0;
+    if (k < N (r) && is_digit (r[k])) {
+      m= ((int) r[k]) - ((int) '0');
+      goto_next_char (r, k, utf8);
+    }
+    w << (char) m;
+  }
+  return w;
+}
+
+hyphen_table_rep::hyphen_table_rep (hashmap<string, string> patterns,
+                                    hashmap<string, string> hyphenations2,
+                                    bool                    utf82)
+    : utf8 (utf82), hyphenations (hyphenations2), cache_slot (-1),
+      cache_first (-1), cache_last (-1) {
+  array<string> keys;
+  iterator<string> it= iterate (patterns);
+  while (it->busy ())
+    keys << it->next ();
+  merge_sort (keys);
+
+  // Breadth first construction: the node for a prefix of length d covers
+  // the range [a, b) of keys starting with this prefix.
+  array<int> range_start, range_end, depth;
+  label << '\0';
+  first << 0;
+  count << 0;
+  weight << -1;
+  range_start << 0;
+  range_end << N (keys);
+  depth << 0;
+  for (int node= 0; node < N (label); node++) {
+    int a= range_start[node], b= range_end[node], d= depth[node];
+    if (a < b && N (keys[a]) == d) {
+      weight[node]= N (weights);
+      weights << pattern_weights (keys[a], patterns[keys[a]], utf8);
+      a++;
+    }
+    first[node]= N (label);
+    while (a < b) {
+      char c= keys[a][d];
+      int  e= a + 1;
+      while (e < b && keys[e][d] == c)
+        e++;
+      label << c;
+      first << 0;
+      count << 0;
+      weight << -1;
+      range_start << a;
+      range_end << e;
+      depth << (d + 1);
+      count[node]++;
+      a= e;
+    }
+  }
+}
+
+hyphen_table::hyphen_table (hashmap<string, string> patterns,
+                            hashmap<string, string> hyphenations, bool utf8)
+    : rep (tm_new<hyphen_table_rep> (patterns, hyphenations, utf8)) {}
+
+hyphen_table
+load_hyphen_table (string language_name, bool toCork) {
+  hashmap<string, string> patterns ("?");
+  hashmap<string, string> hyphenations ("?");
+  load_hyphen_tables (language_name, patterns, hyphenations, toCork);
+  return hyphen_table (patterns, hyphenations, !toCork);
+}
+
+/******************************************************************************
+ * Hyphenation of words
+ ******************************************************************************/
+
 array<int>
-get_hyphens (string s, hashmap<string, string> patterns,
-             hashmap<string, string> hyphenations, bool utf8) {
+hyphen_table_rep::compute_hyphens (string s) {
   ASSERT (N (s) != 0, "hyphenation of empty string");
 
   if (utf8) s= cork_to_utf8 (uni_locase_all (s));
@@ -191,71 +270,101 @@ get_hyphens (string s, hashmap<string, string> patterns,
     // cout << s << " --> " << penalty << "\n";
     return penalty;
   }
-  else if (utf8) {
-    s= "." * s * ".";
-    // cout << s << "\n";
-    int        i, j, k, l, m, len, slen= str_length (s, utf8);
-    array<int> T (slen + 1);
-    for (i= 0; i < N (T); i++)
-      T[i]= 0;
-    for (len= 1; len < MAX_SEARCH; len++)
-      for (i= 0, l= 0; i < str_ind (s, slen - len + 1, utf8);
-           goto_next_char (s, i, utf8), l++) {
-        string r= patterns[sub_str (s, i, len, utf8)];
-        if (!(r == "?")) {
-          // cout << "  " << sub_str (s, i, len, utf8) << " => " << r << "\n";
-          for (j= 0, k= 0; j <= len; j++, goto_next_char (r, k, utf8)) {
-            if (k < N (r) && is_digit (r[k])) {
-              m= ((int) r[k]) - ((int) '0');
-              goto_next_char (r, k, utf8);
-            }
-            else m= 0;
-            if (m > T[l + j]) T[l + j]= m;
-          }
+
+  // Walk the trie once from each letter of the word.  The letters are
+  // utf8 characters in the utf8 case and bytes in the cork case, where
+  // patterns never end on the final dot.
+  s= "." * s * ".";
+  int        n  = N (s);
+  int        end= (utf8 ? n : n - 1);
+  array<int> T ((utf8 ? str_length (s, utf8) : n) + 1);
+  for (int i= 0; i < N (T); i++)
+    T[i]= 0;
+  const char* lab= &label[0];
+  for (int i= 0, l= 0; i < end; goto_next_char (s, i, utf8), l++) {
+    int node= 0;
+    for (int p= i, len= 1; p < end && len < MAX_SEARCH; len++) {
+      int q= p;
+      if (utf8) goto_next_char (s, q, utf8);
+      else q++;
+      for (; p < q && node >= 0; p++) {
+        int c= first[node], c_end= c + count[node];
+        while (c < c_end && lab[c] != s[p])
+          c++;
+        node= (c < c_end ? c : -1);
+      }
+      if (node < 0) break;
+      int w= weight[node];
+      if (w >= 0) {
+        int klen= (int) weights[w];
+        for (int j= 0; j <= len && j <= klen; j++) {
+          int m= (int) weights[w + j + 1];
+          if (m > T[l + j]) T[l + j]= m;
         }
       }
+    }
+  }
 
-    array<int> penalty (N (T) - 4);
-    for (i= 2; i < N (T) - 4; i++)
-      penalty[i - 2]= (((T[i] & 1) == 1) ? HYPH_STD : HYPH_INVALID);
-    if (N (penalty) > 0) penalty[0]= penalty[N (penalty) - 1]= HYPH_INVALID;
-    if (N (penalty) > 1) penalty[1]= penalty[N (penalty) - 2]= HYPH_INVALID;
-    if (N (penalty) > 2) penalty[N (penalty) - 3]= HYPH_INVALID;
-    // cout << s << " --> " << penalty << "\n";
-    return penalty;
+  array<int> penalty (N (T) - 4);
+  for (int i= 2; i < N (T) - 4; i++)
+    penalty[i - 2]= (((T[i] & 1) == 1) ? HYPH_STD : HYPH_INVALID);
+  if (N (penalty) > 0) penalty[0]= penalty[N (penalty) - 1]= HYPH_INVALID;
+  if (N (penalty) > 1) penalty[1]= penalty[N (penalty) - 2]= HYPH_INVALID;
+  if (N (penalty) > 2) penalty[N (penalty) - 3]= HYPH_INVALID;
+  // cout << s << " --> " << penalty << "\n";
+  return penalty;
+}
+
+void
+hyphen_table_rep::cache_unlink (int k) {
+  if (cache_prev[k] >= 0) cache_next[cache_prev[k]]= cache_next[k];
+  else cache_first= cache_next[k];
+  if (cache_next[k] >= 0) cache_prev[cache_next[k]]= cache_prev[k];
+  else cache_last= cache_prev[k];
+}
+
+void
+hyphen_table_rep::cache_push (int k) {
+  cache_prev[k]= -1;
+  cache_next[k]= cache_first;
+  if (cache_first >= 0) cache_prev[cache_first]= k;
+  else cache_last= k;
+  cache_first= k;
+}
+
+array<int>
+hyphen_table_rep::get_hyphens (string s) {
+  int k= cache_slot[s];
+  if (k >= 0) {
+    if (k != cache_first) {
+      cache_unlink (k);
+      cache_push (k);
+    }
+    return cache_hyphens[k];
+  }
+  array<int> penalty= compute_hyphens (s);
+  if (N (cache_word) < HYPHEN_CACHE_SIZE) {
+    k= N (cache_word);
+    cache_word << s;
+    cache_hyphens << penalty;
+    cache_prev << -1;
+    cache_next << -1;
   }
   else {
-    s= "." * s * ".";
-    // cout << s << "\n";
-    int        i, j, k, l, m, len;
-    array<int> T (N (s) + 1);
-    for (i= 0; i < N (T); i++)
-      T[i]= 0;
-    for (len= 1; len < MAX_SEARCH; len++)
-      for (i= 0, l= 0; i < N (s) - len; goto_next_char (s, i, utf8), l++) {
-        string r= patterns[s (i, i + len)];
-        if (!(r == "?")) {
-          // cout << "  " << s (i, i+len) << " => " << r << "\n";
-          for (j= 0, k= 0; j <= len; j++, k++) {
-            if (k < N (r) && is_digit (r[k])) {
-              m= ((int) r[k]) - ((int) '0');
-              k++;
-            }
-            else m= 0;
-            if (m > T[l + j]) T[l + j]= m;
-          }
-        }
-      }
-
-    array<int> penalty (N (T) - 4);
-    for (i= 2; i < N (T) - 4; i++)
-      penalty[i - 2]= (((T[i] & 1) == 1) ? HYPH_STD : HYPH_INVALID);
-    if (N (penalty) > 0) penalty[0]= penalty[N (penalty) - 1]= HYPH_INVALID;
-    if (N (penalty) > 1) penalty[1]= penalty[N (penalty) - 2]= HYPH_INVALID;
-    if (N (penalty) > 2) penalty[N (penalty) - 3]= HYPH_INVALID;
-    // cout << s << " --> " << penalty << "\n";
-    return penalty;
+    k= cache_last;
+    cache_unlink (k);
+    cache_slot->reset (cache_word[k]);
+    cache_word[k]   = s;
+    cache_hyphens[k]= penalty;
   }
+  cache_slot (s)= k;
+  cache_push (k);
+  return penalty;
+}
+
+array<int>
+get_hyphens (string s, hyphen_table table) {
+  return table->get_hyphens (s);
 }
 
 void
@@ -13,13 +13,57 @@
 #define HYPHENATE_H
 #include "language.hpp"
 
-void       load_hyphen_tables (string                   language_name,
-                               hashmap<string, string>& patterns,
-                               hashmap<string, string>& hyphenations, bool toCork);
-array<int> get_hyphens (string s, hashmap<string, string> patterns,
-                        hashmap<string, string> hyphenations);
-array<int> get_hyphens (string s, hashmap<string, string> patterns,
-                        hashmap<string, string> hyphenations, bool utf8);
+/******************************************************************************
+ * Compiled hyphenation tables
+ *
+ * The patterns are packed into a trie over the bytes of their letters:
+ * the children of a node are consecutive and sorted on their label, so that
+ * all patterns starting at a given position are found in a single walk.
+ * Hyphenated words are kept in a bounded cache, the least recently used
+ * word being evicted first.
+ ******************************************************************************/
+
+#define HYPHEN_CACHE_SIZE 4096
+
+class hyphen_table;
+struct hyphen_table_rep : concrete_struct {
+  bool                    utf8;         // words and patterns are in utf8
+  string                  label;        // byte leading to each node
+  array<int>              first;        // first child of each node
+  array<int>              count;        // number of children of each node
+  array<int>              weight;       // offset of weights or -1
+  string                  weights;      // length and digits of patterns
+  hashmap<string, string> hyphenations; // exceptional words
+
+  hashmap<string, int> cache_slot; // slot of each cached word
+  array<string>        cache_word;
+  array<array<int>>    cache_hyphens;
+  array<int>           cache_prev; // previous slot, in order of use
+  array<int>           cache_next; // next slot, in order of use
+  int                  cache_first;
+  int                  cache_last;
+
+  hyphen_table_rep (hashmap<string, string> patterns,
+                    hashmap<string, string> hyphenations, bool utf8);
+  array<int> get_hyphens (string s);
+  array<int> compute_hyphens (string s);
+  void       cache_unlink (int k);
+  void       cache_push (int k);
+};
+
+class hyphen_table {
+  CONCRETE (hyphen_table);
+  hyphen_table (hashmap<string, string> patterns,
+                hashmap<string, string> hyphenations, bool utf8);
+};
+CONCRETE_CODE (hyphen_table);
+
+void         load_hyphen_tables (string                   language_name,
+                                 hashmap<string, string>& patterns,
+                                 hashmap<string, string>& hyphenations,
+                                 bool                     toCork);
+hyphen_table load_hyphen_table (string language_name, bool toCork);
+array<int>   get_hyphens (string s, hyphen_table table);
 void std_hyphenate (string s, int after, string& left, string& right, int pen);
 void std_hyphenate (string s, int after, string& left, string& right, int pen,
                     bool utf8);
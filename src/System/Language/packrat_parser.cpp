@@ -30,37 +30,65 @@ packrat_parser_rep::packrat_parser_rep (packrat_grammar gr)
       productions (gr->productions), properties (gr->properties),
       current_tree (packrat_uninit), current_string (""), current_start (-1),
       current_end (-1), current_path_pos (-1), current_pos_path (-1),
-      current_cursor (-1), current_input (), current_cache (PACKRAT_UNDEFINED),
-      current_production (packrat_uninit) {}
+      current_cursor (-1), current_input (), current_cache (),
+      current_reach (0), current_production (packrat_uninit),
+      former_cache (1), former_prefix (-1), former_suffix (PACKRAT_EVERYWHERE),
+      former_delta (0) {}
+
+/******************************************************************************
+ * Recently used parsers
+ ******************************************************************************/
+
+#define PACKRAT_PARSERS 16
+
+struct packrat_recent {
+  string         lan;
+  tree           in;
+  path           in_pos;
+  int            h;
+  packrat_parser par;
+};
 
 packrat_parser
-make_packrat_parser (string lan, tree in) {
-  static string         last_lan= "";
-  static tree           last_in = "";
-  static packrat_parser last_par;
-  if (lan != last_lan || in != last_in) {
-    packrat_grammar gr= find_packrat_grammar (lan);
-    last_lan          = lan;
-    last_in           = copy (in);
-    last_par          = packrat_parser (gr, last_in);
+make_packrat_parser (string lan, tree in, path in_pos) {
+  // typesetting and correction alternate between a few formulas,
+  // so keep the parsers for the most recently used inputs
+  static packrat_recent recent[PACKRAT_PARSERS];
+  static int            n= 0;
+  int                   h= hash (in);
+  int                   i;
+  for (i= 0; i < n; i++)
+    if (recent[i].h == h && recent[i].lan == lan &&
+        recent[i].in_pos == in_pos && recent[i].in == in)
+      break;
+  if (i == n) {
+    packrat_grammar gr = find_packrat_grammar (lan);
+    tree            cin= copy (in);
+    packrat_parser  par (gr, cin, copy (in_pos));
+    // an edited formula is usually parsed right after its former version
+    for (int j= 0; j < n; j++)
+      if (recent[j].lan == lan) {
+        par->inherit_cache (recent[j].par);
+        break;
+      }
+    if (n < PACKRAT_PARSERS) n++;
+    i                = n - 1;
+    recent[i].lan    = lan;
+    recent[i].in     = cin;
+    recent[i].in_pos = copy (in_pos);
+    recent[i].h      = h;
+    recent[i].par    = par;
   }
-  return last_par;
+  packrat_recent r= recent[i];
+  for (; i > 0; i--)
+    recent[i]= recent[i - 1];
+  recent[0]= r;
+  return r.par;
 }
 
 packrat_parser
-make_packrat_parser (string lan, tree in, path in_pos) {
-  static string         last_lan   = "";
-  static tree           last_in    = "";
-  static path           last_in_pos= path ();
-  static packrat_parser last_par;
-  if (lan != last_lan || in != last_in || in_pos != last_in_pos) {
-    packrat_grammar gr= find_packrat_grammar (lan);
-    last_lan          = lan;
-    last_in           = copy (in);
-    last_in_pos       = copy (in_pos);
-    last_par          = packrat_parser (gr, last_in, last_in_pos);
-  }
-  return last_par;
+make_packrat_parser (string lan, tree in) {
+  return make_packrat_parser (lan, in, path ());
 }
 
 /******************************************************************************
@@ -162,6 +190,45 @@ packrat_parser_rep::decode_tree_position (C pos) {
   return decode_path (current_tree, path (), i);
 }
 
+/******************************************************************************
+ * Memo tables
+ ******************************************************************************/
+
+packrat_memo::packrat_memo (int size) : slots (size), n (0) {
+  packrat_memo_entry* a= A (slots);
+  for (int i= 0; i < size; i++)
+    a[i].sym= PACKRAT_UNDEFINED;
+}
+
+void
+packrat_memo::resize (int size) {
+  array<packrat_memo_entry> old= slots;
+  packrat_memo_entry*       a  = A (old);
+  slots                        = packrat_memo (size).slots;
+  n                            = 0;
+  for (int i= 0; i < N (old); i++)
+    if (a[i].sym != PACKRAT_UNDEFINED)
+      set (a[i].sym, a[i].pos, a[i].next, a[i].reach);
+}
+
+void
+packrat_memo::set (C sym, C pos, C next, C reach) {
+  int i= find (sym, pos);
+  if (i < 0) {
+    if (2 * (n + 1) > N (slots)) resize (2 * N (slots));
+    int mask= N (slots) - 1;
+    i       = packrat_memo_hash (sym, pos) & mask;
+    while (slots[i].sym != PACKRAT_UNDEFINED)
+      i= (i + 1) & mask;
+    n++;
+  }
+  packrat_memo_entry& e= slots[i];
+  e.sym                = sym;
+  e.pos                = pos;
+  e.next               = next;
+  e.reach              = reach;
+}
+
 /******************************************************************************
  * Packrat parsing
  ******************************************************************************/
@@ -171,15 +238,29 @@ starts (tree t, string s) {
   return is_atomic (t) && starts (t->label, s);
 }
 
+inline void
+packrat_parser_rep::examine (C pos) {
+  // the result being computed depends on the input at pos
+  if (pos >= current_reach) current_reach= pos + 1;
+}
+
 C
 packrat_parser_rep::parse (C sym, C pos) {
-  D key= (((D) sym) << 32) + ((D) (sym ^ pos));
-  C im = current_cache[key];
-  if (im != PACKRAT_UNDEFINED) {
-    // cout << "Cached " << sym << " at " << pos << " -> " << im << LF;
-    return im;
+  int slot= current_cache.find (sym, pos);
+  if (slot < 0 && (pos <= former_prefix || pos >= former_suffix))
+    slot= inherit (sym, pos);
+  if (slot >= 0) {
+    packrat_memo_entry& e= current_cache.slots[slot];
+    // cout << "Cached " << sym << " at " << pos << " -> " << e.next << LF;
+    // a symbol which is still being parsed depends on its context
+    if (e.reach == PACKRAT_IN_PROGRESS) current_reach= PACKRAT_EVERYWHERE;
+    else if (e.reach > current_reach) current_reach= e.reach;
+    return e.next;
   }
-  current_cache (key)= PACKRAT_FAILED;
+  current_cache.set (sym, pos, PACKRAT_FAILED, PACKRAT_IN_PROGRESS);
+  C outer_reach= current_reach;
+  C im;
+  current_reach= pos;
   if (DEBUG_PACKRAT)
     debug_packrat << "Parse " << packrat_decode[sym] << " at " << pos << INDENT
                   << LF;
@@ -219,6 +300,7 @@ packrat_parser_rep::parse (C sym, C pos) {
         }
       break;
     case PACKRAT_RANGE:
+      examine (pos);
       if (pos < N (current_input) && current_input[pos] >= inst[1] &&
           current_input[pos] <= inst[2])
         im= pos + 1;
@@ -234,6 +316,7 @@ packrat_parser_rep::parse (C sym, C pos) {
         if (parse (inst[2], pos) != PACKRAT_FAILED) im= PACKRAT_FAILED;
       break;
     case PACKRAT_TM_OPEN:
+      examine (pos);
       if (pos < N (current_input) &&
           starts (packrat_decode[current_input[pos]], "<\\"))
         im= pos + 1;
@@ -257,6 +340,7 @@ packrat_parser_rep::parse (C sym, C pos) {
       while (im < N (current_input))
         if (current_input[im] != encode_token ("<|>")) break;
         else im= parse (PACKRAT_TM_ANY, im + 1);
+      examine (im);
       break;
     case PACKRAT_TM_LEAF:
       im= pos;
@@ -265,8 +349,10 @@ packrat_parser_rep::parse (C sym, C pos) {
         if (starts (t, "<\\") || t == "<|>" || t == "</>") break;
         else im++;
       }
+      examine (im);
       break;
     case PACKRAT_TM_CHAR:
+      examine (pos);
       if (pos >= N (current_input)) im= PACKRAT_FAILED;
       else {
         tree t= packrat_decode[current_input[pos]];
@@ -287,16 +373,68 @@ packrat_parser_rep::parse (C sym, C pos) {
     }
   }
   else {
+    examine (pos);
     if (pos < N (current_input) && current_input[pos] == sym) im= pos + 1;
     else im= PACKRAT_FAILED;
   }
-  current_cache (key)= im;
+  current_cache.set (sym, pos, im, current_reach);
+  if (outer_reach > current_reach) current_reach= outer_reach;
   if (DEBUG_PACKRAT)
     debug_packrat << UNINDENT << "Parsed " << packrat_decode[sym] << " at "
                   << pos << " -> " << im << LF;
   return im;
 }
 
+/******************************************************************************
+ * Reusing the results for a former version of the input
+ ******************************************************************************/
+
+void
+packrat_parser_rep::inherit_cache (packrat_parser old) {
+  // results which only depend on the unchanged beginning or end of the input
+  // remain valid, up to a shift of the positions at the end
+  if (current_cursor != -1 || old->current_cursor != -1) return;
+  array<C> a= old->current_input, b= current_input;
+  int      na= N (a), nb= N (b), p= 0, s= 0;
+  while (p < na && p < nb && a[p] == b[p])
+    p++;
+  while (s < na - p && s < nb - p && a[na - 1 - s] == b[nb - 1 - s])
+    s++;
+  if (p + s == 0) return;
+  former_cache = old->current_cache;
+  former_prefix= p;
+  former_suffix= nb - s;
+  former_delta = nb - na;
+}
+
+int
+packrat_parser_rep::inherit (C sym, C pos) {
+  // the results for the former input are only looked up when needed
+  int i= -1;
+  if (pos <= former_prefix) {
+    i= former_cache.find (sym, pos);
+    if (i >= 0) {
+      packrat_memo_entry& e= former_cache.slots[i];
+      if (e.reach == PACKRAT_IN_PROGRESS || e.reach > former_prefix) i= -1;
+      else current_cache.set (sym, pos, e.next, e.reach);
+    }
+  }
+  if (i < 0 && pos >= former_suffix) {
+    i= former_cache.find (sym, pos - former_delta);
+    if (i >= 0) {
+      packrat_memo_entry& e= former_cache.slots[i];
+      if (e.reach == PACKRAT_IN_PROGRESS || e.reach == PACKRAT_EVERYWHERE)
+        i= -1;
+      else {
+        C next= (e.next == PACKRAT_FAILED ? e.next : e.next + former_delta);
+        current_cache.set (sym, pos, next, e.reach + former_delta);
+      }
+    }
+  }
+  if (i < 0) return -1;
+  return current_cache.find (sym, pos);
+}
+
 /******************************************************************************
  * Inspecting the parse tree
  ******************************************************************************/
@@ -17,6 +17,56 @@
 
 #define PACKRAT_UNDEFINED ((C) (-2))
 #define PACKRAT_FAILED ((C) (-1))
+#define PACKRAT_IN_PROGRESS ((C) (-1))
+#define PACKRAT_EVERYWHERE ((C) 0x7fffffff)
+
+/******************************************************************************
+ * Memo tables with the results of parsing a symbol at a position
+ ******************************************************************************/
+
+struct packrat_memo_entry {
+  C sym;   // parsed symbol or PACKRAT_UNDEFINED for free slots
+  C pos;   // start position in the input
+  C next;  // end position or PACKRAT_FAILED
+  C reach; // end of the examined part of the input or PACKRAT_IN_PROGRESS
+};
+
+class packrat_memo {
+public:
+  array<packrat_memo_entry> slots; // open addressing with linear probing
+  int                       n;     // number of used slots
+
+public:
+  packrat_memo (int size= 64);
+  inline int find (C sym, C pos);
+  void       set (C sym, C pos, C next, C reach);
+  void       resize (int size);
+};
+
+inline int
+packrat_memo_hash (C sym, C pos) {
+  unsigned int h= ((unsigned int) sym) * 2654435761U;
+  h^= ((unsigned int) pos) * 2246822519U;
+  return (int) (h ^ (h >> 15));
+}
+
+inline int
+packrat_memo::find (C sym, C pos) {
+  packrat_memo_entry* a   = A (slots);
+  int                 mask= N (slots) - 1;
+  int                 i   = packrat_memo_hash (sym, pos) & mask;
+  while (a[i].sym != PACKRAT_UNDEFINED) {
+    if (a[i].sym == sym && a[i].pos == pos) return i;
+    i= (i + 1) & mask;
+  }
+  return -1;
+}
+
+/******************************************************************************
+ * Packrat parsers
+ ******************************************************************************/
+
+class packrat_parser;
 
 class packrat_parser_rep : concrete_struct {
 public:
@@ -36,9 +86,15 @@ public:
   int                current_hl_lan;
 
   array<C>         current_input;
-  hashmap<D, C>    current_cache;
+  packrat_memo     current_cache;
+  C                current_reach;
   hashmap<D, tree> current_production;
 
+  packrat_memo former_cache;  // memo table for a former version of the input
+  C            former_prefix; // length of the unchanged beginning
+  C            former_suffix; // start of the unchanged end in the input
+  C            former_delta;  // shift of the positions in the unchanged end
+
 protected:
   void serialize_atomic (tree t, path p);
   void serialize_compound (tree t, path p);
@@ -47,6 +103,8 @@ protected:
   void set_cursor (path t_pos);
   path decode_path (tree t, path p, int pos);
   int  encode_path (tree t, path p, path pos);
+  void examine (C pos);
+  int  inherit (C sym, C pos);
 
 public:
   packrat_parser_rep (packrat_grammar gr);
@@ -56,6 +114,7 @@ public:
   path decode_tree_position (C pos);
   C    encode_tree_position (path p);
   C    parse (C sym, C pos);
+  void inherit_cache (packrat_parser old);
 
   void inspect (C sym, C pos, array<C>& syms, array<C>& poss);
   bool is_left_recursive (C sym);
@@ -22,8 +22,7 @@
  ******************************************************************************/
 
 struct text_language_rep : language_rep {
-  hashmap<string, string> patterns;
-  hashmap<string, string> hyphenations;
+  hyphen_table hyphens;
 
   text_language_rep (string lan_name, string hyph_name);
   text_property advance (tree t, int& pos);
@@ -32,9 +31,7 @@ struct text_language_rep : language_rep {
 };
 
 text_language_rep::text_language_rep (string lan_name, string hyph_name)
-    : language_rep (lan_name), patterns ("?"), hyphenations ("?") {
-  load_hyphen_tables (hyph_name, patterns, hyphenations, true);
-}
+    : language_rep (lan_name), hyphens (load_hyphen_table (hyph_name, true)) {}
 
 text_property
 text_language_rep::advance (tree t, int& pos) {
@@ -108,7 +105,7 @@ text_language_rep::advance (tree t, int& pos) {
 
 array<int>
 text_language_rep::get_hyphens (string s) {
-  return ::get_hyphens (s, patterns, hyphenations);
+  return ::get_hyphens (s, hyphens);
 }
 
 void
@@ -123,8 +120,7 @@ text_language_rep::hyphenate (string s, int after, string& left,
  ******************************************************************************/
 
 struct french_language_rep : language_rep {
-  hashmap<string, string> patterns;
-  hashmap<string, string> hyphenations;
+  hyphen_table hyphens;
 
   french_language_rep (string lan_name, string hyph_name);
   text_property advance (tree t, int& pos);
@@ -133,9 +129,7 @@ struct french_language_rep : language_rep {
 };
 
 french_language_rep::french_language_rep (string lan_name, string hyph_name)
-    : language_rep (lan_name), patterns ("?"), hyphenations ("?") {
-  load_hyphen_tables (hyph_name, patterns, hyphenations, true);
-}
+    : language_rep (lan_name), hyphens (load_hyphen_table (hyph_name, true)) {}
 
 inline bool
 is_french_punctuation (char c) {
@@ -216,7 +210,7 @@ french_language_rep::advance (tree t, int& pos) {
 
 array<int>
 french_language_rep::get_hyphens (string s) {
-  return ::get_hyphens (s, patterns, hyphenations);
+  return ::get_hyphens (s, hyphens);
 }
 
 void
@@ -231,8 +225,7 @@ french_language_rep::hyphenate (string s, int after, string& left,
  ******************************************************************************/
 
 struct ucs_text_language_rep : language_rep {
-  hashmap<string, string> patterns;
-  hashmap<string, string> hyphenations;
+  hyphen_table hyphens;
 
   ucs_text_language_rep (string lan_name, string hyph_name);
   text_property advance (tree t, int& pos);
@@ -242,9 +235,7 @@ struct ucs_text_language_rep : language_rep {
 };
 
 ucs_text_language_rep::ucs_text_language_rep (string lan_name, string hyph_name)
-    : language_rep (lan_name), patterns ("?"), hyphenations ("?") {
-  load_hyphen_tables (hyph_name, patterns, hyphenations, false);
-}
+    : language_rep (lan_name), hyphens (load_hyphen_table (hyph_name, false)) {}
 
 text_property
 ucs_text_language_rep::advance (tree t, int& pos) {
@@ -312,7 +303,7 @@ ucs_text_language_rep::advance (tree t, int& pos) {
 
 array<int>
 ucs_text_language_rep::get_hyphens (string s) {
-  return ::get_hyphens (s, patterns, hyphenations, true);
+  return ::get_hyphens (s, hyphens);
 }
 
 void
@@ -462,8 +453,7 @@ oriental_language_rep::hyphenate (string s, int after, string& left,
 struct chinese_language_rep : language_rep {
   hashset<string>         do_not_start;
   hashset<string>         do_not_end;
-  hashmap<string, string> en_patterns;
-  hashmap<string, string> en_hyphenations;
+  hyphen_table            en_hyphens;
   chinese_language_rep (string lan_name);
   text_property advance (tree t, int& pos);
   array<int>    get_hyphens (string s);
@@ -472,10 +462,7 @@ struct chinese_language_rep : language_rep {
 
 chinese_language_rep::chinese_language_rep (string lan_name)
     : language_rep (lan_name), do_not_start (), do_not_end (),
-      en_patterns ("?"), en_hyphenations ("?") {
-  // 在构造函数中加载英文断字表，与英文语言实现方式一致
-  load_hyphen_tables ("us", en_patterns, en_hyphenations, true);
-
+      en_hyphens (load_hyphen_table ("us", true)) {
   // half width
   do_not_start << string (".") << string (",") << string (":") << string (";")
                << string ("!") << string ("?") << string ("/") << string ("-");
@@ -587,8 +574,7 @@ chinese_language_rep::get_hyphens (string s) {
     // 对英文单词应用断字规则，与英文语言实现方式一致
     string word= s (start, pos);
     if (N (word) > 0) {
-      array<int> word_penalty=
-          ::get_hyphens (word, en_patterns, en_hyphenations);
+      array<int> word_penalty= ::get_hyphens (word, en_hyphens);
       for (j= 0; j < N (word_penalty) && start + j < N (penalty); j++) {
         if (word_penalty[j] < HYPH_INVALID) penalty[start + j]= word_penalty[j];
       }
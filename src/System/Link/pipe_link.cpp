@@ -64,6 +64,7 @@ struct pipe_link_rep : tm_link_rep {
 
   string outbuf; // pending output from plugin
   string errbuf; // pending errors from plugin
+  string chunk;  // buffer for reading, grown while the plugin keeps it full
 
   socket_notifier snout, snerr;
 
@@ -89,6 +90,7 @@ pipe_link_rep::pipe_link_rep (string cmd2) : cmd (cmd2) {
   err= pp_err[0]= pp_err[1]= -1;
   outbuf                   = "";
   errbuf                   = "";
+  chunk                    = string (LINK_MIN_CHUNK);
   alive                    = false;
 }
 
@@ -243,10 +245,9 @@ void
 pipe_link_rep::feed (int channel) {
 #if !defined(OS_MINGW) && !defined(OS_WIN)
   if ((!alive) || ((channel != LINK_OUT) && (channel != LINK_ERR))) return;
-  int  r;
-  char tempout[1024];
-  if (channel == LINK_OUT) r= ::read (out, tempout, 1024);
-  else r= ::read (err, tempout, 1024);
+  int r, n= N (chunk);
+  if (channel == LINK_OUT) r= ::read (out, &(chunk[0]), n);
+  else r= ::read (err, &(chunk[0]), n);
   if (r == -1) {
     io_error << "Read failed for '" << cmd << "'\n";
     wait (NULL);
@@ -262,9 +263,11 @@ pipe_link_rep::feed (int channel) {
     remove_notifier (snerr);
   }
   else {
-    if (DEBUG_IO) debug_io << debug_io_string (string (tempout, r));
-    if (channel == LINK_OUT) outbuf << string (tempout, r);
-    else errbuf << string (tempout, r);
+    string s= chunk (0, r);
+    if (DEBUG_IO) debug_io << debug_io_string (s);
+    if (channel == LINK_OUT) outbuf << s;
+    else errbuf << s;
+    if (r == n && n < LINK_MAX_CHUNK) chunk= string (2 * n);
   }
 #endif
 }
@@ -47,6 +47,7 @@ socket_link_rep::socket_link_rep (string host2, int port2, int type2, int fd)
   socket_link_set->insert ((pointer) this);
   io    = fd;
   outbuf= "";
+  chunk = string (LINK_MIN_CHUNK);
   alive = (fd != -1);
   if (type == SOCKET_SERVER) {
     sn= socket_notifier (io, &socket_callback, this, NULL);
@@ -244,8 +245,8 @@ socket_link_rep::feed (int channel) {
   using namespace wsoc;
 #endif
   if ((!alive) || (channel != LINK_OUT)) return;
-  char tempout[1024];
-  int  r= recv (io, tempout, 1024, 0);
+  int n= N (chunk);
+  int r= recv (io, &(chunk[0]), n, 0);
   if (r <= 0) {
     if (r == 0) debug_io << host << ":" << port << "' hung up\n";
     else
@@ -254,8 +255,10 @@ socket_link_rep::feed (int channel) {
     stop ();
   }
   else if (r != 0) {
-    if (DEBUG_IO) debug_io << debug_io_string (string (tempout, r));
-    outbuf << string (tempout, r);
+    string s= chunk (0, r);
+    if (DEBUG_IO) debug_io << debug_io_string (s);
+    outbuf << s;
+    if (r == n && n < LINK_MAX_CHUNK) chunk= string (2 * n);
 #ifdef QT_CPU_FIX
     tm_wake_up ();
 #endif
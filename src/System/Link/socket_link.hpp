@@ -24,6 +24,7 @@ struct socket_link_rep : tm_link_rep {
   int    type;   // socket type
   int    io;     // file descriptor for data going to the child
   string outbuf; // pending output from plugin
+  string chunk;  // buffer for reading, grown while the peer keeps it full
 
   socket_notifier sn;
 
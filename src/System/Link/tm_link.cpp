@@ -17,29 +17,20 @@
  * Sending data by packets
  ******************************************************************************/
 
-static bool
-message_complete (string s) {
-  int start= 0;
+static int
+message_header (string s, int pos, int& len, bool& handshake) {
+  // Parse the header "[!]<len>\n" of the packet starting at pos and return
+  // the position of its payload, or -1 if the packet is still incomplete
+  int start= pos;
   int i, n= N (s);
-  if (n > 0 && s[0] == '!') start= 1;
+  if (pos < n && s[pos] == '!') start++;
   for (i= start; i < n; i++)
     if (s[i] == '\n') break;
-  if (i == n) return false;
-  return (n - (i + 1)) >= as_int (s (start, i));
-}
-
-static string
-message_receive (string& s) {
-  int start= 0;
-  int i, n= N (s);
-  if (n > 0 && s[0] == '!') start= 1;
-  for (i= start; i < n; i++)
-    if (s[i] == '\n') break;
-  if (i == n) return "";
-  int    l= as_int (s (start, i++));
-  string r= s (i, i + l);
-  s       = s (i + l, n);
-  return r;
+  if (i == n) return -1;
+  len      = max (as_int (s (start, i)), 0);
+  handshake= (start > pos);
+  if (n - (i + 1) < len) return -1;
+  return i + 1;
 }
 
 void
@@ -48,10 +39,32 @@ tm_link_rep::write_packet (string s, int channel) {
   write ((as_string (N (s)) * "\n") * s, channel);
 }
 
+void
+tm_link_rep::take_packets (int channel) {
+  // Move all complete packets at the start of watch (channel) into the
+  // queue of unread packets, so that the pending data are only shifted
+  // once for each batch of packets which arrived together
+  if (channel != LINK_OUT && channel != LINK_ERR) return;
+  string& s  = watch (channel);
+  int     pos= 0, n= N (s);
+  while (pos < n) {
+    int  len;
+    bool handshake;
+    int  i= message_header (s, pos, len, handshake);
+    if (i < 0) break;
+    packets[channel] << s (i, i + len);
+    handshakes[channel] << (handshake && channel == LINK_OUT);
+    pos= i + len;
+  }
+  if (pos == n) s= "";
+  else if (pos > 0) s= s (pos, n);
+}
+
 bool
 tm_link_rep::complete_packet (int channel) {
-  string s= watch (channel);
-  return message_complete (s);
+  if (channel != LINK_OUT && channel != LINK_ERR) return false;
+  take_packets (channel);
+  return next[channel] < N (packets[channel]);
 }
 
 string
@@ -59,17 +72,27 @@ tm_link_rep::read_packet (int channel, int timeout, bool& success) {
   success      = false;
   string& r    = watch (channel);
   time_t  start= texmacs_time ();
-  while (!message_complete (r)) {
+  while (!complete_packet (channel)) {
     int n= N (r);
     if (timeout > 0) listen (timeout);
     if (N (r) == n && (texmacs_time () - start >= timeout)) return "";
   }
-  if (channel == LINK_OUT && N (r) > 0 && r[0] == '!') {
-    secure_server (message_receive (r));
+  array<string>& a        = packets[channel];
+  array<bool>&   h        = handshakes[channel];
+  int            k        = next[channel]++;
+  string         back     = a[k];
+  bool           handshake= h[k];
+  a[k]                    = "";
+  if (2 * next[channel] >= N (a)) {
+    a            = range (a, next[channel], N (a));
+    h            = range (h, next[channel], N (h));
+    next[channel]= 0;
+  }
+  if (handshake) {
+    secure_server (back);
     return "";
   }
   else {
-    string back= message_receive (r);
     if (secret != "") back= secret_decode (back, secret);
     success= true;
     return back;
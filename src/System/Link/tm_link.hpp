@@ -29,6 +29,9 @@
 #define LINK_OUT 0
 #define LINK_ERR 1
 
+#define LINK_MIN_CHUNK 4096
+#define LINK_MAX_CHUNK 65536
+
 #define SOCKET_DEFAULT 0
 #define SOCKET_CLIENT 1
 #define SOCKET_SERVER 2
@@ -43,8 +46,12 @@ struct tm_link_rep : abstract_struct {
 
   command feed_cmd; // called when async data available
 
+  array<string> packets[2];    // complete packets taken from watch (channel)
+  array<bool>   handshakes[2]; // which of these packets are key exchanges
+  int           next[2];       // index of the first unread packet
+
 public:
-  inline tm_link_rep () {}
+  inline tm_link_rep () { next[LINK_OUT]= next[LINK_ERR]= 0; }
   inline virtual ~tm_link_rep () {}
 
   virtual string  start ()                     = 0;
@@ -56,6 +63,7 @@ public:
   virtual void    stop ()                      = 0;
 
   void   write_packet (string s, int channel);
+  void   take_packets (int channel);
   bool   complete_packet (int channel);
   string read_packet (int channel, int timeout, bool& success);
   void   secure_server (string cmd);
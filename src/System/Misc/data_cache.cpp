@@ -16,24 +16,255 @@
 #include "tm_file.hpp"
 #include "tree_helper.hpp"
 #include <moebius/data/scheme.hpp>
+#include <string.h>
+
+#if !defined(OS_WIN) && !defined(OS_MINGW) && !defined(OS_WASM)
+#define CACHE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 using moebius::data::scheme_to_tree;
 using moebius::data::tree_to_scheme;
 
+/******************************************************************************
+ * Binary cache files
+ *
+ * Layout (all integers are 32 bit little endian):
+ *   header: magic "TMCACHE", format version, number of entries and slots
+ *   slots:  (hash, key offset, value offset) triples, open addressing with
+ *           linear probing; a zero key offset marks an empty slot
+ *   pool:   interned strings, each one a length followed by its characters
+ * Keys and values are stored in their Scheme notation and only parsed
+ * when they are looked up.
+ ******************************************************************************/
+
+#define CACHE_MAGIC "TMCACHE"
+#define CACHE_FORMAT_VERSION 1
+#define CACHE_HEADER_SIZE 20
+#define CACHE_SLOT_SIZE 12
+
+static inline uint32_t
+cache_hash (string s) {
+  uint32_t h= 2166136261u;
+  for (int i= 0; i < N (s); i++)
+    h= (h ^ ((uint32_t) (unsigned char) s[i])) * 16777619u;
+  return h;
+}
+
+static inline void
+write_uint32 (string& s, uint32_t i) {
+  s << (char) (i & 255) << (char) ((i >> 8) & 255) << (char) ((i >> 16) & 255)
+    << (char) ((i >> 24) & 255);
+}
+
+static inline uint32_t
+read_uint32 (const char* a) {
+  const unsigned char* b= (const unsigned char*) a;
+  return ((uint32_t) b[0]) | (((uint32_t) b[1]) << 8) |
+         (((uint32_t) b[2]) << 16) | (((uint32_t) b[3]) << 24);
+}
+
+static string
+binary_cache_encode (array<string> keys, array<string> vals) {
+  int      n    = N (keys);
+  uint32_t slots= 16;
+  while (slots < (uint32_t) (2 * n))
+    slots<<= 1;
+  uint32_t             pool_start= CACHE_HEADER_SIZE + CACHE_SLOT_SIZE * slots;
+  array<uint32_t>      table (3 * slots);
+  string               pool;
+  hashmap<string, int> interned (0);
+  for (uint32_t i= 0; i < 3 * slots; i++)
+    table[i]= 0;
+  for (int i= 0; i < n; i++) {
+    uint32_t off[2];
+    for (int j= 0; j < 2; j++) {
+      string x= (j == 0 ? keys[i] : vals[i]);
+      if (!interned->contains (x)) {
+        interned (x)= pool_start + N (pool);
+        write_uint32 (pool, N (x));
+        pool << x;
+      }
+      off[j]= interned[x];
+    }
+    uint32_t h= cache_hash (keys[i]);
+    uint32_t k= h & (slots - 1);
+    while (table[3 * k + 1] != 0)
+      k= (k + 1) & (slots - 1);
+    table[3 * k]    = h;
+    table[3 * k + 1]= off[0];
+    table[3 * k + 2]= off[1];
+  }
+
+  string r (CACHE_MAGIC);
+  r << '\0';
+  write_uint32 (r, CACHE_FORMAT_VERSION);
+  write_uint32 (r, n);
+  write_uint32 (r, slots);
+  for (uint32_t i= 0; i < 3 * slots; i++)
+    write_uint32 (r, table[i]);
+  r << pool;
+  return r;
+}
+
+struct binary_cache_rep : concrete_struct {
+  string      contents; // file contents, when the file could not be mapped
+  const char* data;     // the (mapped) file contents
+  int         size;     // the size of the file
+  uint32_t    slots;    // the number of hash slots
+#ifdef CACHE_MMAP
+  void* mapped; // the mapped region, if any
+#endif
+
+  binary_cache_rep (url u);
+  ~binary_cache_rep ();
+  bool get_string (uint32_t off, string& s);
+  bool find (string key, string& val);
+  void collect (array<string>& keys, array<string>& vals);
+};
+
+class binary_cache {
+  CONCRETE_NULL (binary_cache);
+  binary_cache (url u) : rep (tm_new<binary_cache_rep> (u)) {}
+};
+CONCRETE_NULL_CODE (binary_cache);
+
+binary_cache_rep::binary_cache_rep (url u) : data (NULL), size (0), slots (0) {
+#ifdef CACHE_MMAP
+  mapped= NULL;
+  c_string path (concretize (u));
+  int      fd= open (path, O_RDONLY);
+  if (fd >= 0) {
+    struct stat st;
+    if (fstat (fd, &st) == 0 && st.st_size > 0 && st.st_size < (1 << 30)) {
+      void* p= mmap (NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (p != MAP_FAILED) {
+        mapped= p;
+        data  = (const char*) p;
+        size  = (int) st.st_size;
+      }
+    }
+    close (fd);
+  }
+#endif
+  if (data == NULL) {
+    if (load_string (u, contents, false)) return;
+    data= contents.begin ();
+    size= N (contents);
+  }
+  if (size < CACHE_HEADER_SIZE || strncmp (data, CACHE_MAGIC, 8) != 0 ||
+      read_uint32 (data + 8) != CACHE_FORMAT_VERSION)
+    return;
+  uint32_t n= read_uint32 (data + 12);
+  uint32_t m= read_uint32 (data + 16);
+  if (m == 0 || (m & (m - 1)) != 0 || n > m ||
+      m > (uint32_t) (size - CACHE_HEADER_SIZE) / CACHE_SLOT_SIZE)
+    return;
+  slots= m;
+}
+
+binary_cache_rep::~binary_cache_rep () {
+#ifdef CACHE_MMAP
+  if (mapped != NULL) munmap (mapped, size);
+#endif
+}
+
+bool
+binary_cache_rep::get_string (uint32_t off, string& s) {
+  if (off < CACHE_HEADER_SIZE || off > (uint32_t) size - 4) return false;
+  uint32_t l= read_uint32 (data + off);
+  if (l > (uint32_t) size - off - 4) return false;
+  s= string (data + off + 4, (int) l);
+  return true;
+}
+
+bool
+binary_cache_rep::find (string key, string& val) {
+  if (slots == 0) return false;
+  uint32_t    h  = cache_hash (key);
+  uint32_t    k  = h & (slots - 1);
+  const char* tab= data + CACHE_HEADER_SIZE;
+  for (uint32_t probes= 0; probes < slots; probes++) {
+    const char* slot= tab + CACHE_SLOT_SIZE * k;
+    uint32_t    koff= read_uint32 (slot + 4);
+    if (koff == 0) return false;
+    if (read_uint32 (slot) == h) {
+      string skey;
+      if (get_string (koff, skey) && skey == key)
+        return get_string (read_uint32 (slot + 8), val);
+    }
+    k= (k + 1) & (slots - 1);
+  }
+  return false;
+}
+
+void
+binary_cache_rep::collect (array<string>& keys, array<string>& vals) {
+  const char* tab= data + CACHE_HEADER_SIZE;
+  for (uint32_t k= 0; k < slots; k++) {
+    const char* slot= tab + CACHE_SLOT_SIZE * k;
+    uint32_t    koff= read_uint32 (slot + 4);
+    string      key, val;
+    if (koff != 0 && get_string (koff, key) &&
+        get_string (read_uint32 (slot + 8), val)) {
+      keys << key;
+      vals << val;
+    }
+  }
+}
+
+static url
+binary_cache_file (string buffer) {
+  return get_tm_cache_path () * url (buffer * ".bin");
+}
+
 /******************************************************************************
  * Caching routines
  ******************************************************************************/
 
-static hashmap<tree, tree>   cache_data ("?");
-static hashset<string>       cache_loaded;
-static hashset<string>       cache_changed;
-static hashmap<string, bool> cache_valid (false);
+static hashmap<tree, tree>           cache_data ("?");
+static hashset<string>               cache_loaded;
+static hashset<string>               cache_changed;
+static hashmap<string, bool>         cache_valid (false);
+static hashmap<string, binary_cache> cache_binary;
+static hashset<tree>                 cache_removed;
+
+static bool
+cache_lookup (string buffer, tree ckey) {
+  // Entries of binary cache files are only parsed when they are needed
+  if (cache_data->contains (ckey)) return true;
+  if (!cache_binary->contains (buffer)) return false;
+  if (cache_removed->contains (ckey)) return false;
+  string val;
+  if (!cache_binary[buffer]->find (tree_to_scheme (ckey[1]), val))
+    return false;
+  cache_data (ckey)= scheme_to_tree (val);
+  return true;
+}
+
+static void
+cache_unmap (string buffer) {
+  if (!cache_binary->contains (buffer)) return;
+  array<string> keys, vals;
+  cache_binary[buffer]->collect (keys, vals);
+  for (int i= 0; i < N (keys); i++) {
+    tree ckey= tuple (buffer, scheme_to_tree (keys[i]));
+    if (!cache_data->contains (ckey) && !cache_removed->contains (ckey))
+      cache_data (ckey)= scheme_to_tree (vals[i]);
+  }
+  cache_binary->reset (buffer);
+}
 
 void
 cache_set (string buffer, tree key, tree t) {
   tree ckey= tuple (buffer, key);
+  (void) cache_lookup (buffer, ckey);
   if (cache_data[ckey] != t) {
     cache_data (ckey)= t;
+    cache_removed->remove (ckey);
     cache_changed->insert (buffer);
   }
 }
@@ -42,18 +273,20 @@ void
 cache_reset (string buffer, tree key) {
   tree ckey= tuple (buffer, key);
   cache_data->reset (ckey);
+  if (cache_binary->contains (buffer)) cache_removed->insert (ckey);
   cache_changed->insert (buffer);
 }
 
 bool
 is_cached (string buffer, tree key) {
   tree ckey= tuple (buffer, key);
-  return cache_data->contains (ckey);
+  return cache_lookup (buffer, ckey);
 }
 
 tree
 cache_get (string buffer, tree key) {
   tree ckey= tuple (buffer, key);
+  (void) cache_lookup (buffer, ckey);
   return cache_data[ckey];
 }
 
@@ -122,6 +355,8 @@ static string texmacs_font_path_string;
 
 bool
 do_cache_dir (string name) {
+  // nothing is cached before cache_initialize determined the paths
+  if (texmacs_path_string == "") return false;
   return starts (name, texmacs_path_string) ||
          starts (name, texmacs_doc_path_string);
 }
@@ -143,22 +378,48 @@ do_cache_stat_fail (string name) {
  * Saving and loading the cache to/from disk
  ******************************************************************************/
 
+static bool
+cache_replace (url u, string s) {
+  // write a sibling file and rename it over the target, so that other
+  // processes which mapped or are reading the old file keep its inode
+  url tmp= glue (u, "." * as_string (get_process_id ()) * ".tmp");
+  if (save_string (tmp, s)) {
+    remove (tmp);
+    return true;
+  }
+  move (tmp, u);
+  if (exists (tmp)) {
+    remove (tmp);
+    return true;
+  }
+  return false;
+}
+
 void
 cache_save (string buffer) {
   if (cache_changed->contains (buffer)) {
+    // the binary file is about to be replaced, so release our mapping
+    cache_unmap (buffer);
     url            cache_file= get_tm_cache_path () * url (buffer);
     string         cached;
+    array<string>  keys, vals;
     iterator<tree> it= iterate (cache_data);
     cached << "(tuple\n";
     while (it->busy ()) {
       tree ckey= it->next ();
       if (ckey[0] == buffer) {
-        cached << tree_to_scheme (ckey[1]) << " ";
-        cached << tree_to_scheme (cache_data[ckey]) << "\n";
+        string key= tree_to_scheme (ckey[1]);
+        string val= tree_to_scheme (cache_data[ckey]);
+        cached << key << " " << val << "\n";
+        keys << key;
+        vals << val;
       }
     }
     cached << ")";
-    (void) save_string (cache_file, cached);
+    // the text file remains the reference in case the binary file is unusable
+    (void) cache_replace (cache_file, cached);
+    (void) cache_replace (binary_cache_file (buffer),
+                          binary_cache_encode (keys, vals));
     cache_changed->remove (buffer);
   }
 }
@@ -171,19 +432,37 @@ cache_init (string buffer) {
       tree t= scheme_to_tree (string_load (cache_file));
       for (int i= 0; i < N (t) - 1; i+= 2)
         cache_data (tuple (buffer, t[i]))= t[i + 1];
+      cache_changed->insert (buffer);
     }
   }
 }
 
+static bool
+cache_load_binary (string buffer, url cache_file) {
+  url bin_file= binary_cache_file (buffer);
+  if (!exists (bin_file)) return false;
+  if (exists (cache_file) &&
+      last_modified (bin_file) < last_modified (cache_file))
+    return false;
+  binary_cache bc (bin_file);
+  if (bc->slots == 0) return false;
+  cache_binary (buffer)= bc;
+  return true;
+}
+
 void
 cache_load (string buffer) {
   if (!cache_loaded->contains (buffer)) {
     url cache_file= get_tm_cache_path () * url (buffer);
     // cout << "cache_file "<< cache_file << LF;
-    if (exists (cache_file)) {
+    if (cache_load_binary (buffer, cache_file))
+      ;
+    else if (exists (cache_file)) {
       tree t= scheme_to_tree (string_load (cache_file));
       for (int i= 0; i < N (t) - 1; i+= 2)
         cache_data (tuple (buffer, t[i]))= t[i + 1];
+      // regenerate the missing or outdated binary file at the next save
+      cache_changed->insert (buffer);
     }
     else {
       cache_init (buffer);
@@ -204,6 +483,8 @@ cache_refresh () {
   cache_data   = hashmap<tree, tree> ("?");
   cache_loaded = hashset<string> ();
   cache_changed= hashset<string> ();
+  cache_binary = hashmap<string, binary_cache> ();
+  cache_removed= hashset<tree> ();
   cache_load ("font_cache.scm");
   cache_load ("font_basename.scm");
   cache_load ("validate_cache.scm");
@@ -0,0 +1,123 @@
+
+/******************************************************************************
+ * MODULE     : tm_profile.cpp
+ * DESCRIPTION: Instrumentation of the typesetting pipeline
+ * COPYRIGHT  : (C) 2026  Darcy Shen
+ *******************************************************************************
+ * This software falls under the GNU general public license version 3 or later.
+ * It comes WITHOUT ANY WARRANTY WHATSOEVER. For details, see the file LICENSE
+ * in the root directory or <http://www.gnu.org/licenses/gpl-3.0.html>.
+ ******************************************************************************/
+
+#include "tm_profile.hpp"
+#include "file.hpp"
+#include <chrono>
+
+/******************************************************************************
+ * The ring buffer of samples
+ ******************************************************************************/
+
+struct profile_sample {
+  const char* name;  // name of the phase or counter
+  char        kind;  // 'X' for a phase, 'C' for a counter, 'i' for an edit
+  int         edit;  // number of the edit during which the sample was taken
+  int64_t     start; // start time in microseconds
+  int64_t     value; // duration of a phase or value of a counter
+};
+
+static profile_sample*  profile_ring    = NULL;
+static int              profile_next    = 0;
+static int              profile_size    = 0;
+static int              profile_edit_nr = 0;
+static profile_counter* profile_counters= NULL;
+
+int64_t
+profile_time () {
+  using namespace std::chrono;
+  return duration_cast<microseconds> (steady_clock::now ().time_since_epoch ())
+      .count ();
+}
+
+static void
+profile_push (const char* name, char kind, int64_t start, int64_t value) {
+  if (profile_ring == NULL)
+    profile_ring= tm_new_array<profile_sample> (PROFILE_RING_SIZE);
+  profile_sample& s= profile_ring[profile_next];
+  s.name           = name;
+  s.kind           = kind;
+  s.edit           = profile_edit_nr;
+  s.start          = start;
+  s.value          = value;
+  profile_next     = (profile_next + 1) % PROFILE_RING_SIZE;
+  profile_size     = min (profile_size + 1, PROFILE_RING_SIZE);
+}
+
+void
+profile_record (const char* name, int64_t start, int64_t end) {
+  profile_push (name, 'X', start, end - start);
+}
+
+profile_counter::profile_counter (const char* name2)
+    : name (name2), count (0), next (profile_counters) {
+  profile_counters= this;
+}
+
+void
+profile_edit () {
+  int64_t now= profile_time ();
+  for (profile_counter* c= profile_counters; c != NULL; c= c->next)
+    if (c->count != 0) {
+      profile_push (c->name, 'C', now, c->count);
+      c->count= 0;
+    }
+  profile_push ("edit", 'i', now, 0);
+  profile_edit_nr++;
+}
+
+void
+profile_reset () {
+  profile_next   = 0;
+  profile_size   = 0;
+  profile_edit_nr= 0;
+  for (profile_counter* c= profile_counters; c != NULL; c= c->next)
+    c->count= 0;
+}
+
+bool
+profile_enabled () {
+#ifdef TYPESET_PROFILE
+  return true;
+#else
+  return false;
+#endif
+}
+
+/******************************************************************************
+ * Exporting the samples in the Chrome trace format
+ ******************************************************************************/
+
+static string
+profile_json (profile_sample s) {
+  string r= "{\"name\":\"" * string (s.name) * "\",\"ph\":\"" *
+            string (s.kind) * "\",\"ts\":" * as_string (s.start) *
+            ",\"pid\":1,\"tid\":1";
+  if (s.kind == 'X')
+    r << ",\"dur\":" << as_string (s.value)
+      << ",\"args\":{\"edit\":" << as_string (s.edit) << "}";
+  else if (s.kind == 'C')
+    r << ",\"args\":{\"count\":" << as_string (s.value) << "}";
+  else r << ",\"s\":\"g\",\"args\":{\"edit\":" << as_string (s.edit) << "}";
+  return r * "}";
+}
+
+bool
+profile_export (url u) {
+  string r  = "{\"traceEvents\":[";
+  int    low= profile_next - profile_size + PROFILE_RING_SIZE;
+  for (int i= 0; i < profile_size; i++) {
+    if (i != 0) r << ",\n";
+    r << profile_json (profile_ring[(low + i) % PROFILE_RING_SIZE]);
+  }
+  r << "],\"displayTimeUnit\":\"ms\"}\n";
+  return save_string (u, r);
+}
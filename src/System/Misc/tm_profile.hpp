@@ -0,0 +1,67 @@
+
+/******************************************************************************
+ * MODULE     : tm_profile.hpp
+ * DESCRIPTION: Instrumentation of the typesetting pipeline
+ * COPYRIGHT  : (C) 2026  Darcy Shen
+ *******************************************************************************
+ * When configured with the typeset_profile option, PROFILE_SCOPE times the
+ * phases of each edit and PROFILE_COUNT counts events inside an edit.
+ * The most recent samples are kept in a ring buffer, which can be exported
+ * in the Chrome trace format for chrome://tracing or ui.perfetto.dev.
+ * Without the option, the macros expand to nothing.
+ *******************************************************************************
+ * This software falls under the GNU general public license version 3 or later.
+ * It comes WITHOUT ANY WARRANTY WHATSOEVER. For details, see the file LICENSE
+ * in the root directory or <http://www.gnu.org/licenses/gpl-3.0.html>.
+ ******************************************************************************/
+
+#ifndef TM_PROFILE_H
+#define TM_PROFILE_H
+
+#include "url.hpp"
+#include <cstdint>
+
+#define PROFILE_RING_SIZE 65536
+
+int64_t profile_time ();
+void    profile_record (const char* name, int64_t start, int64_t end);
+void    profile_edit ();
+void    profile_reset ();
+bool    profile_export (url u);
+bool    profile_enabled ();
+
+struct profile_scope {
+  const char* name;  // name of the phase, with static storage
+  int64_t     start; // time in microseconds when the phase began
+
+  inline profile_scope (const char* name2)
+      : name (name2), start (profile_time ()) {}
+  inline ~profile_scope () { profile_record (name, start, profile_time ()); }
+};
+
+struct profile_counter {
+  const char*      name;  // name of the counter, with static storage
+  int64_t          count; // number of events during the current edit
+  profile_counter* next;  // next counter in the list of all counters
+
+  profile_counter (const char* name2);
+};
+
+#ifdef TYPESET_PROFILE
+#define PROFILE_JOIN(a, b) a##b
+#define PROFILE_NAME(a, b) PROFILE_JOIN (a, b)
+#define PROFILE_SCOPE(name)                                                    \
+  profile_scope PROFILE_NAME (profile_scope_, __LINE__) (name)
+#define PROFILE_COUNT(name)                                                    \
+  do {                                                                         \
+    static profile_counter profile_counter_site (name);                        \
+    profile_counter_site.count++;                                              \
+  } while (false)
+#define PROFILE_EDIT() profile_edit ()
+#else
+#define PROFILE_SCOPE(name) ((void) 0)
+#define PROFILE_COUNT(name) ((void) 0)
+#define PROFILE_EDIT() ((void) 0)
+#endif
+
+#endif // defined TM_PROFILE_H
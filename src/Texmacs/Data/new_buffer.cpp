@@ -13,6 +13,7 @@
 #include "converter.hpp"
 #include "dictionary.hpp"
 #include "file.hpp"
+#include "journal.hpp"
 #include "locale.hpp"
 #include "merge_sort.hpp"
 #include "message.hpp"
@@ -624,6 +625,59 @@ buffer_save (url name) {
   return r;
 }
 
+/******************************************************************************
+ * Journaled autosaves
+ ******************************************************************************/
+
+static string
+journal_stamp (url u) {
+  // NOTE: identifies the full autosave on top of which a journal is replayed
+  int size= file_size (u);
+  if (size < 0) return "";
+  return as_string (size) * ":" * as_string (last_modified (u));
+}
+
+bool
+buffer_journal_reset (url name, url aname, url jname) {
+  tm_buffer buf= concrete_buffer (name);
+  if (is_nil (buf)) return true;
+  buf->base   = "";
+  string stamp= journal_stamp (aname);
+  if (stamp == "" || save_string (jname, journal_header (stamp))) return true;
+  buf->base= stamp;
+  return false;
+}
+
+bool
+buffer_journal_append (url name, url aname, url jname) {
+  tm_buffer buf= concrete_buffer (name);
+  if (is_nil (buf) || buf->base == "") return true;
+  if (journal_stamp (aname) != buf->base) return true;
+  for (int i= 0; i < N (buf->vws); i++) {
+    editor ed= buf->vws[i]->ed;
+    string s;
+    if (ed->defined_in_init ("encryption")) return true;
+    if (!ed->get_journal (s)) continue;
+    // NOTE: compact into a new full autosave once the journal would grow
+    // beyond half of the size of the full autosave
+    int size= file_size (jname);
+    if (size < 0 || 2 * (size + N (s)) > file_size (aname)) return true;
+    return append_string (jname, s, false);
+  }
+  return true;
+}
+
+tree
+buffer_journal_replay (tree doc, url aname, url jname) {
+  string s, stamp;
+  int    pos= 0;
+  if (!is_compound (doc) || load_string (jname, s, false)) return doc;
+  if (!journal_read_header (s, pos, stamp)) return doc;
+  if (stamp != journal_stamp (aname)) return doc;
+  tree body= journal_replay (extract (doc, "body"), s, pos);
+  return change_doc_attr (doc, "body", body);
+}
+
 /******************************************************************************
  * Loading inclusions
  ******************************************************************************/
@@ -110,6 +110,9 @@ bool       buffer_import (url name, url src, string fm);
 bool       buffer_load (url name);
 bool       buffer_export (url name, url dest, string fm);
 bool       buffer_save (url name);
+bool       buffer_journal_reset (url name, url aname, url jname);
+bool       buffer_journal_append (url name, url aname, url jname);
+tree       buffer_journal_replay (tree doc, url aname, url jname);
 tree       import_loaded_tree (string s, url u, string fm);
 tree       import_tree (url u, string fm);
 bool       export_tree (tree doc, url u, string fm);
@@ -29,12 +29,14 @@ public:
   SI                    x1, y1, x2, y2;
   hashmap<string, tree> old_patch;
   bool                  paper;
+  pager                 last_pager; // pager of the previous typesetting
 
 private:
   std::shared_ptr<rectangle> changed_ptr= std::make_shared<rectangle> ();
 
 public:
   typesetter_rep (edit_env& env, tree et, path ip);
+  ~typesetter_rep ();
 
   void insert_stack (array<page_item> l, stack_border sb);
   void insert_parunit (tree t, path ip);
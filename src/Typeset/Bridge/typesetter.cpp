@@ -11,6 +11,7 @@
 
 #include "Bridge/impl_typesetter.hpp"
 #include "iterator.hpp"
+#include "tm_profile.hpp"
 
 using namespace moebius;
 
@@ -20,11 +21,16 @@ using namespace moebius;
 
 typesetter_rep::typesetter_rep (edit_env& env2, tree et, path ip)
     : env (env2), old_patch (UNINIT) {
-  paper= (env->get_string (PAGE_MEDIUM) == "paper");
-  br   = make_bridge (this, et, ip);
+  paper     = (env->get_string (PAGE_MEDIUM) == "paper");
+  br        = make_bridge (this, et, ip);
+  last_pager= NULL;
   x1= y1= x2= y2= 0;
 }
 
+typesetter_rep::~typesetter_rep () {
+  if (last_pager != NULL) tm_delete (last_pager);
+}
+
 typesetter
 new_typesetter (edit_env& env, tree et, path ip) {
   return tm_new<typesetter_rep> (env, et, ip);
@@ -169,11 +175,17 @@ typesetter_rep::typeset () {
     env->redefined= array<tree> ();
     env->touched  = hashmap<string, bool> (false);
   }
-  br->typeset (PROCESSED + WANTED_PARAGRAPH);
+  {
+    PROFILE_SCOPE ("bridge");
+    br->typeset (PROCESSED + WANTED_PARAGRAPH);
+  }
   pager ppp= tm_new<pager_rep> (br->ip, env, l);
-  box   rb = ppp->make_pages ();
+  ppp->prev= last_pager;
+  box rb   = ppp->make_pages ();
+  ppp->prev= NULL;
   if (env->complete && paper) determine_page_references (rb);
-  tm_delete (ppp);
+  if (last_pager != NULL) tm_delete (last_pager);
+  last_pager= ppp;
   // env->complete= false;  // moved to edit_typeset_rep::typeset
   return rb;
 }
@@ -168,6 +168,8 @@ build_locus (edit_env env, tree t, list<string>& ids, string& col, string& ref,
     }
   }
 
+  env->printed= true;
+
   bool   on_paper   = (env->get_string (PAGE_PRINTED) == "true");
   bool   preserve   = (get_locus_rendering ("locus-on-paper") == "preserve");
   string var        = (visited ? VISITED_COLOR : LOCUS_COLOR);
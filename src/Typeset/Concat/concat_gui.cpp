@@ -73,6 +73,8 @@ resize (edit_env env, SI old, SI minimum, SI maximum, tree new_size) {
 
 canvas_properties
 get_canvas_properties (edit_env env, tree t) {
+  env->printed= true;
+
   bool printed= (env->get_string (PAGE_PRINTED) == "true");
   SI   border = env->get_length (ORNAMENT_BORDER);
   if (!printed) {
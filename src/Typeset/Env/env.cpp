@@ -32,7 +32,8 @@ edit_env_rep::edit_env_rep (drd_info& drd2, url base_file_name2,
                             hashmap<string, tree>& global_aux2,
                             hashmap<string, tree>& local_att2,
                             hashmap<string, tree>& global_att2)
-    : drd (drd2), env (UNINIT), back (UNINIT), src (path (DECORATION)),
+    : drd (drd2), env (UNINIT), back (UNINIT), parsed (ENV_PARSED_SIZE),
+      fonts (ENV_FONTS_SIZE), fonts_next (0), src (path (DECORATION)),
       var_type (default_var_type), base_file_name (base_file_name2),
       cur_file_name (base_file_name2), secure (is_secure (base_file_name2)),
       local_ref (local_ref2), global_ref (global_ref2), local_aux (local_aux2),
@@ -45,6 +46,7 @@ edit_env_rep::edit_env_rep (drd_info& drd2, url base_file_name2,
   style_init_env ();
   update ();
   complete   = false;
+  printed    = false;
   recover_env= tuple ();
   anim_start= anim_end= anim_portion= 0.0;
 }
@@ -152,22 +154,18 @@ void
 edit_env_rep::monitored_patch_env (hashmap<string, tree> patch) {
   if (patch->size == 0) return;
   int i= 0, n= patch->n;
-  for (; i < n; i++) {
-    list<hashentry<string, tree>> l= patch->a[i];
-    for (; !is_nil (l); l= l->next)
-      monitored_write_update (l->item.key, l->item.im);
-  }
+  for (; i < n; i++)
+    if (patch->s[i] == HASHMAP_FULL)
+      monitored_write_update (patch->a[i].key, patch->a[i].im);
 }
 
 void
 edit_env_rep::patch_env (hashmap<string, tree> patch) {
   if (patch->size == 0) return;
   int i= 0, n= patch->n;
-  for (; i < n; i++) {
-    list<hashentry<string, tree>> l= patch->a[i];
-    for (; !is_nil (l); l= l->next)
-      write_update (l->item.key, l->item.im);
-  }
+  for (; i < n; i++)
+    if (patch->s[i] == HASHMAP_FULL)
+      write_update (patch->a[i].key, patch->a[i].im);
 }
 
 void
@@ -175,6 +173,20 @@ edit_env_rep::read_env (hashmap<string, tree>& ret) {
   ret= copy (env);
 }
 
+void
+edit_env_rep::read_env (hashmap<string, tree>  base,
+                        hashmap<string, tree>& ret) {
+  // Only store the values which differ from base, assuming that
+  // no variables were removed from the environment since base was read
+  ret  = hashmap<string, tree> (UNINIT);
+  int i= 0, n= env->n;
+  for (; i < n; i++)
+    if (env->s[i] == HASHMAP_FULL) {
+      hashentry<string, tree>& e= env->a[i];
+      if (!base->contains (e.key) || base[e.key] != e.im) ret (e.key)= e.im;
+    }
+}
+
 void
 edit_env_rep::local_start (hashmap<string, tree>& prev_back) {
   prev_back= back;
@@ -192,11 +204,9 @@ edit_env_rep::local_update (hashmap<string, tree>& old_patch,
 void
 edit_env_rep::local_end (hashmap<string, tree>& prev_back) {
   int i= 0, n= back->n;
-  for (; i < n; i++) {
-    list<hashentry<string, tree>> l= back->a[i];
-    for (; !is_nil (l); l= l->next)
-      prev_back->write_back (l->item.key, back);
-  }
+  for (; i < n; i++)
+    if (back->s[i] == HASHMAP_FULL)
+      prev_back->write_back (back->a[i].key, back);
   back= prev_back;
 }
 
@@ -196,18 +196,26 @@ edit_env_rep::as_tmlen (tree t) {
     return tree (TMLEN, _min, _def, _max);
   }
   else if (is_atomic (t)) {
-    string s    = t->label;
-    int    start= 0, n= N (s);
-    while ((start + 1 < n) && (s[start] == '-') && (s[start + 1] == '-'))
-      start+= 2;
-    double len;
-    string unit;
-    parse_length (s (start, n), len, unit);
-    if (unit == "error" || is_empty (unit)) {
+    env_parsed& p= parsed_slot (t->label);
+    if ((p.done & PARSED_LENGTH) == 0) {
+      string s    = t->label;
+      int    start= 0, n= N (s);
+      while ((start + 1 < n) && (s[start] == '-') && (s[start + 1] == '-'))
+        start+= 2;
+      string unit;
+      parse_length (s (start, n), p.len, unit);
+      if (unit == "error" || is_empty (unit)) p.unit= tree (UNINIT);
+      else p.unit= compound (unit * "-length");
+      p.done= p.done | PARSED_LENGTH;
+    }
+    // NOTE: p may be reused by the recursive call, so copy its fields first
+    double len = p.len;
+    tree   unit= p.unit;
+    if (unit == UNINIT) {
       return tree (TMLEN, "0");
     }
     else {
-      return tmlen_times (len, as_tmlen (exec (compound (unit * "-length"))));
+      return tmlen_times (len, as_tmlen (exec (unit)));
     }
   }
   else if (is_func (t, MACRO, 1)) return as_tmlen (exec (t[0]));
@@ -224,7 +232,9 @@ edit_env_rep::as_length (tree t) {
 
 SI
 edit_env_rep::as_length (tree t, string perc) {
-  if (is_atomic (t) && N (t->label) > 0 && t->label[N (t->label) - 1] == '%')
+  // read the label through a const reference to keep interned atoms shared
+  if (is_atomic (t) && N (t->label) > 0 &&
+      ((const string&) t->label)[N (t->label) - 1] == '%')
     return as_length (t->label (0, N (t->label) - 1) * perc) / 100;
   else {
     tree r= as_tmlen (t);
@@ -550,36 +550,72 @@ edit_env_rep::get_script_size (double sz, int level) {
  * Updating the environment from the variables
  ******************************************************************************/
 
+static bool
+same_font (env_font& f, int mode, string* var, double sz, int dpi,
+           string eff) {
+  if (f.mode != mode || f.sz != sz || f.dpi != dpi) return false;
+  for (int i= 0; i < 8; i++)
+    if (f.var[i] != var[i]) return false;
+  return f.eff == eff;
+}
+
 void
 edit_env_rep::update_font () {
   double base_size= get_double (FONT_BASE_SIZE);
   fn_size= base_size * get_double (FONT_SIZE); // fn_size现在应该是double类型
-  switch (mode) {
+  int    m  = (mode == 1 ? 0 : mode);
+  double sz = get_script_size (fn_size, index_level);
+  int    res= (int) (magn * dpi);
+  string var[8];
+  var[0]= get_string (FONT);
+  var[1]= get_string (FONT_FAMILY);
+  var[2]= get_string (FONT_SERIES);
+  var[3]= get_string (FONT_SHAPE);
+  if (m == 2) {
+    var[4]= get_string (MATH_FONT);
+    var[5]= get_string (MATH_FONT_FAMILY);
+    var[6]= get_string (MATH_FONT_SERIES);
+    var[7]= get_string (MATH_FONT_SHAPE);
+  }
+  else if (m == 3) {
+    var[4]= get_string (PROG_FONT);
+    var[5]= get_string (PROG_FONT_FAMILY);
+    var[6]= get_string (PROG_FONT_SERIES);
+    var[7]= get_string (PROG_FONT_SHAPE);
+  }
+  string eff= get_string (FONT_EFFECTS);
+
+  // switching between text, math and scripts mostly returns to recent fonts
+  for (int i= 0; i < ENV_FONTS_SIZE; i++)
+    if (same_font (fonts[i], m, var, sz, res, eff)) {
+      fn= fonts[i].fn;
+      return;
+    }
+
+  switch (m) {
   case 0:
-  case 1:
-    fn= smart_font (get_string (FONT), get_string (FONT_FAMILY),
-                    get_string (FONT_SERIES), get_string (FONT_SHAPE),
-                    get_script_size (fn_size, index_level), (int) (magn * dpi));
+    fn= smart_font (var[0], var[1], var[2], var[3], sz, res);
     break;
   case 2:
-    fn= math_smart_font (get_string (MATH_FONT), get_string (MATH_FONT_FAMILY),
-                         get_string (MATH_FONT_SERIES),
-                         get_string (MATH_FONT_SHAPE), get_string (FONT),
-                         get_string (FONT_FAMILY), get_string (FONT_SERIES),
-                         "mathitalic", get_script_size (fn_size, index_level),
-                         (int) (magn * dpi));
+    fn= math_smart_font (var[4], var[5], var[6], var[7], var[0], var[1],
+                         var[2], "mathitalic", sz, res);
     break;
   case 3:
-    fn= prog_smart_font (
-        get_string (PROG_FONT), get_string (PROG_FONT_FAMILY),
-        get_string (PROG_FONT_SERIES), get_string (PROG_FONT_SHAPE),
-        get_string (FONT), get_string (FONT_FAMILY) * "-tt",
-        get_string (FONT_SERIES), get_string (FONT_SHAPE),
-        get_script_size (fn_size, index_level), (int) (magn * dpi));
+    fn= prog_smart_font (var[4], var[5], var[6], var[7], var[0],
+                         var[1] * "-tt", var[2], var[3], sz, res);
     break;
   }
-  string eff= get_string (FONT_EFFECTS);
   if (N (eff) != 0) fn= apply_effects (fn, eff);
+
+  env_font& f= fonts[fonts_next];
+  f.mode     = m;
+  for (int i= 0; i < 8; i++)
+    f.var[i]= var[i];
+  f.sz      = sz;
+  f.dpi     = res;
+  f.eff     = eff;
+  f.fn      = fn;
+  fonts_next= (fonts_next + 1) % ENV_FONTS_SIZE;
 }
 
 int
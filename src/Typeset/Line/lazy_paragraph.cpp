@@ -18,6 +18,7 @@
 #include "array.hpp"
 #include "converter.hpp"
 #include "tm_debug.hpp"
+#include "tm_profile.hpp"
 
 #include <lolly/data/unicode.hpp>
 
@@ -994,6 +995,8 @@ lazy_paragraph_rep::format_paragraph_unit (int the_start, int the_end) {
 
 void
 lazy_paragraph_rep::format_paragraph () {
+  PROFILE_SCOPE ("lines");
+  PROFILE_COUNT ("paragraphs");
   width-= right;
 
   int  start     = 0, i, j, k;
@@ -16,51 +16,44 @@
 using namespace moebius;
 
 /******************************************************************************
- * Information about the best line breaks
+ * Break positions
+ *
+ * A break position is either the start of a line item or a position inside
+ * a string item, possibly after earlier hyphenations of the same item.
+ * Positions are numbered: position i <= end is the start of item i and
+ * hyphenation positions are allocated on demand, with their item, the
+ * hyphenated position and the offset of the hyphen stored in flat arrays.
+ * The best breaks found so far are stored in flat arrays as well.
  ******************************************************************************/
 
-struct lb_info_rep : concrete_struct {
-  path prev;
-  int  pen;
-  PEN  pen_spc;
-
-  lb_info_rep () : prev (), pen (HYPH_INVALID), pen_spc ((PEN) 1000000000) {}
-};
-
-struct lb_info {
-  CONCRETE (lb_info);
-  lb_info () { rep= tm_new<lb_info_rep> (); }
-  operator tree () {
-    return tuple (as_tree (rep->prev), as_string (rep->pen),
-                  as_string ((double) rep->pen_spc));
-  }
-};
-CONCRETE_CODE (lb_info);
-
-tm_ostream&
-operator<< (tm_ostream& out, lb_info hi) {
-  return out << "[ " << hi->prev << ", " << hi->pen << ", " << hi->pen_spc
-             << " ]";
-}
-
-// FIXME: explicit instantiation for broken g++
-#include "hashmap.hpp"
-template lb_info& hashmap_rep<list<int>, lb_info>::bracket_rw (list<int>);
+#define PEN_MAX ((PEN) 1000000000)
 
 /******************************************************************************
  * The line_breaker class
  ******************************************************************************/
 
 struct line_breaker_rep {
-  array<line_item>       a;
-  int                    start;
-  int                    end;
-  SI                     line_width;
-  SI                     large_width;
-  SI                     first_spc;
-  SI                     last_spc;
-  int                    pass;
-  hashmap<path, lb_info> best;
+  array<line_item> a;
+  int              start;
+  int              end;
+  SI               line_width;
+  SI               large_width;
+  SI               first_spc;
+  SI               last_spc;
+  int              pass;
+
+  array<int>        pos_item;    // item of the position
+  array<int>        pos_parent;  // hyphenated position or -1
+  array<int>        pos_offset;  // offset of the hyphen in the parent
+  array<int>        pos_child;   // first hyphenation of the position or -1
+  array<int>        pos_next;    // next hyphenation of the parent or -1
+  array<line_item>  pos_rest;    // remainder of the item after hyphenation
+  array<array<int>> pos_hyphens; // hyphenation penalties of the remainder
+  array<array<SI>>  pos_widths;  // widths of the remainder up to a hyphen
+  array<bool>       best_known;  // whether a break was found at the position
+  array<int>        best_prev;   // previous break of the best break
+  array<int>        best_pen;    // penalty of the best break
+  array<PEN>        best_spc;    // spacing penalty of the best break
 
   line_breaker_rep (array<line_item> a, int start, int end, SI line_width,
                     SI large_width, SI first_spc, SI last_spc);
@@ -69,11 +62,17 @@ struct line_breaker_rep {
   path        next_ragged_break (path pos);
   array<path> compute_ragged_breaks ();
 
-  void test_better (path new_pos, path old_pos, int penalty, PEN pen_spc);
-  bool propose_break (path new_pos, path old_pos, int penalty, space spc);
-  void break_string (line_item item, path pos, int i, space spc);
-  void process (path pos);
-  void get_breaks (array<path>& ap, path p);
+  int       new_position (int item, int parent, int offset);
+  int       hyphen_position (int pos, int offset, bool create);
+  line_item rest_item (int pos);
+  SI        hyphen_width (int pos, int offset);
+  path      as_path (int pos);
+
+  void test_better (int new_pos, int old_pos, int penalty, PEN pen_spc);
+  bool propose_break (int new_pos, int old_pos, int penalty, SI spc_min,
+                      SI spc_def, SI spc_max);
+  void break_string (int pos, int i, SI spc_min, SI spc_def, SI spc_max);
+  void process (int pos);
   array<path> compute_breaks ();
 };
 
@@ -81,8 +80,8 @@ line_breaker_rep::line_breaker_rep (array<line_item> a2, int start2, int end2,
                                     SI line_width2, SI large_width2,
                                     SI first_spc2, SI last_spc2)
     : a (a2), start (start2), end (end2), line_width (line_width2),
-      large_width (large_width2), first_spc (first_spc2), last_spc (last_spc2),
-      best (lb_info ()) {}
+      large_width (large_width2), first_spc (first_spc2),
+      last_spc (last_spc2) {}
 
 /******************************************************************************
  * Some subroutines
@@ -253,22 +252,83 @@ line_breaker_rep::compute_ragged_breaks () {
   return ap;
 }
 
+/******************************************************************************
+ * Break positions
+ ******************************************************************************/
+
+int
+line_breaker_rep::new_position (int item, int parent, int offset) {
+  int pos= N (pos_item);
+  pos_item << item;
+  pos_parent << parent;
+  pos_offset << offset;
+  pos_child << -1;
+  pos_next << -1;
+  pos_rest << line_item ();
+  pos_hyphens << array<int> ();
+  pos_widths << array<SI> ();
+  best_known << false;
+  best_prev << -1;
+  best_pen << HYPH_INVALID;
+  best_spc << PEN_MAX;
+  if (parent >= 0) {
+    pos_next[pos]     = pos_child[parent];
+    pos_child[parent]= pos;
+  }
+  return pos;
+}
+
+int
+line_breaker_rep::hyphen_position (int pos, int offset, bool create) {
+  for (int q= pos_child[pos]; q >= 0; q= pos_next[q])
+    if (pos_offset[q] == offset) return q;
+  return create ? new_position (pos_item[pos], pos, offset) : -1;
+}
+
+line_item
+line_breaker_rep::rest_item (int pos) {
+  if (pos_parent[pos] < 0) return a[pos_item[pos]];
+  if (is_nil (pos_rest[pos])) {
+    line_item item1, item2;
+    hyphenate (rest_item (pos_parent[pos]), pos_offset[pos], item1, item2);
+    pos_rest[pos]= item2;
+  }
+  return pos_rest[pos];
+}
+
+SI
+line_breaker_rep::hyphen_width (int pos, int j) {
+  // width of the remainder of pos when hyphenated after character j
+  if (pos_widths[pos][j] < 0) {
+    line_item item1, item2;
+    hyphenate (rest_item (pos), j, item1, item2);
+    pos_widths[pos][j]= item1->b->w ();
+  }
+  return pos_widths[pos][j];
+}
+
+path
+line_breaker_rep::as_path (int pos) {
+  if (pos_parent[pos] < 0) return path (pos_item[pos]);
+  return as_path (pos_parent[pos]) * pos_offset[pos];
+}
+
 /******************************************************************************
  * Test whether we found a better break
  ******************************************************************************/
 
 void
-line_breaker_rep::test_better (path new_pos, path old_pos, int pen,
+line_breaker_rep::test_better (int new_pos, int old_pos, int pen,
                                PEN pen_spc) {
-  if (!best->contains (new_pos)) best (new_pos)= lb_info ();
-  lb_info cur= best[new_pos];
-  // cout << "Test " << new_pos << " vs " << old_pos
-  //      << ", " << pen << " vs " << cur->pen
-  //      << ", " << pen_spc << " vs " << cur->pen_spc << "\n";
-  if ((pen < cur->pen) || ((pen == cur->pen) && (pen_spc < cur->pen_spc))) {
-    cur->prev   = old_pos;
-    cur->pen    = pen;
-    cur->pen_spc= min (pen_spc, (PEN) 1000000000);
+  best_known[new_pos]= true;
+  // cout << "Test " << as_path (new_pos) << " vs " << as_path (old_pos)
+  //      << ", " << pen << " vs " << best_pen[new_pos]
+  //      << ", " << pen_spc << " vs " << best_spc[new_pos] << "\n";
+  if ((pen < best_pen[new_pos]) ||
+      ((pen == best_pen[new_pos]) && (pen_spc < best_spc[new_pos]))) {
+    best_prev[new_pos]= old_pos;
+    best_pen[new_pos] = pen;
+    best_spc[new_pos] = min (pen_spc, PEN_MAX);
     // cout << "  Better\n";
   }
 }
@@ -279,43 +339,45 @@ square (PEN i) {
 }
 
 bool
-line_breaker_rep::propose_break (path new_pos, path old_pos, int pen,
-                                 space spc) {
-  lb_info cur= best[old_pos];
-
-  if ((spc->min <= line_width) &&
-      ((spc->max >= line_width) || (new_pos->item == end))) {
-    SI d= max (line_width - spc->def, spc->def - line_width);
-    if (new_pos->item == end) d= 0;
-    test_better (new_pos, old_pos, min (HYPH_INVALID, cur->pen + pen),
-                 cur->pen_spc + (cur->pen == HYPH_INVALID
-                                     ? ((PEN) 0)
-                                     : square ((PEN) (d / PIXEL))));
+line_breaker_rep::propose_break (int new_pos, int old_pos, int pen,
+                                 SI spc_min, SI spc_def, SI spc_max) {
+  int cur_pen    = best_pen[old_pos];
+  PEN cur_pen_spc= best_spc[old_pos];
+  int new_item   = pos_item[new_pos];
+
+  if ((spc_min <= line_width) &&
+      ((spc_max >= line_width) || (new_item == end))) {
+    SI d= max (line_width - spc_def, spc_def - line_width);
+    if (new_item == end) d= 0;
+    test_better (new_pos, old_pos, min (HYPH_INVALID, cur_pen + pen),
+                 cur_pen_spc + (cur_pen == HYPH_INVALID
+                                    ? ((PEN) 0)
+                                    : square ((PEN) (d / PIXEL))));
   }
 
   if (pass == 2) {
-    if (spc->max < line_width)
+    if (spc_max < line_width)
       test_better (new_pos, old_pos, HYPH_INVALID,
-                   (cur->pen == HYPH_INVALID ? cur->pen_spc : ((PEN) 0)) +
-                       square ((PEN) ((line_width - spc->max) / PIXEL)) +
-                       (new_pos->item == old_pos->item
+                   (cur_pen == HYPH_INVALID ? cur_pen_spc : ((PEN) 0)) +
+                       square ((PEN) ((line_width - spc_max) / PIXEL)) +
+                       (new_item == pos_item[old_pos]
                             ? square ((PEN) (line_width / PIXEL))
                             : ((PEN) 0)));
-    else if (spc->min > large_width)
+    else if (spc_min > large_width)
       test_better (new_pos, old_pos, HYPH_INVALID,
-                   (cur->pen == HYPH_INVALID ? cur->pen_spc : ((PEN) 0)) +
-                       square ((PEN) ((spc->min - line_width) / PIXEL)) +
+                   (cur_pen == HYPH_INVALID ? cur_pen_spc : ((PEN) 0)) +
+                       square ((PEN) ((spc_min - line_width) / PIXEL)) +
                        square ((PEN) (4 * line_width / PIXEL)));
-    else if (spc->min > line_width)
+    else if (spc_min > line_width)
       test_better (new_pos, old_pos, HYPH_INVALID,
-                   (cur->pen == HYPH_INVALID ? cur->pen_spc : ((PEN) 0)) +
-                       square ((PEN) ((spc->min - line_width) / PIXEL)) +
-                       (new_pos->item == old_pos->item
+                   (cur_pen == HYPH_INVALID ? cur_pen_spc : ((PEN) 0)) +
+                       square ((PEN) ((spc_min - line_width) / PIXEL)) +
+                       (new_item == pos_item[old_pos]
                             ? square ((PEN) (line_width / PIXEL))
                             : ((PEN) 0)));
   }
 
-  return spc->min > large_width;
+  return spc_min > large_width;
 }
 
 /******************************************************************************
@@ -323,21 +385,30 @@ line_breaker_rep::propose_break (path new_pos, path old_pos, int pen,
  ******************************************************************************/
 
 void
-line_breaker_rep::break_string (line_item item, path pos, int i, space spc) {
-  int        j;
-  string     item_s= item->b->get_leaf_string ();
-  array<int> hp    = item->lan->get_hyphens (item_s);
+line_breaker_rep::break_string (int pos, int i, SI spc_min, SI spc_def,
+                                SI spc_max) {
+  int       j;
+  int       base= (i == pos_item[pos] ? pos : i);
+  line_item item= rest_item (base);
+  if (N (pos_hyphens[base]) == 0) {
+    array<int> hp= item->lan->get_hyphens (item->b->get_leaf_string ());
+    array<SI>  ws (N (hp));
+    for (j= 0; j < N (hp); j++)
+      ws[j]= -1;
+    pos_hyphens[base]= hp;
+    pos_widths[base] = ws;
+  }
+  array<int> hp= pos_hyphens[base];
 
-  if ((item->b->w () > line_width) || (!is_atom (pos))) {
-    j= get_position (item->b->get_leaf_font (), item_s, line_width - spc->def);
+  if ((item->b->w () > line_width) || (pos_parent[pos] >= 0)) {
+    string item_s= item->b->get_leaf_string ();
+    j= get_position (item->b->get_leaf_font (), item_s, line_width - spc_def);
     for (j= min (j + 2, N (hp) - 1); j >= 0; j--)
       if (hp[j] < HYPH_INVALID) {
-        line_item item1, item2;
-        hyphenate (item, j, item1, item2);
-        path  next    = (i == pos->item) ? pos * j : path (i, j);
-        space spc_hyph= spc + space (item1->b->w ());
-        if (spc_hyph->min <= line_width) {
-          propose_break (next, pos, hp[j], spc_hyph->min);
+        SI spc_hyph= spc_min + hyphen_width (base, j);
+        if (spc_hyph <= line_width) {
+          int next= hyphen_position (base, j, true);
+          propose_break (next, pos, hp[j], spc_hyph, spc_hyph, spc_hyph);
           break;
         }
       }
@@ -345,52 +416,51 @@ line_breaker_rep::break_string (line_item item, path pos, int i, space spc) {
   else {
     for (j= 0; j < N (hp); j++)
       if (hp[j] < HYPH_INVALID) {
-        line_item item1, item2;
-        hyphenate (item, j, item1, item2);
-        path  next    = (i == pos->item) ? pos * j : path (i, j);
-        space spc_hyph= spc + space (item1->b->w ());
-        (void) propose_break (next, pos, hp[j], spc_hyph);
+        int next= hyphen_position (base, j, true);
+        SI  w   = hyphen_width (base, j);
+        (void) propose_break (next, pos, hp[j], spc_min + w, spc_def + w,
+                              spc_max + w);
       }
   }
 }
 
 void
-line_breaker_rep::process (path pos) {
+line_breaker_rep::process (int pos) {
   int       i;
-  space     spc;
-  line_item first;
+  line_item first= rest_item (pos);
+  SI        spc_min, spc_def, spc_max;
 
-  first= a[pos->item];
-  if (pos == path (start)) spc= space (first_spc + first->b->w ());
-  else {
-    path p= pos;
-    while (!is_atom (p)) {
-      line_item item1, item2;
-      p= p->next;
-      hyphenate (first, p->item, item1, item2);
-      first= item2;
-    }
-    spc= space (first->b->w ());
-  }
+  spc_min= spc_def= spc_max= (pos == start ? first_spc : 0) + first->b->w ();
 
-  if ((pass > 1) || (best[pos]->pen < HYPH_INVALID)) {
-    // cout << "Process " << pos << ": " << first << "\n";
-    for (i= pos->item; i < end; i++) {
+  if ((pass > 1) || (best_pen[pos] < HYPH_INVALID)) {
+    // cout << "Process " << as_path (pos) << ": " << first << "\n";
+    for (i= pos_item[pos]; i < end; i++) {
       line_item item= a[i];
-      if (i == pos->item) item= first;
-      else spc= spc + a[i - 1]->spc + space (item->b->w ());
-      if ((spc->max > line_width) && (item->type == STRING_ITEM) &&
-          (N (item->b->get_leaf_string ()) > 4))
-        break_string (item, pos, i, spc + space (-item->b->w ()));
+      if (i == pos_item[pos]) item= first;
+      else {
+        space sep= a[i - 1]->spc;
+        SI    w  = item->b->w ();
+        spc_min+= sep->min + w;
+        spc_def+= sep->def + w;
+        spc_max+= sep->max + w;
+      }
+      if ((spc_max > line_width) && (item->type == STRING_ITEM) &&
+          (N (item->b->get_leaf_string ()) > 4)) {
+        SI w= item->b->w ();
+        break_string (pos, i, spc_min - w, spc_def - w, spc_max - w);
+      }
       if (item->penalty < HYPH_INVALID)
-        if (propose_break (path (i + 1), pos, item->penalty, spc)) break;
+        if (propose_break (i + 1, pos, item->penalty, spc_min, spc_def,
+                           spc_max))
+          break;
       if ((item->type == CONTROL_ITEM) && (item->t == LINE_BREAK) &&
-          (spc->min < line_width))
-        if (propose_break (path (i + 1), pos, 0, space (line_width))) break;
+          (spc_min < line_width))
+        if (propose_break (i + 1, pos, 0, line_width, line_width, line_width))
+          break;
     }
     if (i == end) {
       line_width-= last_spc;
-      propose_break (path (i), pos, 0, spc);
+      propose_break (i, pos, 0, spc_min, spc_def, spc_max);
       line_width+= last_spc;
     }
   }
@@ -399,8 +469,10 @@ line_breaker_rep::process (path pos) {
     string first_s= first->b->get_leaf_string ();
     int    n      = N (first_s);
     if (n > 4)
-      for (i= 0; i < n - 1; i++)
-        if (best->contains (pos * i)) process (pos * i);
+      for (i= 0; i < n - 1; i++) {
+        int q= hyphen_position (pos, i, false);
+        if (q >= 0 && best_known[q]) process (q);
+      }
   }
 }
 
@@ -408,32 +480,30 @@ line_breaker_rep::process (path pos) {
  * Hyphenate an array of line_items
  ******************************************************************************/
 
-void
-line_breaker_rep::get_breaks (array<path>& ap, path p) {
-  if (is_nil (p)) return;
-  lb_info cur= best[p];
-  get_breaks (ap, cur->prev);
-  ap << p;
-}
-
 array<path>
 line_breaker_rep::compute_breaks () {
   int i;
-  test_better (path (start), path (), 0, 0);
+  for (i= 0; i <= end; i++)
+    (void) new_position (i, -1, 0);
+  test_better (start, -1, 0, 0);
 
   pass= 1;
   for (i= start; i < end; i++)
-    process (path (i));
+    process (i);
 
   pass= 2;
-  if (best[path (end)]->pen == HYPH_INVALID)
+  if (best_pen[end] == HYPH_INVALID)
     for (i= start; i < end; i++)
-      process (path (i));
+      process (i);
 
-  test_better (path (end), path (start), HYPH_INVALID, (PEN) 999999999);
+  test_better (end, start, HYPH_INVALID, (PEN) 999999999);
 
+  array<int> rev;
+  for (int pos= end; pos >= 0; pos= best_prev[pos])
+    rev << pos;
   array<path> ap (0);
-  get_breaks (ap, path (end));
+  for (i= N (rev) - 1; i >= 0; i--)
+    ap << as_path (rev[i]);
 
   // Finish with fix for disallowing last lines with only empty boxes
   if (N (ap) <= 2 || !is_atom (ap[N (ap) - 2])) return ap;
@@ -26,10 +26,141 @@ page_item        access (array<page_item> l, path p);
 skeleton break_pages (array<page_item> l, space ph, int qual, space fn_sep,
                       space fnote_sep, space float_sep, font fn,
                       int first_page);
+skeleton break_pages (array<page_item> l, space ph, int qual, space fn_sep,
+                      space fnote_sep, space float_sep, font fn,
+                      int first_page, skeleton prefix, int start);
 box      page_box (path ip, box b, tree page, int page_nr, brush bgc, SI width,
                    SI height, SI left, SI top, SI bot, box header, box footer,
                    SI head_sep, SI foot_sep);
 
+/******************************************************************************
+ * Reusing the pages of the previous typesetting
+ ******************************************************************************/
+
+static bool
+same_item (page_item item1, page_item item2) {
+  // The last line of a paragraph is copied when merging it with the next one
+  if (item1 == item2) return true;
+  if ((item1->type != item2->type) || (item1->b != item2->b) ||
+      (item1->spc != item2->spc) || (item1->penalty != item2->penalty) ||
+      (item1->nr_cols != item2->nr_cols) || (item1->t != item2->t) ||
+      (N (item1->fl) != N (item2->fl)))
+    return false;
+  for (int i= 0; i < N (item1->fl); i++)
+    if (item1->fl[i] != item2->fl[i]) return false;
+  return true;
+}
+
+static bool
+is_new_page (page_item item) {
+  return (item->type == PAGE_CONTROL_ITEM) &&
+         ((item->t == NEW_PAGE) || (item->t == NEW_DPAGE));
+}
+
+static bool
+is_page_nr (page_item item) {
+  return (item->type == PAGE_CONTROL_ITEM) &&
+         is_tuple (item->t, "env_page") && (item->t[1] == PAGE_NR);
+}
+
+static int
+pagelet_end (pagelet pg) {
+  int i, r= 0;
+  for (i= 0; i < N (pg->ins); i++) {
+    insertion ins= pg->ins[i];
+    if (is_tuple (ins->type, "multi-column")) {
+      for (int col= 0; col < N (ins->sk); col++)
+        r= max (r, pagelet_end (ins->sk[col]));
+    }
+    else if (!is_nil (ins->end)) r= max (r, ins->end->item);
+  }
+  return r;
+}
+
+bool
+pager_rep::same_layout (pager_rep* old) {
+  return (paper == old->paper) && (quality == old->quality) &&
+         (text_width == old->text_width) && (text_height == old->text_height) &&
+         (width == old->width) && (height == old->height) &&
+         (odd == old->odd) && (even == old->even) && (top == old->top) &&
+         (bot == old->bot) && (may_extend == old->may_extend) &&
+         (may_shrink == old->may_shrink) && (head_sep == old->head_sep) &&
+         (foot_sep == old->foot_sep) && (col_sep == old->col_sep) &&
+         (fn_sep == old->fn_sep) && (fnote_sep == old->fnote_sep) &&
+         (fnote_bl == old->fnote_bl) && (float_sep == old->float_sep) &&
+         (show_hf == old->show_hf);
+}
+
+int
+pager_rep::pages_stable (int& start) {
+  // Returns the number of leading pagelets of the previous skeleton which
+  // remain valid and sets start to the new page from which on the page_items
+  // have to be broken again. Forced new pages are the only places where
+  // the page breaks do not depend on the subsequent page_items.
+  // Changes of the global environment retypeset all paragraphs,
+  // so identical page_items imply identical page parameters.
+  start= 0;
+  if ((prev == NULL) || (!paper) || (!same_layout (prev))) return 0;
+  int i, k, n= min (N (l), N (prev->l));
+  for (k= 0; k < n; k++)
+    if (!same_item (l[k], prev->l[k])) break;
+  if ((k == N (l)) && (k == N (prev->l))) {
+    start= k;
+    return N (prev->sk);
+  }
+
+  int h= 0;
+  for (i= 1; i < k; i++)
+    if (is_new_page (l[i]) && (l[i - 1]->type != PAGE_CONTROL_ITEM)) h= i;
+  for (i= 0; i < h; i++)
+    if (is_page_nr (l[i])) return 0;
+  if (h == 0) return 0;
+
+  int p= 0, m= N (prev->sk);
+  while ((p < m) &&
+         ((N (prev->sk[p]->ins) == 0) || (pagelet_end (prev->sk[p]) <= h)))
+    p++;
+  while ((p > 0) && (N (prev->sk[p - 1]->ins) == 0))
+    p--;
+  if (p != 0) start= h;
+  return p;
+}
+
+void
+pager_rep::pages_control (page_item item) {
+  if (is_tuple (item->t, "env_page")) {
+    if (((item->t[1] == PAGE_THIS_HEADER) ||
+         (item->t[1] == PAGE_THIS_FOOTER)) &&
+        (item->t[2] == ""))
+      style (item->t[1]->label)= " ";
+    else if (item->t[1] == PAGE_NR)
+      page_offset= as_int (item->t[2]->label) - N (pages) - 1;
+    else style (item->t[1]->label)= copy (item->t[2]);
+  }
+}
+
+void
+pager_rep::pages_control (pagelet pg) {
+  // Replay the control items of a page which is not formatted again
+  int i, j;
+  for (i= 0; i < N (pg->ins); i++) {
+    insertion ins= pg->ins[i];
+    if (is_tuple (ins->type, "multi-column")) {
+      for (int col= 0; col < N (ins->sk); col++)
+        pages_control (ins->sk[col]);
+    }
+    else {
+      array<page_item> sub_l= sub (l, ins->begin, ins->end);
+      for (j= 0; j < N (sub_l); j++)
+        if (sub_l[j]->type == PAGE_CONTROL_ITEM) pages_control (sub_l[j]);
+    }
+  }
+}
+
+/******************************************************************************
+ * Making the page boxes
+ ******************************************************************************/
+
 box
 pager_rep::pages_format (array<page_item> l, SI ht, SI tcor, SI bcor) {
   // cout << "Formatting insertion of height " << ht << LF;
@@ -39,17 +170,7 @@ pager_rep::pages_format (array<page_item> l, SI ht, SI tcor, SI bcor) {
   array<space> spc;
   for (i= 0; i < n; i++) {
     page_item item= l[i];
-    if (item->type == PAGE_CONTROL_ITEM) {
-      if (is_tuple (item->t, "env_page")) {
-        if (((item->t[1] == PAGE_THIS_HEADER) ||
-             (item->t[1] == PAGE_THIS_FOOTER)) &&
-            (item->t[2] == ""))
-          style (item->t[1]->label)= " ";
-        else if (item->t[1] == PAGE_NR)
-          page_offset= as_int (item->t[2]->label) - N (pages) - 1;
-        else style (item->t[1]->label)= copy (item->t[2]);
-      }
-    }
+    if (item->type == PAGE_CONTROL_ITEM) pages_control (item);
     else {
       bs << item->b;
       spc << item->spc;
@@ -202,20 +323,33 @@ pager_rep::pages_make_page (pagelet pg) {
 
 void
 pager_rep::pages_make () {
-  space    ht (text_height - may_shrink, text_height, text_height + may_extend);
-  skeleton sk= break_pages (l, ht, quality, fn_sep, fnote_sep, float_sep,
-                            env->fn, env->first_page);
-  int      i, n= N (sk);
+  space ht (text_height - may_shrink, text_height, text_height + may_extend);
+  int   start= 0, stable= pages_stable (start);
+  if ((prev != NULL) && (start == N (l)) && (stable == N (prev->sk)))
+    sk= prev->sk;
+  else {
+    skeleton prefix= (stable == 0 ? skeleton () : range (prev->sk, 0, stable));
+    sk= break_pages (l, ht, quality, fn_sep, fnote_sep, float_sep, env->fn,
+                     env->first_page, prefix, start);
+  }
+
+  // Headers and footers may refer to the total number of pages
+  int i, n= N (sk);
   env->write (PAGE_THE_TOTAL, as_string (n));
+  if ((prev == NULL) || (N (prev->sk) != n)) stable= 0;
   for (i= 0; i < n; i++)
-    pages << pages_make_page (sk[i]);
+    if (i < stable) {
+      pages_control (sk[i]);
+      pages << prev->pages[i];
+    }
+    else pages << pages_make_page (sk[i]);
 }
 
 void
 pager_rep::papyrus_make () {
-  space    ht (MAX_SI >> 1);
-  skeleton sk= break_pages (l, ht, quality, fn_sep, fnote_sep, float_sep,
-                            env->fn, env->first_page);
+  space ht (MAX_SI >> 1);
+  sk= break_pages (l, ht, quality, fn_sep, fnote_sep, float_sep, env->fn,
+                   env->first_page);
   if (N (sk) != 1) {
     failed_error << "Number of pages: " << N (sk) << "\n";
     TM_FAILED ("unexpected situation");
@@ -53,10 +53,11 @@ new_breaker_rep::new_breaker_rep (array<page_item> l2, space ph, int quality2,
     : l (l2), papyrus_mode (ph == as_space (as_tree (MAX_SI >> 1))),
       height (ph), fn_sep (fn_sep2), fnote_sep (fnote_sep2),
       float_sep (float_sep2), fn (fn2), first_page (fp2), quality (quality2),
-      last_page_flag (true), body_ht (), body_cor (), foot_ht (), foot_tot (),
-      float_ht (), float_tot (), ins_list (), best_prev (path (-1)),
-      best_pens (MAX_SI), todo_list (false), done_list (false),
-      cache_uniform (array<path> ()), cache_colbreaks (array<path> ()) {
+      start (0), last_page_flag (true), body_ht (), body_cor (), foot_ht (),
+      foot_tot (), float_ht (), float_tot (), ins_list (),
+      best_prev (path (-1)), best_pens (MAX_SI), todo_list (false),
+      done_list (false), cache_uniform (array<path> ()),
+      cache_colbreaks (array<path> ()) {
   // HACK: migrate double column footnotes in single column text
   for (int i= 0; i + 1 < N (l); i++)
     if (l[i]->nr_cols == 1 && N (l[i]->fl) > 0) {
@@ -378,7 +379,7 @@ new_breaker_rep::find_page_breaks () {
   //   cout << "  " << i << ": \t" << l[i]
   //        << ", " << body_ht[i]
   //        << ", " << body_cor[i] << ", " << body_tot[i] << LF;
-  todo_list (path (0))= true;
+  todo_list (path (start))= true;
   while (N (todo_list) != 0) {
     hashmap<path, bool> temp_list= todo_list;
     todo_list                    = hashmap<path, bool> (false);
@@ -401,7 +402,7 @@ new_breaker_rep::find_page_breaks () {
       find_page_breaks (best_start);
       while (N (todo_list) == 0 && !best_prev->contains (N (l))) {
         // Fix for bug #62844
-        path best (0);
+        path best (start);
         for (iterator<path> it= iterate (best_prev); it->busy ();) {
           path next= it->next ();
           if (path_inf (best, next))
@@ -737,13 +738,19 @@ new_breaker_rep::assemble_skeleton (skeleton& sk, path end, int& offset) {
 
 skeleton
 new_break_pages (array<page_item> l, space ph, int qual, space fn_sep,
-                 space fnote_sep, space float_sep, font fn, int first_page) {
+                 space fnote_sep, space float_sep, font fn, int first_page,
+                 skeleton prefix, int start) {
   new_breaker_rep* H= tm_new<new_breaker_rep> (l, ph, qual, fn_sep, fnote_sep,
                                                float_sep, fn, first_page);
+  if (start > 0) {
+    H->start                   = start;
+    H->best_prev (path (start))= path (-2);
+    H->best_pens (path (start))= 0;
+  }
   // cout << HRULE << LF;
   H->find_page_breaks ();
   // cout << HRULE << LF;
-  skeleton sk;
+  skeleton sk    = copy (prefix);
   int      offset= first_page - 1;
   H->assemble_skeleton (sk, path (N (l)), offset);
   // cout << HRULE << LF;
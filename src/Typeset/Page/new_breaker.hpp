@@ -26,6 +26,7 @@ struct new_breaker_rep {
   font             fn;
   int              first_page;
   int              quality;
+  int              start; // first page_item to be broken
 
   bool last_page_flag; // FIXME
 
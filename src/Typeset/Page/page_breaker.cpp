@@ -139,7 +139,7 @@ struct page_breaker_rep {
   void     assemble_skeleton (skeleton& sk, int last);
   void     assemble_skeleton (skeleton& sk);
   void     assemble_skeleton (skeleton& sk, int start, int end);
-  skeleton make_skeleton ();
+  skeleton make_skeleton (skeleton prefix, int start);
 };
 
 /******************************************************************************
@@ -1455,12 +1455,13 @@ page_breaker_rep::assemble_skeleton (skeleton& sk, int start, int end) {
 }
 
 skeleton
-page_breaker_rep::make_skeleton () {
-  skeleton sk;
+page_breaker_rep::make_skeleton (skeleton prefix, int start) {
+  // The pagelets of prefix are those before the new page at start
+  skeleton sk= copy (prefix);
   int      i, j, n= N (l);
   bool     dpage_flag = false;
   int      page_offset= first_page - 1;
-  for (i= 0, j= 0; j < n; j++) {
+  for (i= start, j= start; j < n; j++) {
     if ((!papyrus_mode) && (l[j]->type == PAGE_CONTROL_ITEM)) {
       if ((l[j]->t == PAGE_BREAK) || (l[j]->t == NEW_PAGE) ||
           (l[j]->t == NEW_DPAGE)) {
@@ -1489,20 +1490,30 @@ page_breaker_rep::make_skeleton () {
 
 skeleton new_break_pages (array<page_item> l, space ph, int qual, space fn_sep,
                           space fnote_sep, space float_sep, font fn,
-                          int first_page);
+                          int first_page, skeleton prefix, int start);
 
 skeleton
 break_pages (array<page_item> l, space ph, int qual, space fn_sep,
-             space fnote_sep, space float_sep, font fn, int first_page) {
+             space fnote_sep, space float_sep, font fn, int first_page,
+             skeleton prefix, int start) {
+  // Only break the page_items from start on, which should be a new page;
+  // prefix contains the already known pagelets for the items before start
   if (get_user_preference ("new style page breaking") != "off")
     return new_break_pages (l, ph, qual, fn_sep, fnote_sep, float_sep, fn,
-                            first_page);
+                            first_page, prefix, start);
   else {
     page_breaker_rep* H= tm_new<page_breaker_rep> (
         l, ph, qual, fn_sep, fnote_sep, float_sep, fn, first_page);
     // cout << HRULE << LF;
-    skeleton sk= H->make_skeleton ();
+    skeleton sk= H->make_skeleton (prefix, start);
     tm_delete (H);
     return sk;
   }
 }
+
+skeleton
+break_pages (array<page_item> l, space ph, int qual, space fn_sep,
+             space fnote_sep, space float_sep, font fn, int first_page) {
+  return break_pages (l, ph, qual, fn_sep, fnote_sep, float_sep, fn,
+                      first_page, skeleton (), 0);
+}
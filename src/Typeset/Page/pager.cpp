@@ -11,6 +11,7 @@
 
 #include "pager.hpp"
 #include "Boxes/construct.hpp"
+#include "tm_profile.hpp"
 
 using namespace moebius;
 
@@ -54,6 +55,7 @@ pager_rep::pager_rep (path ip2, edit_env env2, array<page_item> l2)
 
   page_offset= env->first_page - 1;
   cur_top    = 0;
+  prev       = NULL;
 }
 
 /******************************************************************************
@@ -260,6 +262,7 @@ pager_rep::adjust_margins (bool empty_flag) {
 
 box
 pager_rep::make_pages () {
+  PROFILE_SCOPE ("pages");
   if (paper) pages_make ();
   else papyrus_make ();
 
@@ -268,8 +271,9 @@ pager_rep::make_pages () {
   int d       = env->page_offset % nx;
   int ny      = ((nr_pages + nx - 1 + d) / nx);
 
+  // Borders are added to a copy, so that the pages can be reused as such
   SI         pixel= env->pixel;
-  array<box> pg   = pages;
+  array<box> pg   = copy (pages);
   if (env->get_string (PAGE_MEDIUM) == "paper" &&
       env->get_string (PAGE_BORDER) != "none")
     for (int i= 0; i < nx; i++)
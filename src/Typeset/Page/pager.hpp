@@ -50,7 +50,9 @@ public:
 
   int        page_offset;
   SI         cur_top;
-  array<box> pages;
+  skeleton   sk;    // page breaks of the document
+  array<box> pages; // the formatted pages
+  pager_rep* prev;  // pager of the previous typesetting of the document
 
   array<box>   lines_bx;
   array<space> lines_ht;
@@ -63,6 +65,12 @@ protected: // making papyrus boxes
   void papyrus_mcolumn (array<page_item>& l);
   void papyrus_make (array<page_item> l);
 
+protected: // reusing the pages of the previous typesetting
+  bool same_layout (pager_rep* old);
+  int  pages_stable (int& start);
+  void pages_control (page_item item);
+  void pages_control (pagelet pg);
+
 protected: // making page boxes
   box  pages_format (array<page_item> l, SI ht, SI tcor, SI bcor);
   box  pages_format (insertion ins);
@@ -121,6 +121,47 @@ using moebius::drd::drd_info;
 #define INFO_PAPER 4
 #define INFO_SHORT_PAPER 5
 
+/******************************************************************************
+ * Parsed values of environment variables
+ ******************************************************************************/
+
+#define ENV_PARSED_SIZE 512
+
+#define PARSED_INT 1
+#define PARSED_DOUBLE 2
+#define PARSED_COLOR 4
+#define PARSED_LENGTH 8
+
+struct env_parsed {
+  string key;   // the atomic value which has been parsed
+  int    done;  // the fields below which have been computed for key
+  int    i;     // value as an integer
+  double d;     // value as a floating point number
+  int    alpha; // opacity for which the color has been computed
+  color  c;     // value as a color
+  double len;   // numeric part of a length
+  tree   unit;  // macro for the unit of a length, UNINIT if invalid
+
+  inline env_parsed () : done (0) {}
+};
+
+/******************************************************************************
+ * Recently resolved fonts
+ ******************************************************************************/
+
+#define ENV_FONTS_SIZE 8
+
+struct env_font {
+  int    mode;   // 0 for text, 2 for math and 3 for prog, -1 if unused
+  string var[8]; // text font variables, followed by math or prog ones
+  double sz;     // script size
+  int    dpi;    // magnified resolution
+  string eff;    // font effects
+  font   fn;     // the resolved font
+
+  inline env_font () : mode (-1) {}
+};
+
 /******************************************************************************
  * The edit environment
  ******************************************************************************/
@@ -135,6 +176,9 @@ public:
 private:
   hashmap<string, tree> env;
   hashmap<string, tree> back;
+  array<env_parsed>     parsed;     // cache of parsed atomic values
+  array<env_font>       fonts;      // recently resolved fonts
+  int                   fonts_next; // slot in fonts to be replaced next
 
 public:
   hashmap<string, path>       src;
@@ -154,6 +198,7 @@ public:
   hashmap<string, tree>& global_att;
   bool                   complete;    // typeset complete document ?
   bool                   read_only;   // write-protected ?
+  bool                   printed;     // depends on page-printed ?
   hashmap<string, tree>  missing;     // missing refs
   array<tree>            redefined;   // redefined labels
   hashmap<string, bool>  touched;     // touched refs
@@ -504,6 +549,7 @@ public:
   void monitored_patch_env (hashmap<string, tree> patch);
   void patch_env (hashmap<string, tree> patch);
   void read_env (hashmap<string, tree>& ret);
+  void read_env (hashmap<string, tree> base, hashmap<string, tree>& ret);
   void local_start (hashmap<string, tree>& prev_back);
   void local_update (hashmap<string, tree>& oldpat, hashmap<string, tree>& chg);
   void local_end (hashmap<string, tree>& prev_back);
@@ -566,6 +612,14 @@ public:
   point as_point (tree t);
 
   /* retrieving environment variables */
+  inline env_parsed& parsed_slot (string s) {
+    env_parsed& p= parsed[hash (s) & (ENV_PARSED_SIZE - 1)];
+    if (p.key != s) {
+      p.key = s;
+      p.done= 0;
+    }
+    return p;
+  }
   inline bool get_bool (string var) {
     tree t= env[var];
     if (is_compound (t)) return false;
@@ -574,12 +628,22 @@ public:
   inline int get_int (string var) {
     tree t= env[var];
     if (is_compound (t)) return 0;
-    return as_int (t->label);
+    env_parsed& p= parsed_slot (t->label);
+    if ((p.done & PARSED_INT) == 0) {
+      p.i   = as_int (t->label);
+      p.done= p.done | PARSED_INT;
+    }
+    return p.i;
   }
   inline double get_double (string var) {
     tree t= env[var];
     if (is_compound (t)) return 0.0;
-    return as_double (t->label);
+    env_parsed& p= parsed_slot (t->label);
+    if ((p.done & PARSED_DOUBLE) == 0) {
+      p.d   = as_double (t->label);
+      p.done= p.done | PARSED_DOUBLE;
+    }
+    return p.d;
   }
   inline string get_string (string var) {
     tree t= env[var];
@@ -596,7 +660,14 @@ public:
   }
   inline color get_color (string var) {
     tree t= env[var];
-    return named_color (as_string (t), alpha);
+    if (is_compound (t)) return named_color (as_string (t), alpha);
+    env_parsed& p= parsed_slot (t->label);
+    if ((p.done & PARSED_COLOR) == 0 || p.alpha != alpha) {
+      p.c    = named_color (t->label, alpha);
+      p.alpha= alpha;
+      p.done = p.done | PARSED_COLOR;
+    }
+    return p.c;
   }
 
   friend class edit_env;
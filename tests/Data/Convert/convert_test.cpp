@@ -25,6 +25,8 @@ class TestConverter : public QObject {
 private slots:
   void test_search_metadata_data ();
   void test_search_metadata ();
+  void test_texmacs_to_tree_data ();
+  void test_texmacs_to_tree ();
 };
 
 void
@@ -72,5 +74,35 @@ TestConverter::test_search_metadata () {
   qcompare (search_metadata (input_tree, "invalid"), invalid);
 }
 
+void
+TestConverter::test_texmacs_to_tree_data () {
+  QTest::addColumn<string> ("input");
+  QTest::addColumn<tree> ("expected");
+
+  QTest::newRow ("plain text")
+      << string ("hello world") << tree (DOCUMENT, "hello world");
+  QTest::newRow ("escaped characters")
+      << string ("a\\<less\\>b\\\\c") << tree (DOCUMENT, "a<less>b\\c");
+  QTest::newRow ("line continuation")
+      << string ("long\\\n  line") << tree (DOCUMENT, "longline");
+  QTest::newRow ("paragraphs")
+      << string ("a\n\nb") << tree (DOCUMENT, "a", "b");
+  QTest::newRow ("inline tag")
+      << string ("<strong|bold> text")
+      << tree (DOCUMENT, tree (CONCAT, compound ("strong", "bold"), " text"));
+  QTest::newRow ("primitive tag")
+      << string ("<with|color|red|y>")
+      << tree (DOCUMENT, tree (WITH, "color", "red", "y"));
+  QTest::newRow ("raw data")
+      << string ("<#48656C6C6F>") << tree (DOCUMENT, tree (RAW_DATA, "Hello"));
+}
+
+void
+TestConverter::test_texmacs_to_tree () {
+  QFETCH (string, input);
+  QFETCH (tree, expected);
+  QVERIFY (texmacs_to_tree (input) == expected);
+}
+
 QTEST_MAIN (TestConverter)
 #include "convert_test.moc"
@@ -0,0 +1,112 @@
+/******************************************************************************
+ * MODULE     : journal_test.cpp
+ * DESCRIPTION: Properties of journals of modifications
+ * COPYRIGHT  : (C) 2026 Darcy Shen
+ *******************************************************************************
+ * This software falls under the GNU general public license version 3 or later.
+ * It comes WITHOUT ANY WARRANTY WHATSOEVER. For details, see the file LICENSE
+ * in the root directory or <http://www.gnu.org/licenses/gpl-3.0.html>.
+ ******************************************************************************/
+
+#include "journal.hpp"
+
+#include "base.hpp"
+#include "tree_helper.hpp"
+#include <QtTest/QtTest>
+#include <moebius/drd/drd_std.hpp>
+
+using namespace moebius;
+
+class TestJournal : public QObject {
+  Q_OBJECT
+
+private slots:
+  void initTestCase ();
+  void test_round_trip ();
+  void test_truncated ();
+  void test_replay ();
+};
+
+void
+TestJournal::initTestCase () {
+  init_lolly ();
+  moebius::drd::init_std_drd ();
+}
+
+#define NR_MODIFICATIONS 9
+
+static modification
+some_modification (int i) {
+  tree foo (make_tree_label ("foo"));
+  switch (i) {
+  case 0:
+    return mod_assign (path (0), tree (CONCAT, "a", foo));
+  case 1:
+    return mod_insert (path (0), 1, tree (CONCAT, "b", "c"));
+  case 2:
+    return mod_insert (path (0, 0), 1, "xyz");
+  case 3:
+    return mod_remove (path (0, 0), 0, 2);
+  case 4:
+    return mod_split (path (), 0, 1);
+  case 5:
+    return mod_join (path (), 0);
+  case 6:
+    return mod_assign_node (path (0), WITH);
+  case 7:
+    return mod_insert_node (path (0), 1, tree (WITH, "color", "red"));
+  default:
+    return mod_remove_node (path (0), 1);
+  }
+}
+
+void
+TestJournal::test_round_trip () {
+  string s= journal_header ("123:456");
+  for (int i= 0; i < NR_MODIFICATIONS; i++)
+    journal_append (s, some_modification (i));
+  int    pos= 0;
+  string stamp;
+  QVERIFY (journal_read_header (s, pos, stamp));
+  QVERIFY (stamp == "123:456");
+  modification mod (MOD_ASSIGN, path ());
+  for (int i= 0; i < NR_MODIFICATIONS; i++) {
+    QVERIFY (journal_read (s, pos, mod));
+    QVERIFY (mod == some_modification (i));
+  }
+  QVERIFY (!journal_read (s, pos, mod));
+}
+
+void
+TestJournal::test_truncated () {
+  string s;
+  journal_append (s, some_modification (0));
+  int end= N (s);
+  journal_append (s, some_modification (1));
+  s= s (0, N (s) - 1);
+  int          pos= 0;
+  modification mod (MOD_ASSIGN, path ());
+  QVERIFY (journal_read (s, pos, mod));
+  QVERIFY (pos == end);
+  QVERIFY (!journal_read (s, pos, mod));
+}
+
+void
+TestJournal::test_replay () {
+  tree   doc (DOCUMENT, "hello", "world");
+  string s= journal_header ("");
+  journal_append (s, mod_insert (path (0), 5, " there"));
+  journal_append (s, mod_insert (path (), 2, tree (DOCUMENT, "!")));
+  journal_append (s, mod_remove (path (), 1, 1));
+  journal_append (s, mod_insert (path (), 9, tree (DOCUMENT, "?")));
+  journal_append (s, mod_remove (path (), 0, 1));
+  int    pos= 0;
+  string stamp;
+  QVERIFY (journal_read_header (s, pos, stamp));
+  // replaying stops at the first modification which does not apply
+  tree res= journal_replay (doc, s, pos);
+  QVERIFY (res == tree (DOCUMENT, "hello there", "!"));
+}
+
+QTEST_MAIN (TestJournal)
+#include "journal_test.moc"
@@ -0,0 +1,152 @@
+/******************************************************************************
+ * MODULE     : ip_observer_test.cpp
+ * DESCRIPTION: Tests on the maintenance of inverse paths under edits
+ * COPYRIGHT  : (C) 2026 Darcy Shen
+ *******************************************************************************
+ * This software falls under the GNU general public license version 3 or later.
+ * It comes WITHOUT ANY WARRANTY WHATSOEVER. For details, see the file LICENSE
+ * in the root directory or <http://www.gnu.org/licenses/gpl-3.0.html>.
+ ******************************************************************************/
+
+#include <QtTest/QtTest>
+
+#include "base.hpp"
+#include "modification.hpp"
+#include "observers.hpp"
+#include "tree_helper.hpp"
+#include "tree_observer.hpp"
+
+using namespace moebius;
+
+extern tree the_et;
+
+class TestIpObserver : public QObject {
+  Q_OBJECT
+
+private slots:
+  void init ();
+  void test_insert_remove ();
+  void test_split_join ();
+  void test_insert_remove_node ();
+  void test_captured_ips ();
+};
+
+static tree
+paragraph (int i) {
+  return tree (CONCAT, "Paragraph ", tree (WITH, "font-series", "bold", "x"),
+               tree (FRAC, "a", as_string (i)));
+}
+
+static bool
+same_ips (tree& t, path ip) {
+  // compare the maintained inverse paths with a recomputation from scratch
+  if (obtain_ip (t) != ip) return false;
+  if (is_compound (t))
+    for (int i= 0; i < N (t); i++)
+      if (!same_ips (t[i], path (i, ip))) return false;
+  return true;
+}
+
+static bool
+same_ips () {
+  return same_ips (the_et, path ());
+}
+
+void
+TestIpObserver::init () {
+  init_lolly ();
+  the_et      = tuple ();
+  the_et->data= ip_observer (path ());
+  tree doc (DOCUMENT);
+  for (int i= 0; i < 20; i++)
+    doc << paragraph (i);
+  insert (the_et, 0, tuple (doc));
+  QVERIFY (same_ips ());
+}
+
+void
+TestIpObserver::test_insert_remove () {
+  tree& doc= the_et[0];
+  insert (doc, 0, tree (DOCUMENT, paragraph (100), paragraph (101)));
+  QVERIFY (same_ips ());
+  insert (doc, 10, tree (DOCUMENT, paragraph (102)));
+  QVERIFY (same_ips ());
+  insert (doc[5], 1, tree (CONCAT, "inserted"));
+  QVERIFY (same_ips ());
+  remove (doc, 0, 3);
+  QVERIFY (same_ips ());
+  remove (doc, 7, 2);
+  QVERIFY (same_ips ());
+  remove (doc[3], 0, 1);
+  QVERIFY (same_ips ());
+  // move a paragraph further down
+  tree p= copy (doc[1]);
+  remove (doc, 1, 1);
+  insert (doc, 12, tree (DOCUMENT, p));
+  QVERIFY (same_ips ());
+  QVERIFY (N (doc) == 18);
+}
+
+void
+TestIpObserver::test_split_join () {
+  tree& doc= the_et[0];
+  split (doc, 2, 1);
+  QVERIFY (same_ips ());
+  QVERIFY (N (doc) == 21);
+  join (doc, 2);
+  QVERIFY (same_ips ());
+  split (doc[4], 0, 4);
+  QVERIFY (same_ips ());
+  join (doc[4], 0);
+  QVERIFY (same_ips ());
+  split (doc, 0, 2);
+  split (doc, 5, 1);
+  QVERIFY (same_ips ());
+  join (doc, 0);
+  join (doc, 4);
+  QVERIFY (same_ips ());
+  QVERIFY (N (doc) == 20);
+}
+
+void
+TestIpObserver::test_insert_remove_node () {
+  tree& doc= the_et[0];
+  insert_node (doc[3], 0, tree (WITH, "color", "red"));
+  QVERIFY (same_ips ());
+  insert_node (doc, 0, tree (SURROUND, "", ""));
+  QVERIFY (same_ips ());
+  insert (the_et[0][0], 0, tree (DOCUMENT, paragraph (100)));
+  QVERIFY (same_ips ());
+  remove_node (the_et[0], 0);
+  QVERIFY (same_ips ());
+  remove_node (the_et[0][4], 2);
+  QVERIFY (same_ips ());
+  remove (the_et[0], 0, 1);
+  QVERIFY (same_ips ());
+  QVERIFY (N (the_et[0]) == 20);
+}
+
+void
+TestIpObserver::test_captured_ips () {
+  // Boxes and bridges keep the inverse paths they were typeset with.
+  // As before, these follow the trees which move to a new position
+  tree& doc = the_et[0];
+  path  p_ip= obtain_ip (doc[5]);
+  path  c_ip= obtain_ip (doc[5][2][1]);
+  insert (doc, 0, tree (DOCUMENT, paragraph (100), paragraph (101)));
+  QVERIFY (same_ips ());
+  QVERIFY (p_ip == obtain_ip (doc[7]));
+  QVERIFY (c_ip == obtain_ip (doc[7][2][1]));
+  QVERIFY (p_ip == path (7, obtain_ip (doc)));
+  remove (doc, 0, 4);
+  QVERIFY (same_ips ());
+  QVERIFY (p_ip == path (3, obtain_ip (doc)));
+  QVERIFY (c_ip == path (1, path (2, p_ip)));
+  path r_ip= obtain_ip (doc[0]);
+  remove (doc, 0, 1);
+  QVERIFY (!ip_attached (r_ip));
+  QVERIFY (same_ips ());
+}
+
+QTEST_MAIN (TestIpObserver)
+#include "ip_observer_test.moc"
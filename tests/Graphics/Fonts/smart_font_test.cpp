@@ -35,6 +35,8 @@ private slots:
   void test_resolve_first_attempt ();
   void test_resolve_chinese_puncts ();
   void test_get_right_slope ();
+  void test_unicode_char_code ();
+  void test_font_key ();
 };
 
 void
@@ -100,5 +102,37 @@ TestSmartFont::test_get_right_slope () {
   QCOMPARE (fn_rep->get_right_slope (utf8_to_cork ("典")), 0.0);
 }
 
+void
+TestSmartFont::test_unicode_char_code () {
+  int end= 0;
+  QCOMPARE (unicode_char_code ("<#4E2D>", 0, end), 0x4E2D);
+  QCOMPARE (end, 7);
+  QCOMPARE (unicode_char_code ("a<#1D44E>b", 1, end), 0x1D44E);
+  QCOMPARE (end, 9);
+  // non canonical or invalid characters
+  QCOMPARE (unicode_char_code ("<#4e2d>", 0, end), -1);
+  QCOMPARE (unicode_char_code ("<#04E2D>", 0, end), -1);
+  QCOMPARE (unicode_char_code ("<#110000>", 0, end), -1);
+  QCOMPARE (unicode_char_code ("<alpha>", 0, end), -1);
+  QCOMPARE (unicode_char_code ("<#20", 0, end), -1);
+}
+
+void
+TestSmartFont::test_font_key () {
+  font_key k1 ("sys-chinese", "rm", "medium", "right", 10, 600, 600);
+  font_key k2 ("sys-chinese", "rm", "medium", "right", 10, 600, 600);
+  font_key k3 ("sys-chinese", "rm", "medium", "right", 10.5, 600, 600);
+  QVERIFY (k1 == k2);
+  QCOMPARE (hash (k1), hash (k2));
+  QVERIFY (k1 != k3);
+
+  font fn1= smart_font ("sys-chinese", "rm", "medium", "right", 10, 600);
+  font fn2= smart_font ("sys-chinese", "rm", "medium", "right", 10, 600);
+  font fn3= smart_font ("sys-chinese", "rm", "bold", "right", 10, 600);
+  QVERIFY (fn1.rep == fn2.rep);
+  QVERIFY (fn1.rep != fn3.rep);
+  QCOMPARE (fn2->res_name, "sys-chinese-rm-medium-right-10-600-smart");
+}
+
 QTEST_MAIN (TestSmartFont)
 #include "smart_font_test.moc"
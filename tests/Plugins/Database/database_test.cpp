@@ -0,0 +1,180 @@
+/******************************************************************************
+ * MODULE     : database_test.cpp
+ * DESCRIPTION: Tests on the indexed storage of databases
+ * COPYRIGHT  : (C) 2026  Darcy Shen
+ *******************************************************************************
+ * This software falls under the GNU general public license version 3 or later.
+ * It comes WITHOUT ANY WARRANTY WHATSOEVER. For details, see the file LICENSE
+ * in the root directory or <http://www.gnu.org/licenses/gpl-3.0.html>.
+ ******************************************************************************/
+
+#include <QtTest/QtTest>
+
+#include "Database/database.hpp"
+#include "base.hpp"
+#include "file.hpp"
+#include "tree_helper.hpp"
+
+using namespace moebius;
+
+class TestDatabase : public QObject {
+  Q_OBJECT
+
+private slots:
+  void init () { init_lolly (); }
+  void test_history ();
+  void test_query ();
+  void test_completions ();
+  void test_persistence ();
+  void test_failed_rewrite ();
+};
+
+static tree
+entry (string type, string name, string author, string year) {
+  return tuple (tuple ("\"type\"", "\"" * type * "\""),
+                tuple ("\"name\"", "\"" * name * "\""),
+                tuple ("\"author\"", "\"" * author * "\""),
+                tuple ("\"year\"", "\"" * year * "\""));
+}
+
+static array<string>
+strings (string s1, string s2= "", string s3= "") {
+  array<string> r;
+  if (s1 != "") r << s1;
+  if (s2 != "") r << s2;
+  if (s3 != "") r << s3;
+  return r;
+}
+
+static void
+fill (database db) {
+  db->set_entry ("e1", entry ("book", "knuth84", "Donald Knuth", "1984"), 10);
+  db->set_entry ("e2", entry ("article", "hoeven02", "Joris van der Hoeven",
+                              "2002"),
+                 10);
+  db->set_entry ("e3", entry ("article", "knuth77", "Donald Knuth", "1977"),
+                 10);
+}
+
+void
+TestDatabase::test_history () {
+  database db (url_none ());
+  db->set_field ("e", "title", strings ("Old"), 10);
+  db->set_field ("e", "title", strings ("New", "Newer"), 20);
+  QVERIFY (db->get_field ("e", "title", 15) == strings ("Old"));
+  QVERIFY (db->get_field ("e", "title", 25) == strings ("New", "Newer"));
+  QVERIFY (N (db->get_field ("e", "title", 5)) == 0);
+  QVERIFY (N (db->get_field ("e", "title", 0)) == 3);
+  db->remove_entry ("e", 30);
+  QVERIFY (N (db->get_attributes ("e", 35)) == 0);
+  QVERIFY (db->get_attributes ("e", 25) == strings ("title"));
+  db->history= false;
+  db->set_field ("f", "title", strings ("Old"), 10);
+  db->set_field ("f", "title", strings ("New"), 20);
+  QVERIFY (db->get_field ("f", "title", 0) == strings ("New"));
+}
+
+void
+TestDatabase::test_query () {
+  database db (url_none ());
+  fill (db);
+  QVERIFY (db->get_entry ("e1", 20) ==
+           entry ("book", "knuth84", "Donald Knuth", "1984"));
+  tree q= tuple (tuple ("\"type\"", "\"article\""));
+  QVERIFY (db->query (q, 20, 100) == strings ("e2", "e3"));
+  q= tuple (tuple ("contains", "\"knuth\""));
+  QVERIFY (db->query (q, 20, 100) == strings ("e1", "e3"));
+  q= tuple (tuple ("completes", "\"don knu\""),
+           tuple ("\"type\"", "\"book\""));
+  QVERIFY (db->query (q, 20, 100) == strings ("e1"));
+  q= tuple (tuple ("contains", "\"knuth\""),
+           tuple ("order", "\"year\"", "#t"));
+  QVERIFY (db->query (q, 20, 100) == strings ("e3", "e1"));
+  q= tuple (tuple ("order", "\"year\"", "#f"));
+  QVERIFY (db->query (q, 20, 2) == strings ("e2", "e1"));
+  q= tuple (tuple ("modified", "5", "15"));
+  QVERIFY (N (db->query (q, 0, 100)) == 3);
+  db->remove_entry ("e3", 30);
+  q= tuple (tuple ("contains", "\"knuth\""));
+  QVERIFY (db->query (q, 40, 100) == strings ("e1"));
+  QVERIFY (db->query (q, 20, 100) == strings ("e1", "e3"));
+}
+
+void
+TestDatabase::test_completions () {
+  database db (url_none ());
+  fill (db);
+  QVERIFY (db->get_completions ("kn") ==
+           strings ("knuth", "knuth77", "knuth84"));
+  QVERIFY (db->get_completions ("d") == strings ("der", "donald"));
+  QVERIFY (db->get_name_completions ("knuth") ==
+           strings ("knuth77", "knuth84"));
+  db->remove_entry ("e1", 30);
+  QVERIFY (db->get_name_completions ("knuth") == strings ("knuth77"));
+}
+
+void
+TestDatabase::test_persistence () {
+  url u= url_temp (".tmdb");
+  {
+    database db (u);
+    QVERIFY (db->load ());
+    fill (db);
+    db->remove_entry ("e2", 30);
+    db->history= false;
+    db->set_field ("e1", "year", strings ("1986"), 40);
+  }
+  database db (u);
+  QVERIFY (db->load ());
+  QVERIFY (db->get_field ("e1", "year", 50) == strings ("1986"));
+  QVERIFY (N (db->get_attributes ("e2", 50)) == 0);
+  QVERIFY (N (db->get_attributes ("e2", 20)) == 4);
+  tree q= tuple (tuple ("contains", "\"knuth\""));
+  QVERIFY (db->query (q, 50, 100) == strings ("e1", "e3"));
+  // a record truncated by a crash is ignored
+  string s;
+  QVERIFY (!load_string (u, s, false));
+  QVERIFY (!save_string (u, s * "\x10L", false));
+  database db2 (u);
+  QVERIFY (db2->load ());
+  QVERIFY (db2->get_field ("e1", "year", 50) == strings ("1986"));
+  db2->set_field ("e3", "year", strings ("1978"), 60);
+  database db3 (u);
+  QVERIFY (db3->load ());
+  QVERIFY (db3->get_field ("e3", "year", 70) == strings ("1978"));
+  remove (u);
+}
+
+void
+TestDatabase::test_failed_rewrite () {
+  url u= url_temp (".tmdb");
+  {
+    database db (u);
+    QVERIFY (db->load ());
+    db->history= false;
+    fill (db);
+    db->remove_entry ("e2", 30);
+    // a directory in place of the temporary file makes the rewrite fail
+    url tmp= glue (u, ".new");
+    mkdir (tmp);
+    QVERIFY (!db->rewrite ());
+    QVERIFY (db->dropped > 0);
+    db->set_field ("e3", "year", strings ("1978"), 40);
+    db->remove_entry ("e1", 50);
+    rmdir (tmp);
+    QVERIFY (db->rewrite ());
+    QVERIFY (db->dropped == 0);
+    db->set_field ("e3", "title", strings ("Volume 2"), 60);
+  }
+  database db (u);
+  QVERIFY (db->load ());
+  QVERIFY (N (db->get_attributes ("e1", 70)) == 0);
+  QVERIFY (N (db->get_attributes ("e2", 70)) == 0);
+  QVERIFY (db->get_field ("e3", "year", 70) == strings ("1978"));
+  QVERIFY (db->get_field ("e3", "title", 70) == strings ("Volume 2"));
+  QVERIFY (db->get_field ("e3", "author", 70) == strings ("Donald Knuth"));
+  remove (u);
+}
+
+QTEST_MAIN (TestDatabase)
+#include "database_test.moc"
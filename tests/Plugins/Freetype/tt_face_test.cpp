@@ -0,0 +1,98 @@
+/******************************************************************************
+ * MODULE     : tt_face_test.cpp
+ * DESCRIPTION: Test cases for the metrics of True Type fonts
+ * COPYRIGHT  : (C) 2026  Mogan Developers
+ *******************************************************************************
+ * This software falls under the GNU general public license version 3 or later.
+ * It comes WITHOUT ANY WARRANTY WHATSOEVER. For details, see the file LICENSE
+ * in the root directory or <http://www.gnu.org/licenses/gpl-3.0.html>.
+ ******************************************************************************/
+
+#include "Freetype/tt_face.hpp"
+#include "Freetype/free_type.hpp"
+#include "base.hpp"
+#include "data_cache.hpp"
+#include "tm_sys_utils.hpp"
+#include <QtTest/QtTest>
+
+class TestTTFace : public QObject {
+  Q_OBJECT
+
+private:
+  font_metric fnm;
+
+private slots:
+  void init () {
+    init_lolly ();
+    init_texmacs_home_path ();
+    cache_initialize ();
+    fnm= tt_font_metric ("DejaVuSerif", 10.0, 600, 600);
+    if (fnm->bad_font_metric) QSKIP ("DejaVuSerif not available");
+  }
+  void test_get ();
+  void test_blocks ();
+  void test_kernings ();
+  void test_bitmap_sizes ();
+};
+
+void
+TestTTFace::test_get () {
+  metric_struct* A= fnm->get ('A');
+  QVERIFY (A->x2 > 0);
+  QVERIFY (A->y2 > 0);
+  QVERIFY (A->x3 < A->x4);
+  QVERIFY (A->y3 < A->y4);
+  metric_struct* dot= fnm->get ('.');
+  QVERIFY (dot->x2 < A->x2);
+  QVERIFY (dot->y4 < A->y4);
+}
+
+void
+TestTTFace::test_blocks () {
+  metric_struct* A= fnm->get ('A');
+  (void) fnm->get (0x4e2d);
+  (void) fnm->get ('B');
+  QCOMPARE ((void*) fnm->get ('A'), (void*) A);
+  QVERIFY (fnm->exists ('A'));
+}
+
+void
+TestTTFace::test_kernings () {
+  int codes[]= {'A', 'V', 'A', 'W', 'A', 'Y', ' ', 'T', 'o'};
+  int n      = sizeof (codes) / sizeof (int);
+  SI  ks[9];
+  fnm->kernings (codes, n, ks);
+  QCOMPARE (ks[0], 0);
+  for (int i= 1; i < n; i++) {
+    QCOMPARE (ks[i], fnm->kerning (codes[i - 1], codes[i]));
+    QCOMPARE (ks[i], fnm->kerning (codes[i - 1], codes[i]));
+  }
+}
+
+void
+TestTTFace::test_bitmap_sizes () {
+  // the metrics are computed without rendering the glyphs;
+  // the physical boxes should match the rendered bitmaps
+  tt_face face   = load_tt_face ("DejaVuSerif");
+  int     codes[]= {'A', 'g', '.', ' ', 'i', '|', '_', 0x2014, 0x222b};
+  double  sizes[]= {5.0, 10.0, 10.5, 17.28};
+  int     dpis[] = {72, 96, 600};
+  for (double size : sizes)
+    for (int dpi : dpis) {
+      font_metric fm= tt_font_metric ("DejaVuSerif", size, dpi, dpi);
+      for (int c : codes) {
+        metric_struct* M= fm->get (c);
+        face->set_char_size (size, dpi, dpi);
+        FT_UInt gi= ft_get_char_index (face->ft_face, c);
+        QVERIFY (gi != 0);
+        QVERIFY (!ft_load_glyph (face->ft_face, gi, FT_LOAD_DEFAULT));
+        FT_GlyphSlot slot= face->ft_face->glyph;
+        QVERIFY (!ft_render_glyph (slot, ft_render_mode_mono));
+        QCOMPARE (M->x4 - M->x3, (SI) slot->bitmap.width * PIXEL);
+        QCOMPARE (M->y4 - M->y3, (SI) slot->bitmap.rows * PIXEL);
+      }
+    }
+}
+
+QTEST_MAIN (TestTTFace)
+#include "tt_face_test.moc"
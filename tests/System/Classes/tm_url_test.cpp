@@ -21,6 +21,7 @@ class TestTMURL : public QObject {
 private slots:
   void init () { init_lolly (); }
   void test_complete ();
+  void test_exists_in_path ();
 };
 
 void
@@ -32,5 +33,18 @@ TestTMURL::test_complete () {
   }
 }
 
+void
+TestTMURL::test_exists_in_path () {
+  if (!os_win ()) {
+    // the repeated lookups are answered by the cached directory listings
+    for (int i= 0; i < 2; i++) {
+      QVERIFY (exists_in_path ("sh"));
+      QVERIFY (!exists_in_path ("no-such-program-for-texmacs"));
+      QVERIFY (!is_none (resolve (url_path ("$PATH") * "sh", "x")));
+      QVERIFY (is_none (resolve (url_path ("$PATH") * "sh", "d")));
+    }
+  }
+}
+
 QTEST_MAIN (TestTMURL)
 #include "tm_url_test.moc"
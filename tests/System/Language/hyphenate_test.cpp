@@ -0,0 +1,61 @@
+/******************************************************************************
+ * MODULE     : hyphenate_test.cpp
+ * COPYRIGHT  : (C) 2025  Mogan Developers
+ *******************************************************************************
+ * This software falls under the GNU general public license version 3 or later.
+ * It comes WITHOUT ANY WARRANTY WHATSOEVER. For details, see the file LICENSE
+ * in the root directory or <http://www.gnu.org/licenses/gpl-3.0.html>.
+ ******************************************************************************/
+
+#include "base.hpp"
+#include "hyphenate.hpp"
+#include <QtTest/QtTest>
+
+static string
+break_points (string s, hyphen_table table) {
+  array<int> penalty= get_hyphens (s, table);
+  string     r;
+  for (int i= 0; i < N (penalty); i++)
+    r << (penalty[i] < HYPH_INVALID ? '1' : '0');
+  return r;
+}
+
+class TestHyphenate : public QObject {
+  Q_OBJECT
+
+private slots:
+  void init () { init_lolly (); }
+  void test_patterns ();
+  void test_exceptions ();
+  void test_cache ();
+};
+
+void
+TestHyphenate::test_patterns () {
+  hyphen_table us= load_hyphen_table ("us", true);
+  qcompare (break_points ("hyphenation", us), "0000010000");
+  qcompare (break_points ("typesetting", us), "0001001000");
+  qcompare (break_points ("Mathematics", us), "0001100000");
+  qcompare (break_points ("table", us), "0100");
+}
+
+void
+TestHyphenate::test_exceptions () {
+  hyphen_table us= load_hyphen_table ("us", true);
+  qcompare (break_points ("project", us), "000000");
+  qcompare (break_points ("present", us), "000000");
+}
+
+void
+TestHyphenate::test_cache () {
+  hyphen_table us= load_hyphen_table ("us", true);
+  string       w = break_points ("typesetting", us);
+  for (int i= 0; i <= HYPHEN_CACHE_SIZE; i++)
+    (void) get_hyphens (string ("word") * as_string (i), us);
+  QVERIFY (N (us->cache_word) == HYPHEN_CACHE_SIZE);
+  QVERIFY (!us->cache_slot->contains ("typesetting"));
+  qcompare (break_points ("typesetting", us), w);
+}
+
+QTEST_MAIN (TestHyphenate)
+#include "hyphenate_test.moc"
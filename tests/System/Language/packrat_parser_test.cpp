@@ -0,0 +1,318 @@
+/******************************************************************************
+ * MODULE     : packrat_parser_test.cpp
+ * DESCRIPTION: Tests on the reuse of packrat parsers and their memo tables
+ * COPYRIGHT  : (C) 2026 Darcy Shen
+ *******************************************************************************
+ * This software falls under the GNU general public license version 3 or later.
+ * It comes WITHOUT ANY WARRANTY WHATSOEVER. For details, see the file LICENSE
+ * in the root directory or <http://www.gnu.org/licenses/gpl-3.0.html>.
+ ******************************************************************************/
+
+#include "analyze.hpp"
+#include "base.hpp"
+#include "packrat.hpp"
+#include "packrat_parser.hpp"
+#include "tree_helper.hpp"
+#include <QtTest/QtTest>
+#include <moebius/drd/drd_std.hpp>
+
+using namespace moebius;
+
+packrat_parser make_packrat_parser (string lan, tree in);
+packrat_parser make_packrat_parser (string lan, tree in, path in_pos);
+
+class TestPackratParser : public QObject {
+  Q_OBJECT
+
+private slots:
+  void initTestCase ();
+  void test_suffix_edits ();
+  void test_prefix_edits ();
+  void test_middle_edits ();
+  void test_left_recursion ();
+  void test_cursor ();
+  void test_eviction ();
+  void test_random_edits ();
+};
+
+/******************************************************************************
+ * Test grammars
+ ******************************************************************************/
+
+static tree
+sym (string s) {
+  return compound ("symbol", s);
+}
+
+static void
+define_expressions () {
+  // sums and products of numbers, letters, brackets and markup
+  string lan= "packrat-test";
+  packrat_define (lan, "Sum",
+                  compound ("or", compound ("concat", sym ("Sum"), "+",
+                                            sym ("Prod")),
+                            compound ("concat", sym ("Sum"), "-",
+                                      sym ("Prod")),
+                            sym ("Prod")));
+  packrat_define (lan, "Prod",
+                  compound ("or", compound ("concat", sym ("Prod"), "*",
+                                            sym ("Atom")),
+                            sym ("Atom")));
+  packrat_define (lan, "Number",
+                  compound ("repeat", compound ("range", "0", "9")));
+  packrat_define (
+      lan, "Atom",
+      compound ("or", sym ("Number"), compound ("concat", "(", sym ("Sum"), ")"),
+                compound ("concat", compound ("tm-open"), compound ("tm-args"),
+                          "</>"),
+                compound ("range", "a", "z")));
+  packrat_define (lan, "Main",
+                  compound ("concat", sym ("Sum"),
+                            compound ("not", compound ("tm-char"))));
+}
+
+static void
+define_levels () {
+  // eight levels of left recursive binary operators, as in std-math
+  string      lan     = "packrat-levels";
+  const char* ops[8][4]= {{"=", "<", ">", "#"},  {"->", "<-", "~", "|"},
+                          {"+", "-", "&", "^"},  {"*", "/", "%", "@"},
+                          {"!", "?", "$", "_"},  {"'", "`", ";", ":"},
+                          {"[", "]", "{", "}"},  {".", ",", "\\", "\""}};
+  for (int l= 0; l < 8; l++) {
+    string level= "L" * as_string (l);
+    string next = (l < 7 ? "L" * as_string (l + 1) : string ("Atom"));
+    tree   alt  = compound ("or");
+    for (int k= 0; k < 4; k++)
+      alt << tree (ops[l][k]);
+    packrat_define (lan, level * "-op", alt);
+    packrat_define (lan, level,
+                    compound ("or",
+                              compound ("concat", sym (level),
+                                        sym (level * "-op"), sym (next)),
+                              sym (next)));
+  }
+  packrat_define (
+      lan, "Atom",
+      compound ("or", compound ("repeat", compound ("range", "0", "9")),
+                compound ("concat", "(", sym ("L0"), ")"),
+                compound ("range", "a", "z")));
+}
+
+/******************************************************************************
+ * Comparing with parsers which start from scratch
+ ******************************************************************************/
+
+static bool
+same_parse (string lan, string s, tree in, path in_pos= path ()) {
+  packrat_parser inc= make_packrat_parser (lan, in, in_pos);
+  packrat_parser ref (find_packrat_grammar (lan), copy (in), copy (in_pos));
+  C              c  = encode_symbol (sym (s));
+  for (C pos= 0; pos <= N (ref->current_input); pos++) {
+    C next= ref->parse (c, pos);
+    if (inc->parse (c, pos) != next) return false;
+    if (next != PACKRAT_FAILED && inc->decode_tree_position (next) !=
+                                      ref->decode_tree_position (next))
+      return false;
+  }
+  return true;
+}
+
+static bool
+same_parses (string lan, tree in) {
+  // the public routines first parse at the start of the input
+  if (lan == "packrat-test") {
+    const char* syms[]= {"Main", "Sum", "Prod", "Atom"};
+    for (int i= 0; i < 4; i++) {
+      packrat_parser ref (find_packrat_grammar (lan), copy (in));
+      C              pos= ref->parse (encode_symbol (sym (syms[i])), 0);
+      if (packrat_correct (lan, syms[i], in) != (pos == N (ref->current_input)))
+        return false;
+      if (packrat_parse (lan, syms[i], in) != ref->decode_tree_position (pos))
+        return false;
+      if (!same_parse (lan, syms[i], in)) return false;
+    }
+  }
+  else {
+    const char* syms[]= {"L0", "L2", "L5"};
+    for (int i= 0; i < 3; i++)
+      if (!same_parse (lan, syms[i], in)) return false;
+  }
+  return true;
+}
+
+static packrat_parser_rep*
+parser (string lan, tree in) {
+  return make_packrat_parser (lan, in).operator->();
+}
+
+static bool
+reused (string lan, tree in) {
+  return make_packrat_parser (lan, in)->former_prefix >= 0;
+}
+
+static tree
+with_fraction (string s) {
+  int n= N (s);
+  return tree (CONCAT, s (0, n / 2), compound ("frac", "1", s (n / 2, n)),
+               "+1");
+}
+
+/******************************************************************************
+ * Edits at the end, at the beginning and in the middle of formulas
+ ******************************************************************************/
+
+void
+TestPackratParser::initTestCase () {
+  init_lolly ();
+  moebius::drd::init_std_drd ();
+  define_expressions ();
+  define_levels ();
+}
+
+void
+TestPackratParser::test_suffix_edits () {
+  string s= "1";
+  for (int i= 0; i < 30; i++) {
+    s << (i % 3 == 0 ? "+" : (i % 3 == 1 ? "2*" : "(a)"));
+    QVERIFY (same_parses ("packrat-test", s));
+    if (i > 0) QVERIFY (reused ("packrat-test", s));
+  }
+  while (N (s) > 1) {
+    s= s (0, N (s) - 1);
+    QVERIFY (same_parses ("packrat-test", s));
+    QVERIFY (same_parses ("packrat-test", with_fraction (s)));
+  }
+}
+
+void
+TestPackratParser::test_prefix_edits () {
+  string s= "1";
+  for (int i= 0; i < 30; i++) {
+    s= (i % 3 == 0 ? "b*" : (i % 3 == 1 ? "(3)+" : "4-")) * s;
+    QVERIFY (same_parses ("packrat-test", s));
+    if (i > 0) QVERIFY (reused ("packrat-test", s));
+  }
+  while (N (s) > 1) {
+    s= s (1, N (s));
+    QVERIFY (same_parses ("packrat-test", s));
+    QVERIFY (same_parses ("packrat-test", with_fraction (s)));
+  }
+}
+
+void
+TestPackratParser::test_middle_edits () {
+  string s= "1+2*(3+4)*5+6";
+  QVERIFY (same_parses ("packrat-test", s));
+  for (int i= 0; i < 40; i++) {
+    int p= N (s) / 2;
+    if (i % 4 == 0) s= s (0, p) * "+7" * s (p, N (s));
+    else if (i % 4 == 1) s= s (0, p) * "*(" * s (p, N (s));
+    else if (i % 4 == 2) s= s (0, p) * ")" * s (p, N (s));
+    else s= s (0, p) * s (p + 1, N (s));
+    QVERIFY (same_parses ("packrat-test", s));
+    QVERIFY (reused ("packrat-test", s));
+    QVERIFY (same_parses ("packrat-test", with_fraction (s)));
+  }
+}
+
+void
+TestPackratParser::test_left_recursion () {
+  // type operators of all levels into the middle of a formula
+  const char* ops= "=+*!'[.-";
+  string      s  = "1";
+  for (int i= 0; i < 64; i++) {
+    int p= (N (s) / 2) | 1;
+    if (p > N (s)) p= N (s);
+    s= s (0, p) * string (ops[i % 8]) * "2" * s (p, N (s));
+    QVERIFY (same_parses ("packrat-levels", s));
+    QVERIFY (packrat_correct ("packrat-levels", "L0", s));
+  }
+  // a broken formula becomes correct again
+  string t= s (0, 9) * "(" * s (9, N (s));
+  QVERIFY (same_parses ("packrat-levels", t));
+  QVERIFY (!packrat_correct ("packrat-levels", "L0", t));
+  QVERIFY (same_parses ("packrat-levels", s));
+  QVERIFY (packrat_correct ("packrat-levels", "L0", s));
+}
+
+/******************************************************************************
+ * Parsers with a cursor and eviction of parsers
+ ******************************************************************************/
+
+void
+TestPackratParser::test_cursor () {
+  string s= "1+2*3+4*5";
+  QVERIFY (same_parses ("packrat-test", s));
+  for (int i= 0; i <= N (s); i++) {
+    packrat_parser par= make_packrat_parser ("packrat-test", s, path (i));
+    QVERIFY (par->former_prefix == -1);
+    QVERIFY (same_parse ("packrat-test", "Main", s, path (i)));
+  }
+  // nor do parsers inherit from parsers with a cursor
+  string t= s * "+6";
+  QVERIFY (!reused ("packrat-test", t));
+  QVERIFY (same_parses ("packrat-test", t));
+}
+
+void
+TestPackratParser::test_eviction () {
+  array<tree> in;
+  for (int i= 0; i <= 16; i++)
+    in << tree (as_string (i) * "+" * as_string (100 + i));
+  // keep the first parser alive, so that its address cannot be reused
+  packrat_parser first= make_packrat_parser ("packrat-test", in[0]);
+  for (int i= 1; i < 16; i++)
+    (void) parser ("packrat-test", in[i]);
+  // the 16 most recently used parsers are kept
+  QVERIFY (parser ("packrat-test", in[0]) == first.operator->());
+  for (int i= 1; i <= 16; i++)
+    (void) parser ("packrat-test", in[i]);
+  // the least recently used parser has been evicted
+  QVERIFY (parser ("packrat-test", in[0]) != first.operator->());
+  QVERIFY (same_parses ("packrat-test", in[0]));
+  // parsers are found from the contents of their input
+  QVERIFY (parser ("packrat-test", in[16]) ==
+           parser ("packrat-test", copy (in[16])));
+}
+
+/******************************************************************************
+ * Random edits
+ ******************************************************************************/
+
+static string
+random_formula (int depth) {
+  int k= rand () % (depth > 3 ? 2 : 5);
+  if (k == 0) return string ((char) ('0' + rand () % 10));
+  if (k == 1) return string ((char) ('a' + rand () % 3));
+  if (k == 2) return random_formula (depth + 1) * "+" * random_formula (depth + 1);
+  if (k == 3) return random_formula (depth + 1) * "*" * random_formula (depth + 1);
+  return "(" * random_formula (depth + 1) * ")";
+}
+
+void
+TestPackratParser::test_random_edits () {
+  // edits to a pool of formulas, so that parsers for several formulas
+  // are alternately reused and evicted
+  const char*   chars= "0123456789abc+-*()";
+  array<string> pool;
+  srand (7);
+  for (int i= 0; i < 20; i++)
+    pool << random_formula (0);
+  for (int it= 0; it < 2000; it++) {
+    int    k = rand () % N (pool);
+    string s = pool[k];
+    int    op= rand () % 3;
+    int    p = rand () % (N (s) + 1);
+    if (op == 0) s= s (0, p) * string (chars[rand () % 18]) * s (p, N (s));
+    else if (op == 1 && p < N (s)) s= s (0, p) * s (p + 1, N (s));
+    else if (p < N (s)) s= s (0, p) * string (chars[rand () % 18]) * s (p + 1, N (s));
+    pool[k]= s;
+    tree t = (it % 3 == 0 ? with_fraction (s) : tree (s));
+    QVERIFY (same_parses ("packrat-test", t));
+    QVERIFY (same_parses ("packrat-levels", s));
+  }
+}
+
+QTEST_MAIN (TestPackratParser)
+#include "packrat_parser_test.moc"
@@ -0,0 +1,200 @@
+/******************************************************************************
+ * MODULE     : line_breaker_test.cpp
+ * DESCRIPTION: Regression tests for the line breaking of paragraphs
+ * COPYRIGHT  : (C) 2026 Darcy Shen
+ *******************************************************************************
+ * This software falls under the GNU general public license version 3 or later.
+ * It comes WITHOUT ANY WARRANTY WHATSOEVER. For details, see the file LICENSE
+ * in the root directory or <http://www.gnu.org/licenses/gpl-3.0.html>.
+ ******************************************************************************/
+
+#include "Boxes/construct.hpp"
+#include "Format/line_item.hpp"
+#include "base.hpp"
+#include "font.hpp"
+#include "language.hpp"
+#include <QtTest/QtTest>
+
+using namespace moebius;
+
+#define UNIT (10 * PIXEL)
+
+extern text_property_rep tp_normal_rep;
+array<path> line_breaks (array<line_item> a, int start, int end, SI line_width,
+                         SI large_width, SI first_spc, SI last_spc,
+                         bool ragged);
+
+/******************************************************************************
+ * A font with fixed character widths and a predictable language
+ ******************************************************************************/
+
+struct fixed_font_rep : font_rep {
+  fixed_font_rep (string name) : font_rep (name) {}
+  bool supports (string c) {
+    (void) c;
+    return true;
+  }
+  void get_extents (string s, metric& ex) {
+    SI w= 0;
+    for (int i= 0; i < N (s); i++)
+      w+= (((unsigned char) s[i]) % 7 + 3) * UNIT;
+    ex->x1= ex->x3= 0;
+    ex->x2= ex->x4= w;
+    ex->y1= ex->y3= 0;
+    ex->y2= ex->y4= 7 * UNIT;
+  }
+  void draw_fixed (renderer ren, string s, SI x, SI y) {
+    (void) ren;
+    (void) s;
+    (void) x;
+    (void) y;
+  }
+  font magnify (double zoomx, double zoomy) {
+    (void) zoomx;
+    (void) zoomy;
+    return this;
+  }
+};
+
+struct every_language_rep : language_rep {
+  int every; // hyphenation points occur every so many characters
+  every_language_rep (string name, int every2)
+      : language_rep (name), every (every2) {}
+  text_property advance (tree t, int& pos) {
+    pos= N (t->label);
+    return &tp_normal_rep;
+  }
+  array<int> get_hyphens (string s) {
+    array<int> r (max (N (s) - 1, 0));
+    for (int i= 0; i < N (r); i++)
+      r[i]= (i >= 1 && i < N (r) - 2 && ((i + (unsigned char) s[0]) % every) == 0)
+                ? HYPH_STD
+                : HYPH_INVALID;
+    return r;
+  }
+  void hyphenate (string s, int after, string& l, string& r) {
+    l= s (0, after + 1) * "-";
+    r= s (after + 1, N (s));
+  }
+};
+
+static font
+fixed_font () {
+  string name= "line-breaker-test";
+  return make (font, name, tm_new<fixed_font_rep> (name));
+}
+
+static language
+every_language (int every) {
+  string name= "line-breaker-test-" * as_string (every);
+  return make (language, name, tm_new<every_language_rep> (name, every));
+}
+
+/******************************************************************************
+ * Paragraphs and their breaks
+ ******************************************************************************/
+
+static array<line_item>
+paragraph (string text, language lan) {
+  // one string item per word, separated by stretchable spaces;
+  // a "|" forces a line break and a "_" is an unbreakable blank box
+  array<line_item> a;
+  int              i= 0;
+  while (i < N (text)) {
+    int start= i;
+    while (i < N (text) && text[i] != ' ')
+      i++;
+    string    w= text (start, i++);
+    int       k= N (a);
+    line_item item;
+    if (w == "|")
+      item= line_item (CONTROL_ITEM, 0, empty_box (path (k)), HYPH_INVALID,
+                       tree (LINE_BREAK));
+    else if (w == "_")
+      item= line_item (STD_ITEM, 0, empty_box (path (k), 0, 0, 50 * UNIT, 0),
+                       HYPH_INVALID, lan);
+    else
+      item= line_item (STRING_ITEM, 0,
+                       text_box (path (k), 0, w, fixed_font (), pencil (true)),
+                       0, lan);
+    item->spc= space (3 * UNIT, 4 * UNIT, 6 * UNIT);
+    a << item;
+  }
+  return a;
+}
+
+static string
+breaks (string text, int every, SI width, SI first_spc= 0, SI last_spc= 0,
+        bool ragged= false) {
+  array<line_item> a = paragraph (text, every_language (every));
+  array<path>      ps= line_breaks (a, 0, N (a), width * UNIT,
+                                    (width + width / 10) * UNIT,
+                                    first_spc * UNIT, last_spc * UNIT, ragged);
+  string           r;
+  for (int i= 0; i < N (ps); i++) {
+    if (i > 0) r << " ";
+    for (path p= ps[i]; !is_nil (p); p= p->next) {
+      r << as_string (p->item);
+      if (!is_nil (p->next)) r << ".";
+    }
+  }
+  return r;
+}
+
+static string text=
+    "Typesetting paragraphs consists of choosing the breaks between lines "
+    "so that the spaces between words are stretched or shrunk as little as "
+    "possible while avoiding hyphenations whenever reasonable alternatives "
+    "exist within the admissible tolerance of the breaking algorithm";
+
+static string long_word= "mmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmm";
+
+/******************************************************************************
+ * The expected breaks are those of the former implementation
+ ******************************************************************************/
+
+class TestLineBreaker : public QObject {
+  Q_OBJECT
+
+private slots:
+  void init () { init_lolly (); }
+  void test_hyphenation ();
+  void test_ragged ();
+  void test_overfull ();
+  void test_forced ();
+  void test_single_item ();
+};
+
+void
+TestLineBreaker::test_hyphenation () {
+  qcompare (breaks (text, 1000, 300), "0 6 14 23 28 34 38");
+  qcompare (breaks (text, 3, 300), "0 6 15 24 28.2 35 38");
+  qcompare (breaks (text, 2, 200), "0 4 9 15 21 25.6 28.3 33 37.3 38");
+}
+
+void
+TestLineBreaker::test_ragged () {
+  qcompare (breaks (text, 3, 300, 0, 0, true), "0 6 14.1 23 28 34 38");
+}
+
+void
+TestLineBreaker::test_overfull () {
+  string s= "A word " * long_word * " which does not fit on a line";
+  qcompare (breaks (s, 1000, 200), "0 3 10");
+}
+
+void
+TestLineBreaker::test_forced () {
+  string s= "First line | Second line _ with a box and some more words "
+            "to break | last";
+  qcompare (breaks (s, 3, 200, 20, 10), "0 3 10 17");
+}
+
+void
+TestLineBreaker::test_single_item () {
+  qcompare (breaks ("paragraph", 3, 300), "0 1");
+  qcompare (breaks (long_word, 1000, 200), "0 1");
+}
+
+QTEST_MAIN (TestLineBreaker)
+#include "line_breaker_test.moc"
@@ -0,0 +1,255 @@
+/******************************************************************************
+ * MODULE     : make_pages_test.cpp
+ * DESCRIPTION: Tests on the reuse of pages after edits
+ * COPYRIGHT  : (C) 2026 Darcy Shen
+ *******************************************************************************
+ * This software falls under the GNU general public license version 3 or later.
+ * It comes WITHOUT ANY WARRANTY WHATSOEVER. For details, see the file LICENSE
+ * in the root directory or <http://www.gnu.org/licenses/gpl-3.0.html>.
+ ******************************************************************************/
+
+#include "Bridge/impl_typesetter.hpp"
+#include "Metafont/load_tex.hpp"
+#include "Page/pager.hpp"
+#include "base.hpp"
+#include "data_cache.hpp"
+#include "env.hpp"
+#include "observers.hpp"
+#include "preferences.hpp"
+#include "tm_sys_utils.hpp"
+#include "tree_observer.hpp"
+#include <QtTest/QtTest>
+#include <moebius/drd/drd_std.hpp>
+
+using namespace moebius;
+using moebius::drd::std_drd;
+
+extern tree the_et;
+
+class TestMakePages : public QObject {
+  Q_OBJECT
+
+private:
+  void check_edits ();
+
+private slots:
+  void initTestCase ();
+  void test_professional_breaking ();
+  void test_new_style_breaking ();
+};
+
+/******************************************************************************
+ * Typesetting documents
+ ******************************************************************************/
+
+static edit_env
+paper_env () {
+  // environments keep references to their drd and to the tables of labels,
+  // which are shared by all documents of the test since they have no labels
+  static drd_info              drd ("none", std_drd);
+  static hashmap<string, tree> h1 (UNINIT), h2 (UNINIT);
+  static hashmap<string, tree> h3 (UNINIT), h4 (UNINIT);
+  static hashmap<string, tree> h5 (UNINIT), h6 (UNINIT);
+  edit_env                     env (drd, "none", h1, h2, h3, h4, h5, h6);
+  env->read_only= false;
+  env->write (PAGE_MEDIUM, "paper");
+  env->write (PAGE_TYPE, "a5");
+  env->style_init_env ();
+  env->update ();
+  return env;
+}
+
+static tree
+paragraph (int i) {
+  string s= "Paragraph " * as_string (i) * ".";
+  for (int j= 0; j < 12; j++)
+    s << " Some words to fill a few lines of text on the page.";
+  return s;
+}
+
+static tree
+floating (int i) {
+  return tree (FLOAT, "float", "tbh",
+               tree (DOCUMENT, "Float " * as_string (i) * " with some text.",
+                     paragraph (1000 + i)));
+}
+
+static tree
+chapter (int from, int nr) {
+  // a chapter of nr paragraphs with a float in its middle
+  tree doc (DOCUMENT);
+  for (int i= 0; i < nr; i++) {
+    doc << paragraph (from + i);
+    if (i == nr / 2) doc << floating (from);
+  }
+  return doc;
+}
+
+static tree
+book () {
+  // three chapters, each of them starting on a new page
+  tree doc= chapter (0, 20) * tree (DOCUMENT, tree (NEW_PAGE));
+  doc     = doc * chapter (100, 20) * tree (DOCUMENT, tree (NEW_PAGE));
+  return doc * chapter (200, 20);
+}
+
+static int
+new_page (tree doc, int nr) {
+  // position of the nr-th forced page break
+  for (int i= 0; i < N (doc); i++)
+    if ((doc[i] == NEW_PAGE) && (nr-- == 0)) return i;
+  return -1;
+}
+
+static tree
+skeleton_breaks (skeleton sk) {
+  tree r (TUPLE);
+  for (int i= 0; i < N (sk); i++) {
+    tree pg (TUPLE);
+    for (int j= 0; j < N (sk[i]->ins); j++) {
+      insertion ins= sk[i]->ins[j];
+      pg << tuple (copy (ins->type), as_string (ins->begin),
+                   as_string (ins->end), skeleton_breaks (ins->sk));
+    }
+    r << pg;
+  }
+  return r;
+}
+
+static tree
+box_contents (box b) {
+  // the logical structure of a box and the placement of its children
+  tree r= tuple ((tree) b, as_string (b->w ()), as_string (b->h ()));
+  for (int i= 0; i < b->subnr (); i++)
+    r << tuple (as_string (b->sx1 (i)), as_string (b->sy1 (i)),
+                box_contents (b->subbox (i)));
+  return r;
+}
+
+static tree
+page_contents (pager ppp) {
+  tree r (TUPLE);
+  for (int i= 0; i < N (ppp->pages); i++)
+    r << box_contents (ppp->pages[i]);
+  return r;
+}
+
+static bool
+same_pages (typesetter ttt) {
+  // compare the result of an incremental typesetting with a typesetting
+  // of a copy of the document from scratch
+  insert (the_et, 1, tuple (copy (the_et[0])));
+  edit_env   env= paper_env ();
+  typesetter ref= new_typesetter (env, the_et[1], path (1));
+  (void) typeset (ref);
+  pager ppp= ttt->last_pager, qqq= ref->last_pager;
+  bool  ok = (N (ppp->pages) == N (qqq->pages)) &&
+            (skeleton_breaks (ppp->sk) == skeleton_breaks (qqq->sk)) &&
+            (page_contents (ppp) == page_contents (qqq));
+  delete_typesetter (ref);
+  remove (the_et, 1, 1);
+  return ok;
+}
+
+/******************************************************************************
+ * Edits of the document, as announced by the editor
+ ******************************************************************************/
+
+static void
+edit_assign (typesetter ttt, int pos, tree t) {
+  notify_assign (ttt, path (pos), t);
+  assign (the_et[0][pos], t);
+}
+
+static void
+edit_insert (typesetter ttt, int pos, tree ins) {
+  notify_insert (ttt, path (pos), ins);
+  insert (the_et[0], pos, ins);
+}
+
+static void
+edit_remove (typesetter ttt, int pos, int nr) {
+  notify_remove (ttt, path (pos), nr);
+  remove (the_et[0], pos, nr);
+}
+
+/******************************************************************************
+ * Edits before and after stable page breaks
+ ******************************************************************************/
+
+void
+TestMakePages::initTestCase () {
+  init_lolly ();
+  init_texmacs_home_path ();
+  cache_initialize ();
+  init_tex ();
+  moebius::drd::init_std_drd ();
+}
+
+void
+TestMakePages::check_edits () {
+  // documents are typeset from the edit tree, as the buffers of the editor
+  the_et      = tuple ();
+  the_et->data= ip_observer (path ());
+  insert (the_et, 0, tuple (book ()));
+  edit_env   env= paper_env ();
+  typesetter ttt= new_typesetter (env, the_et[0], path (0));
+  (void) typeset (ttt);
+  QVERIFY (N (ttt->last_pager->pages) >= 6);
+  QVERIFY (same_pages (ttt));
+
+  // changing a paragraph in the last chapter keeps the pages before it
+  array<box> old_pages= ttt->last_pager->pages;
+  edit_assign (ttt, new_page (the_et[0], 1) + 4, paragraph (299));
+  (void) typeset (ttt);
+  QVERIFY (same_pages (ttt));
+  QVERIFY (N (ttt->last_pager->pages) == N (old_pages));
+  QVERIFY (ttt->last_pager->pages[0] == old_pages[0]);
+
+  // inserting paragraphs and a float after the last forced page break
+  edit_insert (ttt, new_page (the_et[0], 1) + 5,
+               tree (DOCUMENT, paragraph (300), floating (300),
+                     paragraph (301)));
+  (void) typeset (ttt);
+  QVERIFY (same_pages (ttt));
+
+  // inserting paragraphs before the first forced page break
+  edit_insert (ttt, 2,
+               tree (DOCUMENT, paragraph (400), paragraph (401),
+                     paragraph (402)));
+  (void) typeset (ttt);
+  QVERIFY (same_pages (ttt));
+
+  // removing the page break before the second chapter and its float
+  int pos= new_page (the_et[0], 0);
+  edit_remove (ttt, pos, 1);
+  (void) typeset (ttt);
+  QVERIFY (same_pages (ttt));
+  pos= new_page (the_et[0], 0);
+  while (!is_func (the_et[0][pos], FLOAT))
+    pos--;
+  edit_remove (ttt, pos, 1);
+  (void) typeset (ttt);
+  QVERIFY (same_pages (ttt));
+
+  // editing right after the remaining forced page break
+  edit_assign (ttt, new_page (the_et[0], 0) + 1, paragraph (500));
+  (void) typeset (ttt);
+  QVERIFY (same_pages (ttt));
+  delete_typesetter (ttt);
+}
+
+void
+TestMakePages::test_professional_breaking () {
+  set_user_preference ("new style page breaking", "off");
+  check_edits ();
+}
+
+void
+TestMakePages::test_new_style_breaking () {
+  set_user_preference ("new style page breaking", "on");
+  check_edits ();
+}
+
+QTEST_MAIN (TestMakePages)
+#include "make_pages_test.moc"
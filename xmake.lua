@@ -45,6 +45,11 @@ option_end()
 
 set_config("debug_with_timestamp", true)
 
+option("typeset_profile")
+    set_default(false)
+    set_description("Enable instrumentation of the typesetting phases")
+option_end()
+
 -- Generate build/config.h from template
 add_configfiles("src/System/config.h.xmake", {
     filename = "config.h",
@@ -78,6 +83,7 @@ add_configfiles("src/System/config.h.xmake", {
         USE_MUPDF_RENDERER = has_config("mupdf"),
         IS_COMMUNITY = has_config("is_community"),
         DEBUG_WITH_TIMESTAMP = has_config("debug_with_timestamp"),
+        TYPESET_PROFILE = has_config("typeset_profile"),
     }
 })
 
@@ -684,6 +690,7 @@ target("libmogan") do
                 USE_MUPDF_RENDERER = has_config("mupdf"),
                 IS_COMMUNITY = has_config("is_community"),
                 DEBUG_WITH_TIMESTAMP = has_config("debug_with_timestamp"),
+                TYPESET_PROFILE = has_config("typeset_profile"),
                 }})
 
     if is_plat("linux") then 
@@ -800,6 +807,7 @@ target("libmogan") do
             "src/Texmacs/Window/**.cpp",
             "src/Typeset/**.cpp",
             "src/Plugins/Bibtex/**.cpp",
+            "src/Plugins/Database/**.cpp",
             "src/Plugins/Freetype/**.cpp",
             "src/Plugins/Pdf/**.cpp",
             "src/Plugins/Ghostscript/**.cpp",